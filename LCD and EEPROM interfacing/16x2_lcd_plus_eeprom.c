@@ -7,67 +7,113 @@
  * SW: I2C interface with EEPROM 24LC256
  *  
  *******************************************************************/
-#include <p18f4520.h>
-#include <i2c.h>
+#include "hal_pic18.h"
+#include "instr.h"
+#include "delay.h"
+#include "serial.h"
+#include "lcd.h"
+#include "eelog.h"
+#include "i2c_async.h"
 
-/* LCD Control pins */
-#define E  PORTDbits.RD6
-#define RW PORTDbits.RD5
-#define RS PORTDbits.RD4
+/* Line rate */
+#define BAUD_RATE 19200
 
 /* Prototypes */
-void delay(int);
-void init_serial(void);
-void init_lcd(void);
+unsigned char init_serial(void);
+void baud_error(void);
 void dump_to_lcd(void);
-void send_to_lcd(int, int);
-void wait_busy_lcd(void);
-void refresh_lcd(void);
-void set_position_lcd(int);
+void instr_out(char c);
 
 /* EEPROM Interface */
 void init_i2c(void);
-void write_to_eeprom(char, short int);
-unsigned char HDByteWriteI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char data );
-unsigned char HDByteReadI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char *data, unsigned char length );
+void write_to_eeprom(char);
+void high_isr(void);
 
-/* Keep DDRAM write count */
-int position = 0;
+#ifndef HAL_HOST
+/* High priority interrupt vector */
+#pragma code high_vector = 0x08
+void high_vector(void)
+{
+   _asm goto high_isr _endasm
+}
+#pragma code
+
+/* The ISRs are calls - their compiler temporaries have to be saved */
+#pragma interrupt high_isr save=section(".tmpdata")
+#endif
+void high_isr()
+{
+   Serial_Isr();
+   I2C_Isr();
+}
 
 /* Main */
 void main()
 {
    unsigned short int count = 0;
-   unsigned char data;
+   unsigned char data, dump = 0;
+
+   /* Timer1 - time base for delays and latency histograms */
+   HAL_TimerInit();
 
    /* Allow peripheral init */
-   delay(1000);
+   delay_ms(1);
+
+   /* Turn ON and setup up LCD - first, so it can report a bad baud */
+   init_lcd();
 
    /* Initialize PIC USART to operate at 19200 baud */
-   init_serial();
+   if(!init_serial()) baud_error();
 
    /* Initialize I2C */
    init_i2c();
 
-   /* Turn ON and setup up LCD */
-   init_lcd();
+   /* Find where the log left off */
+   EELog_Init();
    
    /* Loop reception and echo it back */
    receive_next:
   
-   while(!PIR1bits.RCIF);
+   /* Refresh the LCD while waiting - input queues up in the RX ring
+      while the log waits on the EEPROM */
+   while(!Serial_Read(&data))
+   {
+      update_lcd();
+      poll_lcd();
+      I2C_Poll();
+
+      /* Read back once the page writes are in - EE_Read then only
+         waits on its own frame, not on queued write cycles */
+      if(dump && !I2C_Busy() && I2C_Ready(EE_CONTROL))
+      {
+         dump_to_lcd();
+         dump = 0;
+      }
+   }
+
+#ifdef INSTR_ENABLE
+   /* Ctrl-T sends the latency histograms and starts them over */
+   if(data == INSTR_DUMP_KEY)
+   {
+      Instr_Dump(instr_out);
+      Instr_Reset();
+      goto receive_next;
+   }
+#endif
+
    /* Echo received character */
-   data = RCREG;
-   TXREG = data;
+   while(!Serial_Write(data));
    
    /* Send the received byte to EEPROM */
-   write_to_eeprom(data, count);
+   write_to_eeprom(data);
 
    count++;
 
    if(count == 16)
    {
-      dump_to_lcd();
+      /* Commit the page, show what was stored once it is in */
+      EELog_Flush();
+      dump = 1;
       count = 0;
    }
   
@@ -77,262 +123,71 @@ void main()
    while(1);
 }
 
-/* Arbitrary delay routine */
-void delay(int del)
-{
-   while(del >= 0) del--;
-}
-
 
 /* Write 16 chars to LCD */
 void dump_to_lcd()
 {
-   unsigned short int i;
-   unsigned char chr;
+   unsigned short int i, n;
+   unsigned char chr[16];
+
+   /* Last 16 logged bytes */
+   n = EELog_ReadLast(chr, 16);
 
-   for(i=0; i<16; i++)
+   for(i=0; i<n; i++)
    {
-     /* Read from EEPROM */
-     HDByteReadI2C(0xA0, 0x00, i, &chr, 0x01);
-     
-     /* Write to LCD */
-     refresh_lcd();
-     send_to_lcd(chr, 0);
-     wait_busy_lcd();
+     /* Write to LCD - unchanged cells cost nothing */
+     put_char_lcd(chr[i]);
    }
 }
 
 
-/* Initiialze USART */
-void init_serial()
+/* Initiialze USART, 0 if the baud rate is out of tolerance */
+unsigned char init_serial()
 {
-   /* Baud = 19200 => SPBRG = 12 @ 4MHz core when BRGH=1 (lower error rate)*/
-   SPBRGH = 0x00;
-   SPBRG = 0x0C;
-   /* Manually configured 8-bit baud */
-   BAUDCON = 0x0;
-
-   /* RX and TX pins should be digital */ 
-   ADCON1 = 0x0F;
-   TRISC = 0xC0;
-
-   /* Enable serial RX-TX - Async/8-bit/0-Parity/BRGH=1 */
-   /* Turn on serial RX-TX */
-   TXSTA = 0x26;
-   RCSTA = 0x90;
-}
+   /* Baud = 19200 => SPBRGH:SPBRG = 51 @ 4MHz with BRG16/BRGH (+0.16%) */
+   /* Async/8-bit/0-Parity, RX-TX on - stays off if out of tolerance */
+   if(!Serial_SetBaud(FOSC, BAUD_RATE, 0)) return 0;
 
-/* Initialize I2C */
-void init_i2c()
-{
-    SSPCON1 = 0x28; 
-    SSPCON2 = 0x00;
-    SSPSTATbits.SMP = 1;
-    SSPADD = 0x09;
+   /* RX/TX through the ring buffers from here on */
+   Serial_Init();
 
-    TRISCbits.RC3 = 1;
-    TRISCbits.RC4 = 1;
+   return 1;
 }
 
-
-void write_to_eeprom(char chr, short int addr)
+/* No usable line rate at this Fosc - say so and stop */
+void baud_error()
 {
-   HDByteWriteI2C(0xA0, 0x00, (char)addr, chr);
-}
+   static char msg[] = "BAUD ERROR";
+   unsigned char i;
 
-/* Initialize LCM HD44780 */
-void init_lcd()
-{
-   int command;
-   /* Configure PORTD to output */
-   TRISD = 0x00;
-  
-   /* Enable LCD */
-   PORTDbits.RD7 = 1;
-
-   /* Wait for HD44780 to boot */
-   delay(10000);
-
-   /* Write 1 nibble - 4-bit interface */
-   TRISD &= 0xF0; RW = 0; RS = 0;
-   E = 1;
-   command = PORTD & 0xF0; 
-   command |= 0x02;
-   PORTD = command; 
-   Nop(); 
-   E = 0; 
-   delay(10000);
-
-   /* Function set = 0x28 - 4-bit interface */
-   command = 0x28;
-   send_to_lcd(command, 1);
-   wait_busy_lcd();
-
-   /* Display set */
-   command = 0x0D;
-   send_to_lcd(command, 1);
-   wait_busy_lcd();
-   
-   /* Entry mode set */
-   command = 0x06;
-   send_to_lcd(command, 1);
-   wait_busy_lcd();
-
-   /* Clear display */
-   command = 0x01;
-   send_to_lcd(command, 1);
-   wait_busy_lcd();
-}
-
-void send_to_lcd(int data, int command)
-{
-   int temp = 0;
-   /* Configure PORTD to output */
-   TRISD &= 0xF0;
-
-   /* Write */
-   RW = 0;
-    
-   /* Command or data register */
-   if(command == 1) 
-     RS = 0;
-   else
-     RS = 1;
-
-   /* Upper nibble */
-   E = 1;
-   temp = PORTD & 0xF0;
-   temp |= (0x0F & (data >> 4));
-   PORTD = temp;
-   Nop(); 
-   E = 0; 
-   
-   delay(3);
-   
-   /* Lower nibble */
-   E = 1;
-   temp = PORTD & 0xF0;
-   temp |= (0x0F & data);
-   PORTD = temp;
-   Nop(); E = 0;
-
-   delay(3);
-}
-
-void wait_busy_lcd()
-{
-   int busy = 0;
-   /* Make PORTD input */
-   TRISD |= 0x0F;
-
-   /* Read */
-   RW = 1;
-   RS = 0;
-   
-   wait:
-   /* Address nibble */
-   E = 1; 
-   Nop();
-   E = 0;
-   
-   /* BF nibble */
-   E = 1; 
-   busy = PORTD; 
-   E = 0;
+   for(i = 0; msg[i]; i++) put_at_lcd(0, i, msg[i]);
+   flush_lcd();
+   while(poll_lcd());
 
-   if(busy & 0x08) goto wait;
+   while(1);
 }
 
-void refresh_lcd()
+/* Initialize I2C */
+void init_i2c()
 {
-   position++;
+    /* Master mode at the fastest rate the 24LC256 takes - 250kHz with
+       slew control at 4MHz, where SSPADD bottoms out at 3 */
+    I2C_SetSpeed(FOSC, EE_MAX_HZ);
 
-   /* Second line */
-   if(position == 17)
-   {
-     set_position_lcd(2);
-   }
-   /* First line */
-   else if(position == 33)
-   {
-      position = 1;
-      set_position_lcd(1); 
-   }
+    /* SSP interrupt driven transactions */
+    I2C_Init();
 }
 
 
-void set_position_lcd(int line)
+/* Histogram text out through the TX ring */
+void instr_out(char c)
 {
-   int ddram;
-   /* Set DDRAM address for 16x2 LCD */
-   if(line == 1) ddram = 0x80;
-   else ddram = 0xC0;
-
-   send_to_lcd(ddram, 1);
-   wait_busy_lcd();
+   while(!Serial_Write(c));
 }
 
 
-/************************************************************************
-*     Function Name:    HDByteWriteI2C                                  *   
-*     Parameters:       EE memory ControlByte, address and data         *
-*     Description:      Writes data one byte at a time to I2C EE        *
-*                       device. This routine can be used for any I2C    *
-*                       EE memory device, which only uses 1 byte of     *
-*                       address data as in the 24LC01B/02B/04B/08B/16B. *
-*                                                                       *     
-************************************************************************/
-
-unsigned char HDByteWriteI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char data )
-{
-  IdleI2C();                      // ensure module is idle
-  StartI2C();                     // initiate START condition
-  while ( SSPCON2bits.SEN );      // wait until start condition is over 
-  WriteI2C( ControlByte );        // write 1 byte - R/W bit should be 0
-  IdleI2C();                      // ensure module is idle
-  WriteI2C( HighAdd );            // write address byte to EEPROM
-  IdleI2C();                      // ensure module is idle
-  WriteI2C( LowAdd );             // write address byte to EEPROM
-  IdleI2C();                      // ensure module is idle
-  WriteI2C ( data );              // Write data byte to EEPROM
-  IdleI2C();                      // ensure module is idle
-  StopI2C();                      // send STOP condition
-  while ( SSPCON2bits.PEN );      // wait until stop condition is over 
-  while (EEAckPolling(ControlByte));  //Wait for write cycle to complete
-  return ( 0 );                   // return with no error
-}
-
-/********************************************************************
-*     Function Name:    HDByteReadI2C                               *
-*     Parameters:       EE memory ControlByte, address, pointer and *
-*                       length bytes.                               *
-*     Description:      Reads data string from I2C EE memory        *
-*                       device. This routine can be used for any I2C*
-*                       EE memory device, which only uses 1 byte of *
-*                       address data as in the 24LC01B/02B/04B/08B. *
-*                                                                   *  
-********************************************************************/
-
-unsigned char HDByteReadI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char *data, unsigned char length )
+void write_to_eeprom(char chr)
 {
-  IdleI2C();                      // ensure module is idle
-  StartI2C();                     // initiate START condition
-  while ( SSPCON2bits.SEN );      // wait until start condition is over 
-  WriteI2C( ControlByte );        // write 1 byte 
-  IdleI2C();                      // ensure module is idle
-  WriteI2C( HighAdd );            // WRITE word address to EEPROM
-  IdleI2C();                      // ensure module is idle
-  while ( SSPCON2bits.RSEN );     // wait until re-start condition is over 
-  WriteI2C( LowAdd );             // WRITE word address to EEPROM
-  IdleI2C();                      // ensure module is idle
-  RestartI2C();                   // generate I2C bus restart condition
-  while ( SSPCON2bits.RSEN );     // wait until re-start condition is over 
-  WriteI2C( ControlByte | 0x01 ); // WRITE 1 byte - R/W bit should be 1 for read
-  IdleI2C();                      // ensure module is idle
-  getsI2C( data, length );       // read in multiple bytes
-  NotAckI2C();                    // send not ACK condition
-  while ( SSPCON2bits.ACKEN );    // wait until ACK sequence is over 
-  StopI2C();                      // send STOP condition
-  while ( SSPCON2bits.PEN );      // wait until stop condition is over 
-  return ( 0 );                   // return with no error
+   /* Appended to the circular log - spans the whole device */
+   EELog_Append(chr);
 }
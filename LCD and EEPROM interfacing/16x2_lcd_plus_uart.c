@@ -8,205 +8,113 @@
  *  
  *******************************************************************/
 
-#include <p18f4520.h>
+#include "hal_pic18.h"
+#include "instr.h"
+#include "delay.h"
+#include "serial.h"
+#include "lcd.h"
 
-/* LCD Control pins */
-#define E  PORTDbits.RD6
-#define RW PORTDbits.RD5
-#define RS PORTDbits.RD4
+/* Line rate */
+#define BAUD_RATE 19200
 
 /* Prototypes */
-void delay(int);
-void init_serial(void);
-void init_lcd(void);
-void send_to_lcd(int, int);
-void wait_busy_lcd(void);
-void refresh_lcd(void);
-void set_position_lcd(int);
+unsigned char init_serial(void);
+void baud_error(void);
+void instr_out(char c);
+void high_isr(void);
+
+#ifndef HAL_HOST
+/* High priority interrupt vector */
+#pragma code high_vector = 0x08
+void high_vector(void)
+{
+   _asm goto high_isr _endasm
+}
+#pragma code
 
-/* Keep DDRAM write count */
-int position = 0;
+/* Serial_Isr is a call - its compiler temporaries have to be saved */
+#pragma interrupt high_isr save=section(".tmpdata")
+#endif
+void high_isr()
+{
+   Serial_Isr();
+}
 
 /* Main */
 void main()
 {
-   /* Allow peripheral init */
-   delay(1000);
+   unsigned char data;
 
-   /* Initialize PIC USART to operate at 19200 baud */
-   init_serial();
+   /* Timer1 - time base for delays and latency histograms */
+   HAL_TimerInit();
+
+   /* Allow peripheral init */
+   delay_ms(1);
 
-   /* Turn ON and setup up LCD */
+   /* Turn ON and setup up LCD - first, so it can report a bad baud */
    init_lcd();
+
+   /* Initialize PIC USART to operate at 19200 baud */
+   if(!init_serial()) baud_error();
    
    /* Loop reception and echo it back */
    receive_next:
   
-   while(!PIR1bits.RCIF);
-   /* Echo received character */
-   TXREG = RCREG;
-   refresh_lcd();
-   send_to_lcd(RCREG, 0);
-   wait_busy_lcd();
+   /* Bursts queue up in the RX ring while the LCD is busy */
+   if(Serial_Read(&data))
+   {
+#ifdef INSTR_ENABLE
+      /* Ctrl-T sends the latency histograms and starts them over */
+      if(data == INSTR_DUMP_KEY)
+      {
+         Instr_Dump(instr_out);
+         Instr_Reset();
+         goto receive_next;
+      }
+#endif
+      /* Echo received character */
+      while(!Serial_Write(data));
+      put_char_lcd(data);
+   }
+
+   /* Changed cells are queued on the refresh tick and clocked out
+      a byte at a time, so the loop never waits on the LCD */
+   update_lcd();
+   poll_lcd();
    goto receive_next;
    
    /* Shouldn't get here! */
    while(1);
 }
 
-/* Arbitrary delay routine */
-void delay(int del)
+/* Initiialze USART, 0 if the baud rate is out of tolerance */
+unsigned char init_serial()
 {
-   while(del >= 0) del--;
-}
+   /* Baud = 19200 => SPBRGH:SPBRG = 51 @ 4MHz with BRG16/BRGH (+0.16%) */
+   /* Async/8-bit/0-Parity, RX-TX on - stays off if out of tolerance */
+   if(!Serial_SetBaud(FOSC, BAUD_RATE, 0)) return 0;
 
-/* Initiialze USART */
-void init_serial()
-{
-   /* Baud = 19200 => SPBRG = 12 @ 4MHz core when BRGH=1 (lower error rate)*/
-   SPBRGH = 0x00;
-   SPBRG = 0x0C;
-   /* Manually configured 8-bit baud */
-   BAUDCON = 0x0;
-
-   /* RX and TX pins should be digital */ 
-   ADCON1 = 0x0F;
-   TRISC = 0xC0;
-
-   /* Enable serial RX-TX - Async/8-bit/0-Parity/BRGH=1 */
-   /* Turn on serial RX-TX */
-   TXSTA = 0x26;
-   RCSTA = 0x90;
-}
+   /* RX/TX through the ring buffers from here on */
+   Serial_Init();
 
-/* Initialize LCM HD44780 */
-void init_lcd()
-{
-   int command;
-   /* Configure PORTD to output */
-   TRISD = 0x00;
-  
-   /* Enable LCD */
-   PORTDbits.RD7 = 1;
-
-   /* Wait for HD44780 to boot */
-   delay(10000);
-
-   /* Write 1 nibble - 4-bit interface */
-   TRISD &= 0xF0; RW = 0; RS = 0;
-   E = 1;
-   command = PORTD & 0xF0; 
-   command |= 0x02;
-   PORTD = command; 
-   Nop(); 
-   E = 0; 
-   delay(10000);
-
-   /* Function set = 0x28 - 4-bit interface */
-   command = 0x28;
-   send_to_lcd(command, 1);
-   wait_busy_lcd();
-
-   /* Display set */
-   command = 0x0D;
-   send_to_lcd(command, 1);
-   wait_busy_lcd();
-   
-   /* Entry mode set */
-   command = 0x06;
-   send_to_lcd(command, 1);
-   wait_busy_lcd();
-
-   /* Clear display */
-   command = 0x01;
-   send_to_lcd(command, 1);
-   wait_busy_lcd();
+   return 1;
 }
 
-void send_to_lcd(int data, int command)
+/* No usable line rate at this Fosc - say so and stop */
+void baud_error()
 {
-   int temp = 0;
-   /* Configure PORTD to output */
-   TRISD &= 0xF0;
-
-   /* Write */
-   RW = 0;
-    
-   /* Command or data register */
-   if(command == 1) 
-     RS = 0;
-   else
-     RS = 1;
-
-   /* Upper nibble */
-   E = 1;
-   temp = PORTD & 0xF0;
-   temp |= (0x0F & (data >> 4));
-   PORTD = temp;
-   Nop(); 
-   E = 0; 
-   
-   delay(3);
-   
-   /* Lower nibble */
-   E = 1;
-   temp = PORTD & 0xF0;
-   temp |= (0x0F & data);
-   PORTD = temp;
-   Nop(); E = 0;
-
-   delay(3);
-}
-
-void wait_busy_lcd()
-{
-   int busy = 0;
-   /* Make PORTD input */
-   TRISD |= 0x0F;
-
-   /* Read */
-   RW = 1;
-   RS = 0;
-   
-   wait:
-   /* Address nibble */
-   E = 1; 
-   Nop();
-   E = 0;
-   
-   /* BF nibble */
-   E = 1; 
-   busy = PORTD; 
-   E = 0;
-
-   if(busy & 0x08) goto wait;
-}
+   static char msg[] = "BAUD ERROR";
+   unsigned char i;
 
-void refresh_lcd()
-{
-   position++;
+   for(i = 0; msg[i]; i++) put_at_lcd(0, i, msg[i]);
+   flush_lcd();
+   while(poll_lcd());
 
-   /* Second line */
-   if(position == 17)
-   {
-     set_position_lcd(2);
-   }
-   /* First line */
-   else if(position == 33)
-   {
-      position = 1;
-      set_position_lcd(1); 
-   }
+   while(1);
 }
 
-
-void set_position_lcd(int line)
+/* Histogram text out through the TX ring */
+void instr_out(char c)
 {
-   int ddram;
-   /* Set DDRAM address for 16x2 LCD */
-   if(line == 1) ddram = 0x80;
-   else ddram = 0xC0;
-
-   send_to_lcd(ddram, 1);
-   wait_busy_lcd();
+   while(!Serial_Write(c));
 }
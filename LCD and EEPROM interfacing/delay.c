@@ -0,0 +1,50 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Timer1 calibrated delays
+ *
+ * Timer1 free runs at Fosc/4 behind its prescaler, so waits are in
+ * real time whatever the compiler makes of the loop. The 16-bit
+ * difference wraps cleanly for spans up to TIMEOUT_MAX_US.
+ *
+ *******************************************************************/
+
+#include "delay.h"
+
+#ifndef HAL_HOST
+/* TMR1L must be read first - RD16 latches TMR1H on that read, so
+ * interrupts are held off until TMR1H is in, or an ISR reading the
+ * timer meanwhile would reload the latch. GIE is kept in a local:
+ * main and the ISR both read the timer, and a shared copy saved by
+ * main could be overwritten with the ISR's 0 before main restores it */
+unsigned int HAL_TimerRead(void)
+{
+   unsigned char gie = INTCONbits.GIE;
+   unsigned char low, high;
+
+   INTCONbits.GIE = 0;
+   low = TMR1L;
+   high = TMR1H;
+   INTCONbits.GIE = gie;
+
+   return ((unsigned int)high << 8) | low;
+}
+#endif
+
+/* Busy wait in microseconds */
+void delay_us(unsigned int us)
+{
+   unsigned int start = HAL_TimerRead();
+   while((unsigned short)(HAL_TimerRead() - start) < TIMER_TICKS(us));
+}
+
+/* Busy wait in milliseconds */
+void delay_ms(unsigned int ms)
+{
+   while(ms > 0)
+   {
+      delay_us(1000);
+      ms--;
+   }
+}
@@ -0,0 +1,39 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Timer1 calibrated delays and timeouts
+ *
+ *******************************************************************/
+#ifndef DELAY_H
+#define DELAY_H
+
+#include "hal_pic18.h"
+
+#if FOSC % 4000000UL != 0
+#error "FOSC must be a multiple of 4MHz - Timer1 needs whole ticks per microsecond"
+#endif
+
+/* Timer1 ticks per microsecond - 1 at 4MHz, and at 16MHz behind the 1:4 prescaler */
+#define TIMER_TICKS_US (FOSC / 4000000UL / TIMER_PRESCALE)
+
+/* Ticks that cover at least us microseconds. Behind a prescaler the
+ * tick the stamp falls in is partly gone, so one more is counted */
+#define TIMER_TICKS(us) ((us) * TIMER_TICKS_US + (TIMER_PRESCALE > 1))
+
+/* Longest delay_us or timeout Timer1's 16 bits can measure. Modules
+ * check their limits against it, e.g. 65ms at 4MHz, 13ms at 20MHz */
+#define TIMEOUT_MAX_US ((65535UL - (TIMER_PRESCALE > 1)) / TIMER_TICKS_US)
+
+/* Needs HAL_TimerInit() at start up, us up to TIMEOUT_MAX_US */
+void delay_us(unsigned int us);
+void delay_ms(unsigned int ms);
+
+/* Timeouts up to TIMEOUT_MAX_US - take a stamp, then test it against a
+ * limit in us. The difference is taken at Timer1's 16 bits, also where
+ * int is wider */
+#define Timeout_Start()             HAL_TimerRead()
+#define Timeout_Expired(start, us)  ((unsigned short)(HAL_TimerRead() - (start)) >= \
+                                     (unsigned short)TIMER_TICKS(us))
+
+#endif
@@ -0,0 +1,179 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Up to eight 24LC256 as one linear address space
+ *
+ * Pages are striped across the chips: linear page n is page
+ * n / EEARRAY_CHIPS of chip n % EEARRAY_CHIPS. A sequential write
+ * therefore goes to a different chip for every page, and the I2C
+ * scheduler runs page writes to the other chips while one is in its
+ * write cycle. Every transfer is cut at a page boundary, so it never
+ * spans two chips or wraps inside a page.
+ *
+ *******************************************************************/
+
+#include "eearray.h"
+#include "i2c_async.h"
+
+/* A request and its address + data frame */
+typedef struct
+{
+   I2C_Request req;
+   unsigned char frame[2 + EE_PAGE_SIZE];
+} EEArray_Slot;
+
+static EEArray_Slot slots[EEARRAY_SLOTS];
+static unsigned char next_slot;
+
+/* A transfer ended in NACK or collision - since the last EEArray_Sync,
+ * and in the EEArray_Read running now */
+static unsigned char failed;
+static unsigned char read_failed;
+
+
+/* Control byte and in-chip offset of a linear address */
+static unsigned char locate(unsigned long addr, unsigned int* offset)
+{
+   unsigned long page = addr / EE_PAGE_SIZE;
+
+   *offset = (unsigned int)(page / EEARRAY_CHIPS) * EE_PAGE_SIZE +
+             (unsigned int)(addr & (EE_PAGE_SIZE - 1));
+
+   return EE_CONTROL | (unsigned char)((page % EEARRAY_CHIPS) << 1);
+}
+
+/* Wait for a slot's transfer and note how it ended - once */
+static void retire(EEArray_Slot* slot)
+{
+   while(slot->req.status == I2C_PENDING) I2C_Poll();
+
+   if(slot->req.status != I2C_OK)
+   {
+      failed = 1;
+      if(slot->req.read_len != 0) read_failed = 1;
+      slot->req.status = I2C_OK;
+   }
+}
+
+/* Next slot in turn, once its last transfer is done */
+static EEArray_Slot* get_slot(void)
+{
+   EEArray_Slot* slot = &slots[next_slot];
+
+   next_slot++;
+   if(next_slot == EEARRAY_SLOTS) next_slot = 0;
+
+   retire(slot);
+
+   return slot;
+}
+
+static void retire_all(void)
+{
+   unsigned char i;
+
+   for(i = 0; i < EEARRAY_SLOTS; i++) retire(&slots[i]);
+}
+
+/* Bytes from addr up to the end of its page */
+static unsigned char page_chunk(unsigned long addr, unsigned int length)
+{
+   unsigned int room = EE_PAGE_SIZE - (unsigned int)(addr & (EE_PAGE_SIZE - 1));
+
+   return (unsigned char)((length < room) ? length : room);
+}
+
+
+void EEArray_Init()
+{
+   unsigned char i;
+
+   for(i = 0; i < EEARRAY_SLOTS; i++) slots[i].req.status = I2C_OK;
+   next_slot = 0;
+   failed = 0;
+}
+
+/* Queue a write - data is copied, so the buffer is free on return */
+unsigned char EEArray_Write(unsigned long addr, unsigned char* data, unsigned int length)
+{
+   EEArray_Slot* slot;
+   unsigned int offset;
+   unsigned char n, i;
+
+   if(addr > EEARRAY_SIZE || length > EEARRAY_SIZE - addr) return 0;
+
+   while(length > 0)
+   {
+      n = page_chunk(addr, length);
+      slot = get_slot();
+
+      slot->req.control = locate(addr, &offset);
+      slot->frame[0] = offset >> 8;
+      slot->frame[1] = offset & 0xFF;
+      for(i = 0; i < n; i++) slot->frame[2 + i] = data[i];
+
+      /* Held while the chip is programming, NACK retried after that */
+      slot->req.write = slot->frame;
+      slot->req.write_len = 2 + n;
+      slot->req.read_len = 0;
+      slot->req.flags = I2C_POLL | I2C_WCYCLE;
+      while(!I2C_Submit(&slot->req)) I2C_Poll();
+
+      addr += n;
+      data += n;
+      length -= n;
+   }
+
+   return 1;
+}
+
+/* Read a range - page reads from different chips overlap on the queue */
+unsigned char EEArray_Read(unsigned long addr, unsigned char* data, unsigned int length)
+{
+   EEArray_Slot* slot;
+   unsigned int offset;
+   unsigned char n;
+
+   if(addr > EEARRAY_SIZE || length > EEARRAY_SIZE - addr) return 0;
+
+   read_failed = 0;
+
+   while(length > 0)
+   {
+      n = page_chunk(addr, length);
+      slot = get_slot();
+
+      slot->req.control = locate(addr, &offset);
+      slot->frame[0] = offset >> 8;
+      slot->frame[1] = offset & 0xFF;
+
+      slot->req.write = slot->frame;
+      slot->req.write_len = 2;
+      slot->req.read = data;
+      slot->req.read_len = n;
+      slot->req.flags = I2C_POLL;
+      while(!I2C_Submit(&slot->req)) I2C_Poll();
+
+      addr += n;
+      data += n;
+      length -= n;
+   }
+
+   /* Data is only there once every chunk has completed */
+   retire_all();
+
+   return !read_failed;
+}
+
+/* Wait for every queued transfer, 0 if any since the last sync failed */
+unsigned char EEArray_Sync()
+{
+   unsigned char ok;
+
+   retire_all();
+
+   ok = !failed;
+   failed = 0;
+   return ok;
+}
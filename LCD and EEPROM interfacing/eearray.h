@@ -0,0 +1,35 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Up to eight 24LC256 as one linear address space
+ *
+ *******************************************************************/
+#ifndef EEARRAY_H
+#define EEARRAY_H
+
+#include "eeprom.h"
+
+/* Fitted chips, strapped A2..A0 = 0, 1, 2 ... */
+#ifndef EEARRAY_CHIPS
+#define EEARRAY_CHIPS 8
+#endif
+
+#define EEARRAY_SIZE ((unsigned long)EEARRAY_CHIPS * EE_SIZE)
+
+/* Transfers in flight - one page each */
+#define EEARRAY_SLOTS 4
+
+/* Prototypes - 1 on success, 0 if the range is out of the array.
+ * Slots start out free, EEArray_Init only matters to drop old state.
+ * EEArray_Write only queues: whether the chips took the data is known
+ * at the next EEArray_Sync, which returns 0 if any transfer since the
+ * last one was NACKed (chip missing) or lost the bus. EEArray_Read
+ * also returns 0 if one of its own chunks failed - the buffer then
+ * holds stale bytes for that chunk. */
+void EEArray_Init(void);
+unsigned char EEArray_Write(unsigned long addr, unsigned char* data, unsigned int length);
+unsigned char EEArray_Read(unsigned long addr, unsigned char* data, unsigned int length);
+unsigned char EEArray_Sync(void);
+
+#endif
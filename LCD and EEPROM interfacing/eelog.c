@@ -0,0 +1,241 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Circular byte log over the whole 24LC256
+ *
+ * The log fills the 512 pages in turn and wraps, so every page takes
+ * the same share of write cycles. Each page carries a sequence number
+ * one higher than the page before it. Within the current lap,
+ * seq[p] - seq[0] == p holds up to the head page and fails after it,
+ * so EELog_Init finds the head with a binary search over 9 headers
+ * instead of scanning the device.
+ *
+ * Page writes go out through the interrupt driven I2C engine. The head
+ * page is double buffered, so appends to the next page can carry on
+ * while the previous one is still on the bus. A page is only written
+ * once the one before it is in - a failed write is resubmitted, and
+ * until it goes through the head stays buffered, so the sequence has
+ * no gaps for EELog_Init to trip over.
+ *
+ * Each flush rewrites the head page from the header on - one write
+ * cycle per flush. At the app's 16 byte flushes a page takes four or
+ * five per lap; with the 24LC256 rated for 1,000,000 that is still
+ * 200,000 laps, over 6GB logged.
+ *
+ *******************************************************************/
+
+#include "eelog.h"
+#include "i2c_async.h"
+
+/* Resubmits of a failed page write before the flush gives up for now */
+#define EELOG_RETRIES 2
+
+/* Two page images, each behind its 2 address bytes - page points into the current one */
+static unsigned char image[2][2 + EE_PAGE_SIZE];
+static I2C_Request request[2];
+static unsigned char current;
+static unsigned char* page;
+static unsigned int head;
+static unsigned int seq;
+static unsigned char fill;      /* data bytes in the head page */
+static unsigned char written;   /* of those, already in the device */
+static unsigned int used;       /* pages holding data, head included */
+
+
+/* Read a page header - returns the data length, 0 if the page was never written */
+static unsigned char read_header(unsigned int p, unsigned int* s)
+{
+   unsigned char hdr[EELOG_HEADER];
+
+   EE_Read(p * EE_PAGE_SIZE, hdr, EELOG_HEADER);
+   *s = ((unsigned int)hdr[0] << 8) | hdr[1];
+
+   /* Erased (0xFF) or foreign data */
+   if(hdr[2] == 0 || hdr[2] > EELOG_DATA) return 0;
+
+   return hdr[2];
+}
+
+/* Wait out a page write, resubmitting it while it fails - 0 if it
+ * still has not gone through */
+static unsigned char settle(I2C_Request* req)
+{
+   unsigned char tries = 0;
+
+   while(1)
+   {
+      while(req->status == I2C_PENDING) I2C_Poll();
+      if(req->status == I2C_OK) return 1;
+      if(tries++ == EELOG_RETRIES) return 0;
+      while(!I2C_Submit(req)) I2C_Poll();
+   }
+}
+
+/* Move on to a fresh head page - overwrites the oldest once full */
+static void advance(void)
+{
+   /* Switch images - the other one may only be reused once written */
+   current ^= 1;
+   page = image[current] + 2;
+   while(request[current].status == I2C_PENDING) I2C_Poll();
+
+   head = (head + 1) & (EELOG_PAGES - 1);
+   seq++;
+   fill = written = 0;
+   if(used < EELOG_PAGES) used++;
+}
+
+
+/* Recover head and fill level from the device */
+void EELog_Init()
+{
+   unsigned int s0, s, lo, hi, mid;
+   unsigned char len;
+
+   head = 0;
+   seq = 0;
+   fill = written = 0;
+   used = 1;
+   current = 0;
+   page = image[0] + 2;
+   request[0].status = I2C_OK;
+   request[1].status = I2C_OK;
+
+   /* Blank device - start at page 0 */
+   if(read_header(0, &s0) == 0) return;
+
+   /* Last page of the current lap - sequence numbers are 16 bits on
+      the device, so differences are taken at 16 bits also where int is
+      wider */
+   lo = 0;
+   hi = EELOG_PAGES - 1;
+   while(lo < hi)
+   {
+      mid = (lo + hi + 1) / 2;
+      if(read_header(mid, &s) != 0 && (unsigned short)(s - s0) == mid)
+         lo = mid;
+      else
+         hi = mid - 1;
+   }
+
+   head = lo;
+   len = read_header(head, &seq);
+   used = head + 1;
+
+   /* Whole device in use, or the page after the head holds the previous lap */
+   if(head + 1 == EELOG_PAGES ||
+      (read_header(head + 1, &s) != 0 && (unsigned short)(seq - s) == EELOG_PAGES - 1))
+   {
+      used = EELOG_PAGES;
+   }
+
+   if(len == EELOG_DATA)
+   {
+      advance();
+   }
+   else
+   {
+      EE_Read(head * EE_PAGE_SIZE, page, EE_PAGE_SIZE);
+      fill = written = len;
+   }
+}
+
+/* Add one byte - a full page is committed and the head moves on.
+ * 0 if the byte was dropped: the head is full and can't be written. */
+unsigned char EELog_Append(unsigned char data)
+{
+   /* Full, its write failed last time - try again */
+   if(fill == EELOG_DATA)
+   {
+      EELog_Flush();
+      if(written != fill) return 0;
+      advance();
+   }
+
+   page[EELOG_HEADER + fill] = data;
+   fill++;
+
+   if(fill == EELOG_DATA)
+   {
+      EELog_Flush();
+      if(written == fill) advance();
+   }
+
+   return 1;
+}
+
+/* Queue the head page - one write cycle for header and data. Bytes past
+ * the queued length stay free for appends while it is on the bus. */
+void EELog_Flush()
+{
+   unsigned int addr = head * EE_PAGE_SIZE;
+   unsigned char* frame = image[current];
+   I2C_Request* req = &request[current];
+
+   /* Nothing new, and what is queued has not failed */
+   if(fill == written && (req->status == I2C_OK || req->status == I2C_PENDING)) return;
+
+   /* The page before must be in first - otherwise keep it all buffered */
+   if(!settle(&request[current ^ 1])) return;
+
+   /* Header and address bytes are in flight from the last flush. If
+      that write failed this one covers it. */
+   while(req->status == I2C_PENDING) I2C_Poll();
+
+   frame[0] = addr >> 8;
+   frame[1] = addr & 0xFF;
+   page[0] = seq >> 8;
+   page[1] = seq & 0xFF;
+   page[2] = fill;
+
+   /* Held until the previous page has programmed, NACK retried after that */
+   req->control = EE_CONTROL;
+   req->write = frame;
+   req->write_len = 2 + EELOG_HEADER + fill;
+   req->read_len = 0;
+   req->flags = I2C_POLL | I2C_WCYCLE;
+   while(!I2C_Submit(req)) I2C_Poll();
+
+   written = fill;
+}
+
+/* Copy the most recent bytes, oldest first - returns how many were available */
+unsigned int EELog_ReadLast(unsigned char* buffer, unsigned int count)
+{
+   unsigned int p = head, pages = used, got = 0, take, i;
+   unsigned char avail = fill;
+   unsigned char* dst;
+
+   /* Fill the buffer from its end, walking back page by page */
+   while(got < count && pages > 0)
+   {
+      take = count - got;
+      if(take > avail) take = avail;
+      dst = buffer + count - got - take;
+
+      if(p == head)
+      {
+         for(i = 0; i < take; i++) dst[i] = page[EELOG_HEADER + avail - take + i];
+      }
+      else
+      {
+         EE_Read(p * EE_PAGE_SIZE + EELOG_HEADER + avail - take, dst, take);
+      }
+
+      got += take;
+      pages--;
+
+      /* Everything behind the head is a full page */
+      p = (p - 1) & (EELOG_PAGES - 1);
+      avail = EELOG_DATA;
+   }
+
+   /* Short log - move to the front */
+   if(got < count)
+   {
+      for(i = 0; i < got; i++) buffer[i] = buffer[count - got + i];
+   }
+
+   return got;
+}
@@ -0,0 +1,24 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Circular byte log over the whole 24LC256
+ *
+ *******************************************************************/
+#ifndef EELOG_H
+#define EELOG_H
+
+#include "eeprom.h"
+
+/* Each 64 byte page: sequence number (2), data length (1), data (61) */
+#define EELOG_PAGES  (EE_SIZE / EE_PAGE_SIZE)
+#define EELOG_HEADER 3
+#define EELOG_DATA   (EE_PAGE_SIZE - EELOG_HEADER)
+
+/* Prototypes */
+void EELog_Init(void);
+unsigned char EELog_Append(unsigned char data);
+void EELog_Flush(void);
+unsigned int EELog_ReadLast(unsigned char* buffer, unsigned int count);
+
+#endif
@@ -0,0 +1,251 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: 24LC256 I2C EEPROM access with a page-buffered writer
+ *
+ * A byte write costs a full START/control/address/STOP frame plus a
+ * ~5ms write cycle. EE_Write gathers consecutive bytes into a run
+ * inside one 64 byte page and commits the run with HDPageWriteI2C, so
+ * a full page costs one write cycle instead of 64.
+ *
+ *******************************************************************/
+
+#include "eeprom.h"
+#include "i2c_async.h"
+#include "delay.h"
+#include "instr.h"
+
+/* Pending run - page_len bytes starting at page_addr, never crossing a page */
+static unsigned char page_buf[EE_PAGE_SIZE];
+static unsigned int page_addr;
+static unsigned char page_len = 0;
+
+
+/* Buffer one byte - a non-consecutive address or a full page commits the run */
+void EE_Write(unsigned int addr, unsigned char data)
+{
+   addr &= EE_SIZE - 1;
+
+   if(page_len != 0 && addr != page_addr + page_len) EE_Flush();
+
+   if(page_len == 0) page_addr = addr;
+   page_buf[page_len++] = data;
+
+   /* Last byte of the page */
+   if(((addr + 1) & (EE_PAGE_SIZE - 1)) == 0) EE_Flush();
+}
+
+/* Commit the pending run */
+void EE_Flush()
+{
+   if(page_len == 0) return;
+
+   /* Bus may still be running queued transactions */
+   while(I2C_Busy()) I2C_Poll();
+   HDPageWriteI2C(EE_CONTROL, page_addr >> 8, page_addr & 0xFF, page_buf, page_len);
+   page_len = 0;
+}
+
+/* Read a range with one address frame. The device address counter rolls
+ * over from LowAdd 0xFF into the next HighAdd on its own (and from the
+ * top of the array back to 0), so only getsI2C's 255 byte limit splits
+ * the data phase - those chunks are joined with a plain ACK. */
+void EE_Read(unsigned int addr, unsigned char* data, unsigned int length)
+{
+   unsigned char n;
+   INSTR_DECLARE(t)
+
+   if(length == 0) return;
+
+   /* Pending writes must land before they can be read back */
+   EE_Flush();
+
+   addr &= EE_SIZE - 1;
+
+   /* Let queued transactions finish and the last write cycle run out -
+      the ACK poll then normally succeeds first time */
+   while(I2C_Busy()) I2C_Poll();
+   while(!I2C_Ready(EE_CONTROL));
+   if(!EE_WaitReady(EE_CONTROL))
+   {
+      while(length-- > 0) *data++ = 0xFF;
+      return;
+   }
+
+   INSTR_START(t);
+   HAL_I2cIdle();
+   HAL_I2cStart();
+   HAL_I2cWrite(EE_CONTROL);
+   HAL_I2cIdle();
+   HAL_I2cWrite(addr >> 8);
+   HAL_I2cIdle();
+   HAL_I2cWrite(addr & 0xFF);
+   HAL_I2cIdle();
+   HAL_I2cRestart();
+   HAL_I2cWrite(EE_CONTROL | 0x01);
+   HAL_I2cIdle();
+
+   while(length > 0)
+   {
+      n = (length > 255) ? 255 : length;
+
+      /* ACKs every byte but the chunk's last */
+      HAL_I2cReads(data, n);
+      data += n;
+      length -= n;
+
+      /* More to come - ACK so the device keeps sending */
+      if(length > 0)
+      {
+         HAL_I2cAck();
+      }
+   }
+
+   /* NACK the final byte to end the read */
+   HAL_I2cNotAck();
+   HAL_I2cStop();
+   INSTR_STOP(INSTR_EE_READ, t);
+}
+
+/* One address attempt, STOP whatever the answer - 0 once ACKed. C18's
+ * EEAckPolling retries inside until the device ACKs, so a missing chip
+ * would hang it; the retries and their limit live in EE_WaitReady. */
+static unsigned char EE_AckPoll(unsigned char control)
+{
+   unsigned char nack;
+
+   HAL_I2cIdle();
+   HAL_I2cStart();
+   nack = HAL_I2cWrite(control);   /* -1 on a collision */
+   HAL_I2cIdle();
+   if(!HAL_I2cAcked()) nack = 1;
+   HAL_I2cStop();
+
+   return nack;
+}
+
+/* Poll until the write cycle ends, 0 if the device never ACKs */
+unsigned char EE_WaitReady(unsigned char control)
+{
+   unsigned int start = Timeout_Start();
+
+   while(EE_AckPoll(control))
+   {
+      if(Timeout_Expired(start, I2C_POLL_LIMIT_US)) return 0;
+   }
+
+   return 1;
+}
+
+
+/************************************************************************
+*     Function Name:    HDByteWriteI2C                                  *   
+*     Parameters:       EE memory ControlByte, address and data         *
+*     Description:      Writes data one byte at a time to I2C EE        *
+*                       device. This routine can be used for any I2C    *
+*                       EE memory device, which only uses 1 byte of     *
+*                       address data as in the 24LC01B/02B/04B/08B/16B. *
+*                                                                       *     
+************************************************************************/
+
+unsigned char HDByteWriteI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char data )
+{
+  INSTR_DECLARE(t)
+  INSTR_DECLARE(t_poll)
+
+  INSTR_START(t);
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cStart();                 // initiate START condition and wait
+  HAL_I2cWrite( ControlByte );    // write 1 byte - R/W bit should be 0
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cWrite( HighAdd );        // write address byte to EEPROM
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cWrite( LowAdd );         // write address byte to EEPROM
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cWrite( data );           // Write data byte to EEPROM
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cStop();                  // send STOP condition and wait
+  INSTR_START(t_poll);
+  if ( !EE_WaitReady( ControlByte ) ) //Wait for write cycle to complete
+  {
+    return ( -1 );                // device never came back
+  }
+  INSTR_STOP(INSTR_EE_ACK_POLL, t_poll);
+  INSTR_STOP(INSTR_EE_WRITE, t);
+  return ( 0 );                   // return with no error
+}
+
+/************************************************************************
+*     Function Name:    HDPageWriteI2C                                  *
+*     Parameters:       EE memory ControlByte, address, pointer and     *
+*                       length bytes.                                   *
+*     Description:      Writes up to one page of data with a single     *
+*                       write cycle. The run must not cross a page      *
+*                       boundary - the device wraps within the page.    *
+*                                                                       *
+************************************************************************/
+
+unsigned char HDPageWriteI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char *data, unsigned char length )
+{
+  INSTR_DECLARE(t)
+  INSTR_DECLARE(t_poll)
+
+  INSTR_START(t);
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cStart();                 // initiate START condition and wait
+  HAL_I2cWrite( ControlByte );    // write 1 byte - R/W bit should be 0
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cWrite( HighAdd );        // write address byte to EEPROM
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cWrite( LowAdd );         // write address byte to EEPROM
+  HAL_I2cIdle();                  // ensure module is idle
+  while ( length-- )
+  {
+    HAL_I2cWrite( *data++ );      // Write data bytes into the page buffer
+    HAL_I2cIdle();                // ensure module is idle
+  }
+  HAL_I2cStop();                  // send STOP condition and wait
+  INSTR_START(t_poll);
+  if ( !EE_WaitReady( ControlByte ) ) //Wait for write cycle to complete
+  {
+    return ( -1 );                // device never came back
+  }
+  INSTR_STOP(INSTR_EE_ACK_POLL, t_poll);
+  INSTR_STOP(INSTR_EE_WRITE, t);
+  return ( 0 );                   // return with no error
+}
+
+/********************************************************************
+*     Function Name:    HDByteReadI2C                               *
+*     Parameters:       EE memory ControlByte, address, pointer and *
+*                       length bytes.                               *
+*     Description:      Reads data string from I2C EE memory        *
+*                       device. This routine can be used for any I2C*
+*                       EE memory device, which only uses 1 byte of *
+*                       address data as in the 24LC01B/02B/04B/08B. *
+*                                                                   *  
+********************************************************************/
+
+unsigned char HDByteReadI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char *data, unsigned char length )
+{
+  INSTR_DECLARE(t)
+
+  INSTR_START(t);
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cStart();                 // initiate START condition and wait
+  HAL_I2cWrite( ControlByte );    // write 1 byte 
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cWrite( HighAdd );        // WRITE word address to EEPROM
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cWrite( LowAdd );         // WRITE word address to EEPROM
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cRestart();               // generate I2C bus restart condition and wait
+  HAL_I2cWrite( ControlByte | 0x01 ); // WRITE 1 byte - R/W bit should be 1 for read
+  HAL_I2cIdle();                  // ensure module is idle
+  HAL_I2cReads( data, length );   // read in multiple bytes
+  HAL_I2cNotAck();                // send not ACK condition and wait
+  HAL_I2cStop();                  // send STOP condition and wait
+  INSTR_STOP(INSTR_EE_READ, t);
+  return ( 0 );                   // return with no error
+}
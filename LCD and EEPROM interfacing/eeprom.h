@@ -0,0 +1,38 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: 24LC256 I2C EEPROM access with a page-buffered writer
+ *
+ *******************************************************************/
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include "hal_pic18.h"
+
+/* 24LC256 - 32KB, 64 byte write pages, A2..A0 = 000 */
+#define EE_CONTROL   0xA0
+#define EE_SIZE      32768U
+#define EE_PAGE_SIZE 64
+#define EE_MAX_HZ    400000UL   /* 1MHz only on the 24FC256 */
+
+/* Single transactions - block until the write cycle completes, non-zero
+ * if the device never ACKed again */
+unsigned char HDByteWriteI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char data );
+unsigned char HDPageWriteI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char *data, unsigned char length );
+unsigned char HDByteReadI2C( unsigned char ControlByte, unsigned char HighAdd, unsigned char LowAdd, unsigned char *data, unsigned char length );
+
+/* Page-buffered writer - consecutive bytes within a page are committed
+ * with one write cycle, on a page/run break or EE_Flush() */
+void EE_Write(unsigned int addr, unsigned char data);
+void EE_Flush(void);
+
+/* Sequential read of any length in one transaction - all 0xFF if the
+ * device doesn't answer */
+void EE_Read(unsigned int addr, unsigned char* data, unsigned int length);
+
+/* ACK poll until the write cycle is over - 0 if the device still
+ * NACKs after I2C_POLL_LIMIT_US */
+unsigned char EE_WaitReady(unsigned char control);
+
+#endif
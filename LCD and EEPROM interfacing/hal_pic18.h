@@ -0,0 +1,202 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Hardware abstraction for LCD, UART, I2C and timer access
+ *
+ * On target every call but HAL_TimerRead (delay.c) is a macro over the
+ * SFRs / i2c.h library, so the apps compile to the same register
+ * accesses as before. Building
+ * with HAL_HOST turns them into functions provided by host/hal_host.c,
+ * which runs them against HD44780, 24LC256 and UART models on a
+ * simulated instruction clock.
+ *
+ *******************************************************************/
+#ifndef HAL_PIC18_H
+#define HAL_PIC18_H
+
+/* Oscillator - 4MHz crystal on PICDEM2 Plus, instruction clock Fosc/4.
+ * Another crystal is set from the command line, e.g. -DFOSC=16000000UL,
+ * and must be a multiple of 4MHz (see delay.h) */
+#ifndef FOSC
+#define FOSC 4000000UL
+#endif
+
+/* Timer1 prescaler - the largest of 1:1 to 1:8 that leaves a whole
+ * number of ticks per microsecond, so timeouts keep room in 16 bits */
+#if (FOSC / 4000000UL) % 8 == 0
+#define TIMER_PRESCALE 8
+#define TIMER_T1CKPS   0x30
+#elif (FOSC / 4000000UL) % 4 == 0
+#define TIMER_PRESCALE 4
+#define TIMER_T1CKPS   0x20
+#elif (FOSC / 4000000UL) % 2 == 0
+#define TIMER_PRESCALE 2
+#define TIMER_T1CKPS   0x10
+#else
+#define TIMER_PRESCALE 1
+#define TIMER_T1CKPS   0x00
+#endif
+
+#ifndef HAL_HOST
+
+#include <p18f4520.h>
+#include <i2c.h>
+
+/* Macros of more than one statement are wrapped in do { } while(0), so
+ * they stay whole under an unbraced if or while, like the host functions */
+
+/* LCD - HD44780 4-bit bus, data on bits 3:0 of LCD_PORT. Defaults are the
+ * PICDEM2 Plus wiring (PORTD: RD4 RS, RD5 RW, RD6 E, RD7 power); any pin
+ * can be moved from the command line, e.g. -DLCD_E=LATBbits.LATB0
+ * -DLCD_E_TRIS=TRISBbits.TRISB0 */
+#ifndef LCD_PORT
+#define LCD_PORT        PORTD
+#define LCD_TRIS        TRISD
+#endif
+#ifndef LCD_E
+#define LCD_E           PORTDbits.RD6
+#define LCD_E_TRIS      TRISDbits.TRISD6
+#endif
+#ifndef LCD_RW
+#define LCD_RW          PORTDbits.RD5
+#define LCD_RW_TRIS     TRISDbits.TRISD5
+#endif
+#ifndef LCD_RS
+#define LCD_RS          PORTDbits.RD4
+#define LCD_RS_TRIS     TRISDbits.TRISD4
+#endif
+#ifndef LCD_POWER
+#define LCD_POWER       PORTDbits.RD7
+#define LCD_POWER_TRIS  TRISDbits.TRISD7
+#endif
+
+#define HAL_LcdE(v)       LCD_E = (v)
+#define HAL_LcdRW(v)      LCD_RW = (v)
+#define HAL_LcdRS(v)      LCD_RS = (v)
+#define HAL_LcdPower(v)   LCD_POWER = (v)
+#define HAL_LcdRead()     (LCD_PORT)
+#define HAL_LcdWrite(v)   LCD_PORT = (v)
+#define HAL_LcdPortOut()  do { LCD_TRIS &= 0xF0; \
+                               LCD_E_TRIS = 0; LCD_RW_TRIS = 0; \
+                               LCD_RS_TRIS = 0; LCD_POWER_TRIS = 0; } while(0)
+#define HAL_LcdDataOut()  LCD_TRIS &= 0xF0
+#define HAL_LcdDataIn()   LCD_TRIS |= 0x0F
+
+/* UART - RX/TX pins digital, RC7 in / RC6 out */
+#define HAL_UartConfig(brg, baudcon, txsta, rcsta) do { \
+   SPBRGH = (brg) >> 8; SPBRG = (brg) & 0xFF; BAUDCON = (baudcon); \
+   ADCON1 = 0x0F; TRISC = 0xC0; \
+   TXSTA = (txsta); RCSTA = (rcsta); } while(0)
+#define HAL_UartRxReady() (PIR1bits.RCIF)
+#define HAL_UartRead()    (RCREG)
+#define HAL_UartTxReady() (PIR1bits.TXIF)
+#define HAL_UartWrite(c)  TXREG = (c)
+#define HAL_UartRxIntEnable(v) PIE1bits.RCIE = (v)
+#define HAL_UartTxIntEnable(v) PIE1bits.TXIE = (v)
+#define HAL_UartTxIntEnabled() (PIE1bits.TXIE)
+#define HAL_UartOverrun()      (RCSTAbits.OERR)
+#define HAL_UartClearOverrun() do { RCSTAbits.CREN = 0; RCSTAbits.CREN = 1; } while(0)
+
+/* Interrupts - single priority, peripherals on the 0x08 vector */
+#define HAL_IntEnable()   do { INTCONbits.PEIE = 1; INTCONbits.GIE = 1; } while(0)
+
+/* I2C - MSSP master on RC3/RC4, each bus phase waits for completion */
+#define HAL_I2cConfig(sspadd, smp) do { \
+   SSPCON1 = 0x28; SSPCON2 = 0x00; \
+   SSPSTATbits.SMP = (smp); SSPADD = (sspadd); \
+   TRISCbits.RC3 = 1; TRISCbits.RC4 = 1; } while(0)
+#define HAL_I2cIdle()     IdleI2C()
+#define HAL_I2cStart()    do { StartI2C(); while(SSPCON2bits.SEN); } while(0)
+#define HAL_I2cRestart()  do { RestartI2C(); while(SSPCON2bits.RSEN); } while(0)
+#define HAL_I2cStop()     do { StopI2C(); while(SSPCON2bits.PEN); } while(0)
+#define HAL_I2cNotAck()   do { NotAckI2C(); while(SSPCON2bits.ACKEN); } while(0)
+#define HAL_I2cAck()      do { AckI2C(); while(SSPCON2bits.ACKEN); } while(0)
+#define HAL_I2cWrite(b)   WriteI2C(b)
+#define HAL_I2cReads(p, n) getsI2C((p), (n))
+
+/* I2C - single bus phases for the interrupt driven engine, SSPIF on completion */
+#define HAL_I2cIntEnable(v)  PIE1bits.SSPIE = (v)
+#define HAL_I2cIntPending()  (PIR1bits.SSPIF)
+#define HAL_I2cIntClear()    PIR1bits.SSPIF = 0
+#define HAL_I2cSendStart()   SSPCON2bits.SEN = 1
+#define HAL_I2cSendRestart() SSPCON2bits.RSEN = 1
+#define HAL_I2cSendStop()    SSPCON2bits.PEN = 1
+#define HAL_I2cSendAck(nack) do { SSPCON2bits.ACKDT = (nack); SSPCON2bits.ACKEN = 1; } while(0)
+#define HAL_I2cReceive()     SSPCON2bits.RCEN = 1
+#define HAL_I2cPut(b)        SSPBUF = (b)
+#define HAL_I2cGet()         (SSPBUF)
+#define HAL_I2cAcked()       (!SSPCON2bits.ACKSTAT)
+
+/* Bus collision - the MSSP drops back to idle with BCLIF instead of SSPIF */
+#define HAL_I2cCollisionIntEnable(v) PIE2bits.BCLIE = (v)
+#define HAL_I2cCollision()      (PIR2bits.BCLIF)
+#define HAL_I2cCollisionClear() PIR2bits.BCLIF = 0
+
+/* One pass of a loop waiting on the engine - the ISR does the work */
+#define HAL_I2cWait()        ((void)0)
+
+/* Timer1 - free running 16-bit at Fosc/4/TIMER_PRESCALE, 16-bit reads */
+#define HAL_TimerInit()   T1CON = 0x81 | TIMER_T1CKPS
+unsigned int HAL_TimerRead(void);
+
+#else
+
+/* Host backend */
+void HAL_LcdE(unsigned char v);
+void HAL_LcdRW(unsigned char v);
+void HAL_LcdRS(unsigned char v);
+void HAL_LcdPower(unsigned char v);
+unsigned char HAL_LcdRead(void);
+void HAL_LcdWrite(unsigned char v);
+void HAL_LcdPortOut(void);
+void HAL_LcdDataOut(void);
+void HAL_LcdDataIn(void);
+
+void HAL_UartConfig(unsigned int brg, unsigned char baudcon, unsigned char txsta, unsigned char rcsta);
+unsigned char HAL_UartRxReady(void);
+unsigned char HAL_UartRead(void);
+unsigned char HAL_UartTxReady(void);
+void HAL_UartWrite(unsigned char c);
+void HAL_UartRxIntEnable(unsigned char v);
+void HAL_UartTxIntEnable(unsigned char v);
+unsigned char HAL_UartTxIntEnabled(void);
+unsigned char HAL_UartOverrun(void);
+void HAL_UartClearOverrun(void);
+
+void HAL_IntEnable(void);
+
+void HAL_I2cConfig(unsigned char sspadd, unsigned char smp);
+void HAL_I2cIdle(void);
+void HAL_I2cStart(void);
+void HAL_I2cRestart(void);
+void HAL_I2cStop(void);
+void HAL_I2cNotAck(void);
+void HAL_I2cAck(void);
+unsigned char HAL_I2cWrite(unsigned char b);
+unsigned char HAL_I2cReads(unsigned char* p, unsigned char n);
+
+void HAL_I2cIntEnable(unsigned char v);
+unsigned char HAL_I2cIntPending(void);
+void HAL_I2cIntClear(void);
+void HAL_I2cSendStart(void);
+void HAL_I2cSendRestart(void);
+void HAL_I2cSendStop(void);
+void HAL_I2cSendAck(unsigned char nack);
+void HAL_I2cReceive(void);
+void HAL_I2cPut(unsigned char b);
+unsigned char HAL_I2cGet(void);
+unsigned char HAL_I2cAcked(void);
+void HAL_I2cCollisionIntEnable(unsigned char v);
+unsigned char HAL_I2cCollision(void);
+void HAL_I2cCollisionClear(void);
+void HAL_I2cWait(void);
+
+void HAL_TimerInit(void);
+unsigned int HAL_TimerRead(void);
+
+#define Nop()
+
+#endif
+
+#endif
@@ -0,0 +1,87 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, 24LC256 model
+ * SW: EE_Read bus time against reading the same range a byte per
+ *     transaction, for lengths from 1 byte to 1KB
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "eeprom.h"
+#include "i2c_async.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+#define BASE 0x3F80
+
+static unsigned char got[1024];
+
+
+int main(void)
+{
+   static const unsigned int lengths[] = { 1, 4, 16, 64, 255, 256, 300, 1024 };
+   unsigned long long bus0, t0, seq_bus, seq_time, byte_bus, byte_time;
+   unsigned char* memory;
+   unsigned int i, l, length, addr;
+
+   Host_Reset();
+   EEModel_Reset();
+   EEModel_Attach(EE_CONTROL);
+   Host_SetIsr(I2C_Isr);
+   HAL_TimerInit();
+   I2C_SetSpeed(FOSC, EE_MAX_HZ);
+   I2C_Init();
+
+   memory = EEModel_Memory(EE_CONTROL);
+   for(i = 0; i < EE_SIZE; i++) memory[i] = (unsigned char)(i ^ (i >> 7));
+
+   printf("%6s %12s %12s %12s %12s %6s\n", "bytes", "EE_Read us", "bus us",
+          "bytewise us", "bus us", "ratio");
+
+   for(l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+   {
+      length = lengths[l];
+
+      memset(got, 0, sizeof(got));
+      bus0 = Host_I2cBusCycles();
+      t0 = Host_Cycles();
+      EE_Read(BASE, got, length);
+      seq_time = Host_Cycles() - t0;
+      seq_bus = Host_I2cBusCycles() - bus0;
+      CHECK(memcmp(got, memory + BASE, length) == 0);
+
+      memset(got, 0, sizeof(got));
+      bus0 = Host_I2cBusCycles();
+      t0 = Host_Cycles();
+      for(i = 0; i < length; i++)
+      {
+         addr = BASE + i;
+         HDByteReadI2C(EE_CONTROL, addr >> 8, addr & 0xFF, got + i, 1);
+      }
+      byte_time = Host_Cycles() - t0;
+      byte_bus = Host_I2cBusCycles() - bus0;
+      CHECK(memcmp(got, memory + BASE, length) == 0);
+
+      printf("%6u %12llu %12llu %12llu %12llu %6.2f\n", length,
+             seq_time / HOST_CYCLES_US, seq_bus / HOST_CYCLES_US,
+             byte_time / HOST_CYCLES_US, byte_bus / HOST_CYCLES_US,
+             (double)byte_bus / seq_bus);
+
+      /* Address frame once instead of per byte - from 64 bytes on the
+         bus time is mostly the 9 clocks of each data byte, where a
+         transaction per byte takes 5x that */
+      if(length >= 16) CHECK(2 * byte_bus > 7 * seq_bus);
+      if(length >= 64) CHECK(2 * byte_bus > 9 * seq_bus);
+      if(length >= 64) CHECK(seq_bus < length * 11ULL * HOST_CYCLES_US * 1000000 / Host_I2cClock());
+   }
+
+   /* Past the top of the array the device counter rolls over to 0 */
+   EE_Read(EE_SIZE - 100, got, 300);
+   CHECK(memcmp(got, memory + EE_SIZE - 100, 100) == 0);
+   CHECK(memcmp(got + 100, memory, 200) == 0);
+
+   return TEST_DONE();
+}
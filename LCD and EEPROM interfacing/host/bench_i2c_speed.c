@@ -0,0 +1,74 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, 24LC256 model
+ * SW: EEPROM throughput in bytes/s against the I2C clock, from the
+ *     old fixed 100kHz up to the fastest the 4MHz board gets
+ *
+ *******************************************************************/
+
+#include "eeprom.h"
+#include "i2c_async.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+#define BYTES 4096
+
+static unsigned char data[BYTES];
+
+
+int main(void)
+{
+   static const unsigned long asked[] = { 100000UL, 125000UL, 200000UL, EE_MAX_HZ };
+   double read_bps[4], write_bps[4];
+   unsigned long long t0;
+   unsigned long hz;
+   unsigned int s, i;
+
+   printf("%9s %9s %5s %12s %12s\n", "asked Hz", "bus Hz", "slew", "read B/s", "write B/s");
+
+   for(s = 0; s < sizeof(asked) / sizeof(asked[0]); s++)
+   {
+      Host_Reset();
+      EEModel_Reset();
+      EEModel_Attach(EE_CONTROL);
+      Host_SetIsr(I2C_Isr);
+      HAL_TimerInit();
+      hz = I2C_SetSpeed(FOSC, asked[s]);
+      I2C_Init();
+      CHECK(hz != 0 && hz <= asked[s]);
+      CHECK_EQ(Host_I2cClock(), hz);
+
+      /* Page-buffered writes - mostly the 5ms write cycles */
+      t0 = Host_Cycles();
+      for(i = 0; i < BYTES; i++) EE_Write(i, (unsigned char)(i * 3));
+      EE_Flush();
+      write_bps[s] = BYTES * 1e6 / ((Host_Cycles() - t0) / HOST_CYCLES_US);
+
+      /* One sequential read */
+      t0 = Host_Cycles();
+      EE_Read(0, data, BYTES);
+      read_bps[s] = BYTES * 1e6 / ((Host_Cycles() - t0) / HOST_CYCLES_US);
+      for(i = 0; i < BYTES && data[i] == (unsigned char)(i * 3); i++);
+      CHECK_EQ(i, BYTES);
+
+      printf("%9lu %9lu %5s %12.0f %12.0f\n", asked[s], hz,
+             Host_I2cSlewOff() ? "off" : "on", read_bps[s], write_bps[s]);
+   }
+
+   /* Faster is faster all the way up. Reads gain less than the clock
+      ratio - ACK phases and the SSPIF per phase don't shrink - and
+      page writes less again behind their fixed 5ms write cycles */
+   for(s = 1; s < sizeof(asked) / sizeof(asked[0]); s++)
+   {
+      CHECK(read_bps[s] > read_bps[s - 1]);
+      CHECK(write_bps[s] > write_bps[s - 1]);
+   }
+   CHECK(read_bps[3] > 1.6 * read_bps[0]);
+   CHECK(write_bps[3] > 1.3 * write_bps[0]);
+   CHECK(write_bps[3] < read_bps[3]);
+
+   return TEST_DONE();
+}
@@ -0,0 +1,122 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, two 24LC256 models
+ * SW: Page write throughput of the I2C engine with one chip and with
+ *     two - the second chip's pages go out while the first sits in
+ *     its write cycle
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "eeprom.h"
+#include "i2c_async.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+#define PAGES  64
+#define CHIP_B (EE_CONTROL | 0x02)
+
+static I2C_Request req[I2C_DEPTH];
+static unsigned char frame[I2C_DEPTH][2 + EE_PAGE_SIZE];
+
+
+static void start(void)
+{
+   Host_Reset();
+   EEModel_Reset();
+   EEModel_Attach(EE_CONTROL);
+   EEModel_Attach(CHIP_B);
+   Host_SetIsr(I2C_Isr);
+   HAL_TimerInit();
+   I2C_SetSpeed(FOSC, EE_MAX_HZ);
+   I2C_Init();
+}
+
+/* PAGES page writes, page n to chip B if chips is 2 and n is odd -
+   the queue kept full, returns ms */
+static double run(unsigned char chips)
+{
+   unsigned long long t0 = Host_Cycles();
+   unsigned int n = 0, addr, s;
+   unsigned char control;
+
+   for(s = 0; s < I2C_DEPTH; s++) req[s].status = I2C_OK;
+
+   while(n < PAGES || I2C_Busy())
+   {
+      for(s = 0; s < I2C_DEPTH && n < PAGES; s++)
+      {
+         if(req[s].status == I2C_PENDING) continue;
+
+         control = (chips == 2 && (n & 1)) ? CHIP_B : EE_CONTROL;
+         addr = ((chips == 2) ? n / 2 : n) * EE_PAGE_SIZE;
+         frame[s][0] = addr >> 8;
+         frame[s][1] = addr & 0xFF;
+         memset(frame[s] + 2, n, EE_PAGE_SIZE);
+
+         req[s].control = control;
+         req[s].write = frame[s];
+         req[s].write_len = sizeof(frame[s]);
+         req[s].read_len = 0;
+         req[s].flags = I2C_POLL | I2C_WCYCLE;
+         if(!I2C_Submit(&req[s])) break;
+         n++;
+      }
+      I2C_Poll();
+   }
+
+   /* Last write cycle done */
+   while(!I2C_Ready(EE_CONTROL) || !I2C_Ready(CHIP_B)) I2C_Poll();
+
+   for(s = 0; s < I2C_DEPTH; s++) CHECK_EQ(req[s].status, I2C_OK);
+   return (Host_Cycles() - t0) / (1000.0 * HOST_CYCLES_US);
+}
+
+
+int main(void)
+{
+   EEModel_Stats *a, *b;
+   double one_ms, two_ms;
+   unsigned int i;
+
+   start();
+   one_ms = run(1);
+   a = EEModel_GetStats(EE_CONTROL);
+   CHECK_EQ(a->write_cycles, PAGES);
+   CHECK_EQ(a->busy_nacks, 0);
+   CHECK_EQ(EEModel_Memory(EE_CONTROL)[(PAGES - 1) * EE_PAGE_SIZE], PAGES - 1);
+
+   start();
+   two_ms = run(2);
+   a = EEModel_GetStats(EE_CONTROL);
+   b = EEModel_GetStats(CHIP_B);
+   CHECK_EQ(a->write_cycles, PAGES / 2);
+   CHECK_EQ(b->write_cycles, PAGES / 2);
+   CHECK_EQ(a->busy_nacks + b->busy_nacks, 0);
+   for(i = 0; i < PAGES; i++)
+   {
+      CHECK_EQ(EEModel_Memory((i & 1) ? CHIP_B : EE_CONTROL)[(i / 2) * EE_PAGE_SIZE], i);
+   }
+
+   printf("%u pages: one chip %.1f ms (%.0f B/s), two chips %.1f ms (%.0f B/s)\n",
+          PAGES, one_ms, PAGES * EE_PAGE_SIZE * 1000.0 / one_ms,
+          two_ms, PAGES * EE_PAGE_SIZE * 1000.0 / two_ms);
+
+   /* Write cycles overlap - close to twice the rate, no ACK polls
+      hammering a chip in its cycle */
+   CHECK(two_ms < 0.65 * one_ms);
+
+   /* Stamps are retired, so Timer1 wrapping never makes a chip look
+      busy again - 200ms of polling after the last write */
+   for(i = 0; i < 200; i++)
+   {
+      Host_Advance(1000);
+      I2C_Poll();
+      if(i >= 6) CHECK(I2C_Ready(EE_CONTROL) && I2C_Ready(CHIP_B));
+   }
+
+   return TEST_DONE();
+}
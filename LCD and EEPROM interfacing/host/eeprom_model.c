@@ -0,0 +1,212 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Behavioral 24LC256 model on the I2C bus
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "eeprom_model.h"
+
+/* Frame phase of one chip */
+#define IDLE     0
+#define CONTROL  1
+#define ADDR_H   2
+#define ADDR_L   3
+#define DATA     4
+#define READ     5
+
+typedef struct
+{
+   unsigned char fitted;
+   unsigned char phase;
+   unsigned int pointer;
+   unsigned long long busy_until;
+
+   /* Page latch of the frame in progress */
+   unsigned int page;
+   unsigned char offset;
+   unsigned int count;
+   unsigned char latch[EEMODEL_PAGE];
+   unsigned char loaded[EEMODEL_PAGE];
+
+   EEModel_Stats stats;
+   unsigned char memory[EEMODEL_SIZE];
+} Chip;
+
+static Chip chips[8];
+static unsigned long long write_cycle_ns = 5000000ULL;
+
+#define CHIP(control) (((control) >> 1) & 0x07)
+
+
+void EEModel_Reset(void)
+{
+   memset(chips, 0, sizeof(chips));
+   write_cycle_ns = 5000000ULL;
+}
+
+void EEModel_Attach(unsigned char control)
+{
+   Chip* c = &chips[CHIP(control)];
+
+   memset(c, 0, sizeof(*c));
+   memset(c->memory, 0xFF, sizeof(c->memory));
+   c->fitted = 1;
+}
+
+void EEModel_SetWriteCycle(unsigned int us)
+{
+   write_cycle_ns = us * 1000ULL;
+}
+
+unsigned char* EEModel_Memory(unsigned char control)
+{
+   Chip* c = &chips[CHIP(control)];
+
+   return c->fitted ? c->memory : 0;
+}
+
+EEModel_Stats* EEModel_GetStats(unsigned char control)
+{
+   Chip* c = &chips[CHIP(control)];
+
+   return c->fitted ? &c->stats : 0;
+}
+
+void EEModel_ResetStats(void)
+{
+   int i;
+
+   for(i = 0; i < 8; i++) memset(&chips[i].stats, 0, sizeof(chips[i].stats));
+}
+
+
+/* START or repeated START - a write frame without STOP is dropped */
+void EEModel_Start(unsigned long long now_ns)
+{
+   int i;
+
+   for(i = 0; i < 8; i++) chips[i].phase = CONTROL;
+}
+
+
+/* STOP - a write frame with data starts the write cycle */
+void EEModel_Stop(unsigned long long now_ns)
+{
+   Chip* c;
+   int i, j;
+
+   for(i = 0; i < 8; i++)
+   {
+      c = &chips[i];
+      if(c->fitted && c->phase == DATA && c->count > 0)
+      {
+         for(j = 0; j < EEMODEL_PAGE; j++)
+         {
+            if(!c->loaded[j]) continue;
+            c->memory[c->page + j] = c->latch[j];
+            c->stats.bytes_written++;
+         }
+         if(c->count > EEMODEL_PAGE) c->stats.page_wraps++;
+
+         c->stats.write_cycles++;
+         c->stats.page_cycles[c->page / EEMODEL_PAGE]++;
+         if(c->stats.write_cycles == 1) c->stats.first_cycle_ns = now_ns;
+         c->stats.last_cycle_ns = now_ns;
+         c->busy_until = now_ns + write_cycle_ns;
+         c->pointer = c->page + c->offset;
+      }
+      c->phase = IDLE;
+   }
+}
+
+
+unsigned char EEModel_Write(unsigned char byte, unsigned long long now_ns)
+{
+   unsigned char ack = 0;
+   Chip* c;
+   int i;
+
+   for(i = 0; i < 8; i++)
+   {
+      c = &chips[i];
+      if(!c->fitted) continue;
+
+      switch(c->phase)
+      {
+      case CONTROL:
+         c->phase = IDLE;
+         if((byte & 0xF0) != 0xA0 || CHIP(byte) != i) break;
+         if(now_ns < c->busy_until)
+         {
+            c->stats.busy_nacks++;
+            break;
+         }
+         c->phase = (byte & 0x01) ? READ : ADDR_H;
+         ack = 1;
+         break;
+
+      case ADDR_H:
+         c->pointer = (unsigned int)(byte & 0x7F) << 8;
+         c->phase = ADDR_L;
+         ack = 1;
+         break;
+
+      case ADDR_L:
+         c->pointer |= byte;
+         c->page = c->pointer & ~(EEMODEL_PAGE - 1);
+         c->offset = c->pointer & (EEMODEL_PAGE - 1);
+         c->count = 0;
+         memset(c->loaded, 0, sizeof(c->loaded));
+         c->phase = DATA;
+         ack = 1;
+         break;
+
+      case DATA:
+         /* The page latch wraps - bytes past the page end overwrite its start */
+         c->latch[c->offset] = byte;
+         c->loaded[c->offset] = 1;
+         c->offset = (c->offset + 1) & (EEMODEL_PAGE - 1);
+         c->count++;
+         ack = 1;
+         break;
+      }
+   }
+
+   return ack;
+}
+
+
+unsigned char EEModel_Read(unsigned long long now_ns)
+{
+   unsigned char byte = 0xFF;
+   Chip* c;
+   int i;
+
+   for(i = 0; i < 8; i++)
+   {
+      c = &chips[i];
+      if(!c->fitted || c->phase != READ) continue;
+
+      byte = c->memory[c->pointer];
+      c->pointer = (c->pointer + 1) & (EEMODEL_SIZE - 1);
+      c->stats.bytes_read++;
+   }
+
+   return byte;
+}
+
+
+/* Master NACK ends a sequential read */
+void EEModel_Ack(unsigned char ack)
+{
+   int i;
+
+   if(ack) return;
+   for(i = 0; i < 8; i++)
+   {
+      if(chips[i].phase == READ) chips[i].phase = IDLE;
+   }
+}
@@ -0,0 +1,57 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Behavioral 24LC256 model on the I2C bus
+ *
+ * Up to eight chips share the bus, each answering the control byte
+ * of its A2..A0 strapping. A write frame sets the address pointer
+ * and fills the 64 byte page latch (wrapping inside the page); the
+ * STOP starts the write cycle, during which the chip NACKs its
+ * address. Reads run sequentially over the whole 32KB. The MSSP
+ * side of the host backend drives these bus events.
+ *
+ *******************************************************************/
+#ifndef EEPROM_MODEL_H
+#define EEPROM_MODEL_H
+
+#define EEMODEL_SIZE 32768U
+#define EEMODEL_PAGE 64
+
+/* Per chip counters */
+typedef struct
+{
+   unsigned long write_cycles;
+   unsigned long bytes_written;    /* bytes programmed, page latch rewrites once */
+   unsigned long bytes_read;
+   unsigned long busy_nacks;       /* address NACKed inside a write cycle */
+   unsigned long page_wraps;       /* frames that ran past the page end */
+   unsigned long page_cycles[EEMODEL_SIZE / EEMODEL_PAGE];   /* wear per page */
+   unsigned long long first_cycle_ns;
+   unsigned long long last_cycle_ns;
+} EEModel_Stats;
+
+/* Remove every chip from the bus */
+void EEModel_Reset(void);
+
+/* Fit a blank (0xFF) chip answering control byte 0xA0 | A2..A0 << 1 */
+void EEModel_Attach(unsigned char control);
+
+/* Write cycle length, default 5ms (tWC max) */
+void EEModel_SetWriteCycle(unsigned int us);
+
+/* Bus events - start covers repeated start too. Write returns the ACK
+ * of whichever chip is addressed, read the byte it drives (0xFF if
+ * none). ack is the master's ACK after a read byte. */
+void EEModel_Start(unsigned long long now_ns);
+void EEModel_Stop(unsigned long long now_ns);
+unsigned char EEModel_Write(unsigned char byte, unsigned long long now_ns);
+unsigned char EEModel_Read(unsigned long long now_ns);
+void EEModel_Ack(unsigned char ack);
+
+/* Back door to a chip's array and its counters, 0 if not fitted */
+unsigned char* EEModel_Memory(unsigned char control);
+EEModel_Stats* EEModel_GetStats(unsigned char control);
+void EEModel_ResetStats(void);
+
+#endif
@@ -0,0 +1,636 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host standing in for the PIC18F4520
+ * SW: HAL_HOST backend - LCD pins, USART, MSSP I2C, Timer1
+ *
+ * Time is simulated in instruction cycles. Every HAL call costs a
+ * nominal cycle, bus phases and UART frames take their wire time,
+ * and the registered ISR runs whenever a source with its IE bit set
+ * raises its flag, between HAL calls of the main line. The LCD pins
+ * drive the HD44780 model and the MSSP the 24LC256 bus model.
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "hal_pic18.h"
+#include "host_pic18.h"
+#include "hd44780_model.h"
+#include "eeprom_model.h"
+
+/* Cycles for one HAL call (an SFR access or two) and an interrupt
+ * entry/exit with context save */
+#define CALL_CYCLES 1
+#define ISR_CYCLES  20
+
+#define NEVER  (~0ULL)
+#define CYCLE_NS (4000000000ULL / FOSC)
+
+/* Far end of the UART line */
+#define LINE_SIZE 8192
+
+static unsigned long long cycles;
+static void (*isr)(void);
+static unsigned char gie, in_isr;
+
+/* LCD */
+static unsigned char lcd_e, lcd_rw, lcd_rs, lcd_data, lcd_input, lcd_bus;
+
+/* USART */
+static unsigned long long uart_frame;         /* cycles per 10 bit frame */
+static unsigned long uart_baud;
+static unsigned char uart_rx_on, uart_tx_on;
+static unsigned char rx_fifo[2], rx_count, rx_oerr, rcie;
+static unsigned char line[LINE_SIZE];
+static unsigned long long line_at[LINE_SIZE];
+static unsigned int line_head, line_tail;
+static unsigned long uart_lost;
+static unsigned char txreg, txreg_full, tsr, tsr_busy, txie;
+static unsigned long long txreg_at, tx_free_at, tx_done_at;
+static unsigned char sent[LINE_SIZE];
+static unsigned int sent_len;
+
+/* MSSP */
+static unsigned int i2c_period;               /* cycles per SCL period */
+static unsigned char i2c_smp;
+static unsigned char sspif, sspie, ackstat, sspbuf, i2c_busy;
+static unsigned char bclif, bclie, i2c_collide, i2c_lost;
+static unsigned long long i2c_done_at, i2c_bus;
+
+
+static unsigned long long now_ns(void)
+{
+   return cycles * CYCLE_NS;
+}
+
+
+/* Peripheral events due by now */
+static void events(void)
+{
+   unsigned char c;
+
+   while(line_tail != line_head && line_at[line_tail % LINE_SIZE] <= cycles)
+   {
+      c = line[line_tail % LINE_SIZE];
+      line_tail++;
+
+      /* Receiver stalls on OERR until CREN is cycled */
+      if(!uart_rx_on || rx_oerr)
+      {
+         uart_lost++;
+      }
+      else if(rx_count == 2)
+      {
+         rx_oerr = 1;
+         uart_lost++;
+      }
+      else
+      {
+         rx_fifo[rx_count++] = c;
+      }
+   }
+
+   for(;;)
+   {
+      if(tsr_busy)
+      {
+         if(tx_done_at > cycles) break;
+         if(sent_len < LINE_SIZE) sent[sent_len++] = tsr;
+         tsr_busy = 0;
+         tx_free_at = tx_done_at;
+      }
+      if(!txreg_full) break;
+
+      tsr = txreg;
+      txreg_full = 0;
+      tsr_busy = 1;
+      tx_done_at = ((txreg_at > tx_free_at) ? txreg_at : tx_free_at) + uart_frame;
+   }
+
+   if(i2c_busy && i2c_done_at <= cycles)
+   {
+      i2c_busy = 0;
+      if(i2c_lost) bclif = 1;
+      else sspif = 1;
+      i2c_lost = 0;
+   }
+}
+
+static unsigned long long next_event(void)
+{
+   unsigned long long next = NEVER;
+
+   if(line_tail != line_head) next = line_at[line_tail % LINE_SIZE];
+   if(tsr_busy && tx_done_at < next) next = tx_done_at;
+   if(i2c_busy && i2c_done_at < next) next = i2c_done_at;
+
+   return next;
+}
+
+static unsigned char pending(void)
+{
+   return (rcie && rx_count) || (txie && !txreg_full) || (sspie && sspif) || (bclie && bclif);
+}
+
+/* Serve interrupts - the ISR's own HAL calls don't nest */
+static void interrupts(void)
+{
+   int guard = 0;
+
+   if(!gie || in_isr || !isr) return;
+
+   while(pending() && guard++ < 64)
+   {
+      in_isr = 1;
+      cycles += ISR_CYCLES;
+      events();
+      isr();
+      in_isr = 0;
+   }
+}
+
+/* Main line spends n cycles - interrupt time comes on top */
+static void advance(unsigned long long n)
+{
+   unsigned long long target = cycles + n, next, before;
+
+   for(;;)
+   {
+      next = next_event();
+      if(next > target) next = target;
+      if(next > cycles) cycles = next;
+      events();
+
+      before = cycles;
+      interrupts();
+      target += cycles - before;
+
+      if(cycles >= target) break;
+   }
+}
+
+
+void Host_Reset(void)
+{
+   cycles = 0;
+   isr = 0;
+   gie = in_isr = 0;
+   lcd_e = lcd_rw = lcd_rs = lcd_data = lcd_input = lcd_bus = 0;
+   uart_frame = 0;
+   uart_baud = 0;
+   uart_rx_on = uart_tx_on = 0;
+   rx_count = rx_oerr = rcie = 0;
+   line_head = line_tail = 0;
+   uart_lost = 0;
+   txreg_full = tsr_busy = txie = 0;
+   txreg_at = tx_free_at = tx_done_at = 0;
+   sent_len = 0;
+   i2c_period = 128;
+   i2c_smp = 0;
+   sspif = sspie = ackstat = i2c_busy = 0;
+   bclif = bclie = i2c_collide = i2c_lost = 0;
+   i2c_done_at = i2c_bus = 0;
+}
+
+void Host_SetIsr(void (*handler)(void))
+{
+   isr = handler;
+}
+
+unsigned long long Host_Cycles(void)
+{
+   return cycles;
+}
+
+void Host_Advance(unsigned long us)
+{
+   advance((unsigned long long)us * HOST_CYCLES_US);
+}
+
+void Host_UartSend(const unsigned char* data, unsigned int length)
+{
+   unsigned long long at = cycles;
+   unsigned int i;
+
+   /* Back to back behind whatever is still on the line */
+   if(line_tail != line_head && line_at[(line_head - 1) % LINE_SIZE] > at)
+   {
+      at = line_at[(line_head - 1) % LINE_SIZE];
+   }
+
+   for(i = 0; i < length && line_head - line_tail < LINE_SIZE; i++)
+   {
+      at += uart_frame;
+      line[line_head % LINE_SIZE] = data[i];
+      line_at[line_head % LINE_SIZE] = at;
+      line_head++;
+   }
+}
+
+unsigned int Host_UartPending(void)
+{
+   return line_head - line_tail;
+}
+
+unsigned int Host_UartReceived(unsigned char* data, unsigned int max)
+{
+   unsigned int n = (sent_len < max) ? sent_len : max;
+
+   memcpy(data, sent, n);
+   memmove(sent, sent + n, sent_len - n);
+   sent_len -= n;
+
+   return n;
+}
+
+unsigned long Host_UartLost(void)
+{
+   return uart_lost;
+}
+
+unsigned long Host_UartBaud(void)
+{
+   return uart_baud;
+}
+
+unsigned long Host_I2cClock(void)
+{
+   return FOSC / (4UL * i2c_period);
+}
+
+unsigned char Host_I2cSlewOff(void)
+{
+   return i2c_smp;
+}
+
+void Host_I2cCollide(void)
+{
+   i2c_collide = 1;
+}
+
+unsigned long long Host_I2cBusCycles(void)
+{
+   return i2c_bus;
+}
+
+
+/* LCD - E edges clock the HD44780 model */
+void HAL_LcdE(unsigned char v)
+{
+   advance(CALL_CYCLES);
+
+   if(v && !lcd_e && lcd_rw) lcd_bus = HD44780_Read(lcd_rs, now_ns());
+   if(!v && lcd_e && !lcd_rw) HD44780_Write(lcd_rs, lcd_data, now_ns());
+
+   lcd_e = v;
+}
+
+void HAL_LcdRW(unsigned char v)
+{
+   advance(CALL_CYCLES);
+   lcd_rw = v;
+}
+
+void HAL_LcdRS(unsigned char v)
+{
+   advance(CALL_CYCLES);
+   lcd_rs = v;
+}
+
+void HAL_LcdPower(unsigned char v)
+{
+   advance(CALL_CYCLES);
+   HD44780_Power(v, now_ns());
+}
+
+/* Data pins - what the controller drives while E is high on a read */
+unsigned char HAL_LcdRead(void)
+{
+   advance(CALL_CYCLES);
+   return (lcd_input && lcd_e && lcd_rw) ? lcd_bus : lcd_data;
+}
+
+void HAL_LcdWrite(unsigned char v)
+{
+   advance(CALL_CYCLES);
+   lcd_data = v & 0x0F;
+}
+
+void HAL_LcdPortOut(void)
+{
+   advance(CALL_CYCLES);
+   lcd_input = 0;
+}
+
+void HAL_LcdDataOut(void)
+{
+   advance(CALL_CYCLES);
+   lcd_input = 0;
+}
+
+void HAL_LcdDataIn(void)
+{
+   advance(CALL_CYCLES);
+   lcd_input = 1;
+}
+
+
+/* USART - 2 byte RX FIFO, TXREG + shift register */
+void HAL_UartConfig(unsigned int brg, unsigned char baudcon, unsigned char txsta, unsigned char rcsta)
+{
+   unsigned long mult;
+
+   if(baudcon & 0x08) mult = (txsta & 0x04) ? 4 : 16;
+   else mult = (txsta & 0x04) ? 16 : 64;
+
+   uart_baud = FOSC / (mult * ((unsigned long)brg + 1));
+   uart_frame = 10ULL * mult * ((unsigned long long)brg + 1) / 4;
+   uart_tx_on = (txsta & 0x20) != 0;
+   uart_rx_on = (rcsta & 0x90) == 0x90;
+
+   advance(CALL_CYCLES);
+}
+
+unsigned char HAL_UartRxReady(void)
+{
+   advance(CALL_CYCLES);
+   return rx_count != 0;
+}
+
+unsigned char HAL_UartRead(void)
+{
+   unsigned char c;
+
+   advance(CALL_CYCLES);
+   if(rx_count == 0) return 0;
+
+   c = rx_fifo[0];
+   rx_fifo[0] = rx_fifo[1];
+   rx_count--;
+
+   return c;
+}
+
+unsigned char HAL_UartTxReady(void)
+{
+   advance(CALL_CYCLES);
+   return !txreg_full;
+}
+
+void HAL_UartWrite(unsigned char c)
+{
+   if(!uart_tx_on) return;
+
+   /* A full TXREG is overwritten, as on the part */
+   txreg = c;
+   txreg_full = 1;
+   txreg_at = cycles;
+   advance(CALL_CYCLES);
+}
+
+void HAL_UartRxIntEnable(unsigned char v)
+{
+   rcie = v;
+   advance(CALL_CYCLES);
+}
+
+void HAL_UartTxIntEnable(unsigned char v)
+{
+   txie = v;
+   advance(CALL_CYCLES);
+}
+
+unsigned char HAL_UartTxIntEnabled(void)
+{
+   return txie;
+}
+
+unsigned char HAL_UartOverrun(void)
+{
+   advance(CALL_CYCLES);
+   return rx_oerr;
+}
+
+void HAL_UartClearOverrun(void)
+{
+   rx_oerr = 0;
+   advance(CALL_CYCLES);
+}
+
+
+void HAL_IntEnable(void)
+{
+   gie = 1;
+   advance(CALL_CYCLES);
+}
+
+
+/* MSSP - one bus phase of the given SCL periods, SSPIF when done */
+static void i2c_phase(unsigned int periods)
+{
+   i2c_busy = 1;
+   i2c_done_at = cycles + (unsigned long long)periods * i2c_period;
+   i2c_bus += (unsigned long long)periods * i2c_period;
+}
+
+/* Time the bus phase about to start ends at */
+static unsigned long long phase_end_ns(unsigned int periods)
+{
+   return (cycles + (unsigned long long)periods * i2c_period) * CYCLE_NS;
+}
+
+/* Host_I2cCollide armed - this phase loses the bus. The chips see a
+ * START that is never followed up, which drops any frame in progress. */
+static unsigned char i2c_collision(void)
+{
+   if(!i2c_collide) return 0;
+
+   i2c_collide = 0;
+   EEModel_Start(phase_end_ns(1));
+   i2c_phase(1);
+   i2c_lost = 1;
+   advance(CALL_CYCLES);
+   return 1;
+}
+
+static void i2c_wait(void)
+{
+   if(i2c_busy && i2c_done_at > cycles) advance(i2c_done_at - cycles);
+   advance(0);
+}
+
+void HAL_I2cConfig(unsigned char sspadd, unsigned char smp)
+{
+   i2c_period = sspadd + 1;
+   i2c_smp = smp;
+   advance(CALL_CYCLES);
+}
+
+void HAL_I2cSendStart(void)
+{
+   if(i2c_collision()) return;
+   EEModel_Start(phase_end_ns(1));
+   i2c_phase(1);
+   advance(CALL_CYCLES);
+}
+
+void HAL_I2cSendRestart(void)
+{
+   if(i2c_collision()) return;
+   EEModel_Start(phase_end_ns(1));
+   i2c_phase(1);
+   advance(CALL_CYCLES);
+}
+
+void HAL_I2cSendStop(void)
+{
+   if(i2c_collision()) return;
+   EEModel_Stop(phase_end_ns(1));
+   i2c_phase(1);
+   advance(CALL_CYCLES);
+}
+
+void HAL_I2cSendAck(unsigned char nack)
+{
+   if(i2c_collision()) return;
+   EEModel_Ack(!nack);
+   i2c_phase(1);
+   advance(CALL_CYCLES);
+}
+
+/* 8 data bits and the ACK bit */
+void HAL_I2cPut(unsigned char b)
+{
+   if(i2c_collision()) return;
+   ackstat = !EEModel_Write(b, phase_end_ns(9));
+   i2c_phase(9);
+   advance(CALL_CYCLES);
+}
+
+void HAL_I2cReceive(void)
+{
+   if(i2c_collision()) return;
+   sspbuf = EEModel_Read(phase_end_ns(8));
+   i2c_phase(8);
+   advance(CALL_CYCLES);
+}
+
+unsigned char HAL_I2cGet(void)
+{
+   advance(CALL_CYCLES);
+   return sspbuf;
+}
+
+unsigned char HAL_I2cAcked(void)
+{
+   advance(CALL_CYCLES);
+   return !ackstat;
+}
+
+void HAL_I2cIntEnable(unsigned char v)
+{
+   sspie = v;
+   advance(CALL_CYCLES);
+}
+
+unsigned char HAL_I2cIntPending(void)
+{
+   return sspif;
+}
+
+void HAL_I2cIntClear(void)
+{
+   sspif = 0;
+}
+
+void HAL_I2cWait(void)
+{
+   advance(CALL_CYCLES);
+}
+
+void HAL_I2cCollisionIntEnable(unsigned char v)
+{
+   bclie = v;
+   advance(CALL_CYCLES);
+}
+
+unsigned char HAL_I2cCollision(void)
+{
+   return bclif;
+}
+
+void HAL_I2cCollisionClear(void)
+{
+   bclif = 0;
+}
+
+
+/* Blocking phases, as the C18 i2c.h routines */
+void HAL_I2cIdle(void)
+{
+   i2c_wait();
+}
+
+void HAL_I2cStart(void)
+{
+   HAL_I2cSendStart();
+   i2c_wait();
+}
+
+void HAL_I2cRestart(void)
+{
+   HAL_I2cSendRestart();
+   i2c_wait();
+}
+
+void HAL_I2cStop(void)
+{
+   HAL_I2cSendStop();
+   i2c_wait();
+}
+
+void HAL_I2cNotAck(void)
+{
+   HAL_I2cSendAck(1);
+   i2c_wait();
+}
+
+void HAL_I2cAck(void)
+{
+   HAL_I2cSendAck(0);
+   i2c_wait();
+}
+
+/* WriteI2C - 0 when ACKed, -2 on NACK */
+unsigned char HAL_I2cWrite(unsigned char b)
+{
+   HAL_I2cPut(b);
+   i2c_wait();
+   return ackstat ? (unsigned char)-2 : 0;
+}
+
+/* getsI2C - ACKs every byte but the last */
+unsigned char HAL_I2cReads(unsigned char* p, unsigned char n)
+{
+   while(n--)
+   {
+      HAL_I2cReceive();
+      i2c_wait();
+      *p++ = sspbuf;
+      if(n) HAL_I2cAck();
+   }
+   return 0;
+}
+
+
+/* Timer1 - runs at Fosc/4 behind the prescaler */
+void HAL_TimerInit(void)
+{
+   advance(CALL_CYCLES);
+}
+
+unsigned int HAL_TimerRead(void)
+{
+   advance(CALL_CYCLES);
+   return (unsigned int)((cycles / TIMER_PRESCALE) & 0xFFFF);
+}
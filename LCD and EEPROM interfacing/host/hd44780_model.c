@@ -0,0 +1,215 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Behavioral HD44780 model on the 4-bit bus
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "hd44780_model.h"
+
+/* Execution times at 270kHz, ns */
+#define T_POWER  15000000ULL
+#define T_CLEAR  1520000ULL
+#define T_CMD    37000ULL
+#define T_DATA   41000ULL    /* 37us + tADD */
+
+HD44780_Stats hd44780_stats;
+
+static struct
+{
+   unsigned char powered;
+   unsigned char eight_bit;
+   unsigned char low_nibble;     /* next E pulse moves the low nibble */
+   unsigned char high;           /* latched high nibble of a write */
+   unsigned char status;         /* BF/AC sampled on the first read nibble */
+   unsigned char lines;
+   unsigned char increment;
+   unsigned char ac;
+   unsigned char ddram[128];
+   unsigned long long busy_until;
+} lcd;
+
+
+void HD44780_ResetStats(void)
+{
+   memset(&hd44780_stats, 0, sizeof(hd44780_stats));
+}
+
+
+void HD44780_Power(unsigned char on, unsigned long long now_ns)
+{
+   if(on && !lcd.powered)
+   {
+      memset(&lcd, 0, sizeof(lcd));
+      memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+      lcd.eight_bit = 1;
+      lcd.lines = 1;
+      lcd.increment = 1;
+      lcd.busy_until = now_ns + T_POWER;
+      HD44780_ResetStats();
+   }
+   lcd.powered = on;
+}
+
+
+/* Address counter step, following the line ends of the address map */
+static void step(void)
+{
+   if(lcd.increment)
+   {
+      lcd.ac++;
+      if(lcd.lines == 2 && lcd.ac == 0x28) lcd.ac = 0x40;
+      else if(lcd.lines == 2 && lcd.ac == 0x68) lcd.ac = 0x00;
+      else if(lcd.lines == 1 && lcd.ac == 0x50) lcd.ac = 0x00;
+   }
+   else
+   {
+      if(lcd.lines == 2 && lcd.ac == 0x40) lcd.ac = 0x27;
+      else if(lcd.ac == 0x00) lcd.ac = (lcd.lines == 2) ? 0x67 : 0x4F;
+      else lcd.ac--;
+   }
+}
+
+
+static void execute(unsigned char rs, unsigned char byte, unsigned long long now_ns)
+{
+   unsigned long long t = T_CMD;
+
+   if(now_ns < lcd.busy_until)
+   {
+      hd44780_stats.violations++;
+      return;
+   }
+
+   if(rs)
+   {
+      hd44780_stats.data_writes++;
+      lcd.ddram[lcd.ac & 0x7F] = byte;
+      step();
+      lcd.busy_until = now_ns + T_DATA;
+      return;
+   }
+
+   hd44780_stats.instructions++;
+
+   if(byte & 0x80)
+   {
+      hd44780_stats.address_sets++;
+      lcd.ac = byte & 0x7F;
+   }
+   else if(byte & 0x40)
+   {
+      /* CGRAM address - not modelled */
+   }
+   else if(byte & 0x20)
+   {
+      lcd.eight_bit = (byte & 0x10) != 0;
+      lcd.lines = (byte & 0x08) ? 2 : 1;
+   }
+   else if((byte & 0xFC) == 0x04)
+   {
+      lcd.increment = (byte & 0x02) != 0;
+   }
+   else if(byte == 0x01)
+   {
+      memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+      lcd.ac = 0;
+      lcd.increment = 1;
+      t = T_CLEAR;
+   }
+   else if((byte & 0xFE) == 0x02)
+   {
+      lcd.ac = 0;
+      t = T_CLEAR;
+   }
+
+   lcd.busy_until = now_ns + t;
+}
+
+
+void HD44780_Write(unsigned char rs, unsigned char nibble, unsigned long long now_ns)
+{
+   if(!lcd.powered) return;
+
+   nibble &= 0x0F;
+   hd44780_stats.nibbles++;
+
+   /* 8-bit mode - DB3..DB0 are not wired, read as 0 */
+   if(lcd.eight_bit)
+   {
+      execute(rs, nibble << 4, now_ns);
+      return;
+   }
+
+   if(!lcd.low_nibble)
+   {
+      lcd.high = nibble;
+      lcd.low_nibble = 1;
+      return;
+   }
+
+   lcd.low_nibble = 0;
+   execute(rs, (lcd.high << 4) | nibble, now_ns);
+}
+
+
+unsigned char HD44780_Read(unsigned char rs, unsigned long long now_ns)
+{
+   if(!lcd.powered || rs) return 0;
+
+   if(lcd.eight_bit || !lcd.low_nibble)
+   {
+      lcd.status = lcd.ac & 0x7F;
+      if(now_ns < lcd.busy_until)
+      {
+         lcd.status |= 0x80;
+         hd44780_stats.busy_reads++;
+      }
+      hd44780_stats.status_reads++;
+
+      if(!lcd.eight_bit) lcd.low_nibble = 1;
+      return lcd.status >> 4;
+   }
+
+   lcd.low_nibble = 0;
+   return lcd.status & 0x0F;
+}
+
+
+unsigned char HD44780_Cell(unsigned char row, unsigned char col,
+                           unsigned char rows, unsigned char cols)
+{
+   unsigned char base;
+
+   if(rows == 1) base = 0x00;
+   else if(row & 1) base = 0x40;
+   else base = 0x00;
+
+   /* 4 line panels continue lines 0/1 */
+   if(rows == 4 && row >= 2) base += cols;
+
+   return lcd.ddram[(base + col) & 0x7F];
+}
+
+
+unsigned char HD44780_Ddram(unsigned char addr)
+{
+   return lcd.ddram[addr & 0x7F];
+}
+
+unsigned char HD44780_Address(void)
+{
+   return lcd.ac;
+}
+
+unsigned char HD44780_Lines(void)
+{
+   return lcd.lines;
+}
+
+unsigned char HD44780_FourBit(void)
+{
+   return !lcd.eight_bit;
+}
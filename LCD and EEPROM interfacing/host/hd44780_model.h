@@ -0,0 +1,53 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Behavioral HD44780 model on the 4-bit bus
+ *
+ * Powers up in 8-bit mode and follows the function set into 4-bit
+ * mode, where each E pulse moves one nibble (high first) for writes
+ * and for status reads alike. Instructions and data take their
+ * datasheet execution time, BF reads back set meanwhile, and a write
+ * that arrives while busy is counted and dropped as the controller
+ * would. DDRAM follows the one/two line address map, so a panel of
+ * any supported size can be read back cell by cell.
+ *
+ *******************************************************************/
+#ifndef HD44780_MODEL_H
+#define HD44780_MODEL_H
+
+/* Bus activity - cleared on power up and by HD44780_ResetStats */
+typedef struct
+{
+   unsigned long nibbles;        /* E pulses writing a nibble */
+   unsigned long status_reads;   /* BF/AC reads (two nibbles each) */
+   unsigned long busy_reads;     /* of those, with BF set */
+   unsigned long instructions;
+   unsigned long data_writes;
+   unsigned long address_sets;   /* set DDRAM address */
+   unsigned long violations;     /* writes while busy - lost */
+} HD44780_Stats;
+
+extern HD44780_Stats hd44780_stats;
+
+/* Vcc on/off - power on resets to 8-bit mode, busy for 15ms */
+void HD44780_Power(unsigned char on, unsigned long long now_ns);
+
+/* Falling E with RW low latches a nibble, rising E with RW high
+ * drives one onto the bus */
+void HD44780_Write(unsigned char rs, unsigned char nibble, unsigned long long now_ns);
+unsigned char HD44780_Read(unsigned char rs, unsigned long long now_ns);
+
+/* Character shown at a cell of a cols x rows panel */
+unsigned char HD44780_Cell(unsigned char row, unsigned char col,
+                           unsigned char rows, unsigned char cols);
+
+/* Raw state for checks */
+unsigned char HD44780_Ddram(unsigned char addr);
+unsigned char HD44780_Address(void);
+unsigned char HD44780_Lines(void);      /* 1 or 2 from the function set */
+unsigned char HD44780_FourBit(void);
+
+void HD44780_ResetStats(void);
+
+#endif
@@ -0,0 +1,43 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Controls of the simulated PIC18 for tests and benchmarks
+ *
+ *******************************************************************/
+#ifndef HOST_PIC18_H
+#define HOST_PIC18_H
+
+/* Instruction cycle count back to 0, peripherals and interrupts off */
+void Host_Reset(void);
+
+/* Interrupt handler, run while GIE/PEIE and the source's IE are set */
+void Host_SetIsr(void (*isr)(void));
+
+/* Simulated time in instruction cycles (Fosc/4), no wrap */
+unsigned long long Host_Cycles(void);
+
+/* Instruction cycles per microsecond - Timer1 ticks only without a prescaler */
+#define HOST_CYCLES_US (FOSC / 4000000UL)
+
+/* Main line work - interrupts keep being served meanwhile */
+void Host_Advance(unsigned long us);
+
+/* UART line - bytes from the far end go out back to back at the
+ * configured rate, bytes the PIC sent are collected */
+void Host_UartSend(const unsigned char* data, unsigned int length);
+unsigned int Host_UartPending(void);
+unsigned int Host_UartReceived(unsigned char* data, unsigned int max);
+unsigned long Host_UartLost(void);     /* arrived with the FIFO full or OERR set */
+unsigned long Host_UartBaud(void);     /* rate set by the BRG registers */
+
+/* I2C bus - SCL rate from SSPADD, SMP as last configured, total time
+ * the MSSP had a bus phase running */
+unsigned long Host_I2cClock(void);
+unsigned char Host_I2cSlewOff(void);
+unsigned long long Host_I2cBusCycles(void);
+
+/* The next bus phase loses arbitration - BCLIF, MSSP back to idle */
+void Host_I2cCollide(void);
+
+#endif
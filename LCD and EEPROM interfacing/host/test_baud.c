@@ -0,0 +1,97 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, UART line
+ * SW: Serial_SetBaud across clocks and standard rates - nearest
+ *     divider, error in 0.01% against an independent calculation,
+ *     tolerance decisions, registers untouched on a reject
+ *
+ *******************************************************************/
+
+#include "serial.h"
+#include "host_pic18.h"
+#include "host_test.h"
+
+static const unsigned long clocks[] = { 4000000UL, 8000000UL, 10000000UL,
+                                        20000000UL, 40000000UL };
+static const unsigned long rates[] = { 50, 75, 110, 300, 1200, 2400, 4800,
+                                       9600, 19200, 38400, 57600, 115200,
+                                       230400, 250000, 460800, 700000,
+                                       921600, 1000000 };
+
+
+int main(void)
+{
+   unsigned long fosc, baud, brg, actual;
+   unsigned int c, r, accepted = 0;
+   long long expect;
+   unsigned char ok;
+   int error;
+
+   Host_Reset();
+
+   for(c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++)
+   {
+      fosc = clocks[c];
+      printf("Fosc %2lu MHz:", fosc / 1000000);
+
+      for(r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+      {
+         baud = rates[r];
+         error = 0x7FFF;
+         ok = Serial_SetBaud(fosc, baud, &error);
+
+         if(baud > fosc / 4)
+         {
+            CHECK(!ok);
+            continue;
+         }
+
+         /* Nearest divider and the error it leaves, in 64 bits */
+         brg = (unsigned long)((double)fosc / (4.0 * baud) + 0.5);
+         if(brg == 0) brg = 1;
+         if(brg > SERIAL_BRG_MAX + 1)
+         {
+            CHECK(!ok);
+            continue;
+         }
+         actual = fosc / (4 * brg);
+         expect = ((long long)actual - (long long)baud) * 10000 / (long long)baud;
+
+         /* Exact while the product fits, within 1% of it past that */
+         if(expect < 20000 && expect > -20000) CHECK_EQ(error, expect);
+         else CHECK(error > expect - expect / 100 - 1 && error < expect + expect / 100 + 1);
+
+         CHECK_EQ(ok, expect <= SERIAL_BAUD_TOLERANCE && expect >= -SERIAL_BAUD_TOLERANCE);
+         if(ok)
+         {
+            accepted++;
+            CHECK_EQ(Serial_GetBaud(), actual);
+            printf(" %lu", baud);
+         }
+      }
+      printf("\n");
+   }
+   CHECK(accepted > 40);
+
+   /* The line runs at what was accepted at the build's Fosc */
+   CHECK(Serial_SetBaud(FOSC, 19200, &error));
+   CHECK_EQ(error, 15);
+   CHECK_EQ(Host_UartBaud(), 19230);
+
+   /* Rejects leave the USART as it was */
+   CHECK(!Serial_SetBaud(FOSC, 115200, &error));
+   CHECK_EQ(error, -354);
+   CHECK(!Serial_SetBaud(FOSC, 700000, &error));
+   CHECK(error > 4200 && error < 4300);
+   CHECK(!Serial_SetBaud(FOSC, 0, &error));
+   CHECK_EQ(Host_UartBaud(), 19230);
+   CHECK_EQ(Serial_GetBaud(), 19230);
+
+   /* Slow rates need the whole 16-bit divider, not a division by 0 */
+   CHECK(Serial_SetBaud(FOSC, 50, &error));
+   CHECK_EQ(error, 0);
+   CHECK_EQ(Host_UartBaud(), 50);
+
+   return TEST_DONE();
+}
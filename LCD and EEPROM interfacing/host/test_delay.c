@@ -0,0 +1,99 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Timer1 waits - no shorter and not much longer than asked,
+ *     timeouts across the 16-bit wrap. Built at 4MHz, and at 16MHz
+ *     where Timer1 runs behind its 1:4 prescaler
+ *
+ *******************************************************************/
+
+#include "delay.h"
+#include "lcd.h"
+#include "i2c_async.h"
+#include "host_pic18.h"
+#include "host_test.h"
+
+/* A wait may overrun by the timer reads around it, and behind a
+ * prescaler by up to two ticks of rounding */
+#define SLACK (3 + 2 * (TIMER_PRESCALE - 1))
+
+static unsigned long long since(unsigned long long t0)
+{
+   return Host_Cycles() - t0;
+}
+
+
+int main(void)
+{
+   static const unsigned int waits[] = { 1, 2, 10, 40, 100, 1520, 65000 };
+   unsigned long long t0, t;
+   unsigned int i, start;
+
+   printf("FOSC %lu, Timer1 1:%d, %lu ticks/us, timeouts up to %lu us\n",
+          FOSC, TIMER_PRESCALE, TIMER_TICKS_US, TIMEOUT_MAX_US);
+   CHECK(TIMEOUT_MAX_US >= 65000);
+
+   Host_Reset();
+   HAL_TimerInit();
+
+   for(i = 0; i < sizeof(waits) / sizeof(waits[0]); i++)
+   {
+      t0 = Host_Cycles();
+      delay_us(waits[i]);
+      t = since(t0);
+      CHECK(t >= waits[i] * HOST_CYCLES_US);
+      CHECK(t <= waits[i] * HOST_CYCLES_US + SLACK);
+
+      /* Again from every phase of a prescaled tick */
+      Host_Advance(1);
+   }
+
+   /* Longer than one Timer1 turn */
+   t0 = Host_Cycles();
+   delay_ms(150);
+   t = since(t0);
+   CHECK(t >= 150000UL * HOST_CYCLES_US);
+   CHECK(t <= 150000UL * HOST_CYCLES_US + 150 * SLACK);
+
+   /* Timeout fires on the microsecond, or the tick after behind a
+      prescaler, not before */
+   start = Timeout_Start();
+   Host_Advance(4990);
+   CHECK(!Timeout_Expired(start, 5000));
+   Host_Advance(10 + (TIMER_PRESCALE > 1));
+   CHECK(Timeout_Expired(start, 5000));
+
+   /* Same with the stamp just short of Timer1 wrapping */
+   Host_Advance((0x10000 - HAL_TimerRead()) / TIMER_TICKS_US - 200);
+   start = Timeout_Start();
+   CHECK(start > 0xFF00);
+   Host_Advance(400);
+   CHECK(HAL_TimerRead() < 0x100);
+   CHECK(!Timeout_Expired(start, 1000));
+   Host_Advance(600 + (TIMER_PRESCALE > 1));
+   CHECK(Timeout_Expired(start, 1000));
+   CHECK(!Timeout_Expired(start, 1100));
+
+   /* The longest limits the drivers use still fit */
+   start = Timeout_Start();
+   Host_Advance(I2C_POLL_LIMIT_US - 10);
+   CHECK(!Timeout_Expired(start, I2C_POLL_LIMIT_US));
+   Host_Advance(20);
+   CHECK(Timeout_Expired(start, I2C_POLL_LIMIT_US));
+   start = Timeout_Start();
+   Host_Advance(LCD_REFRESH_US - 10);
+   CHECK(!Timeout_Expired(start, LCD_REFRESH_US));
+   Host_Advance(20);
+   CHECK(Timeout_Expired(start, LCD_REFRESH_US));
+
+   /* delay_us straddling the wrap */
+   Host_Advance((0x10000 - HAL_TimerRead()) / TIMER_TICKS_US - 50);
+   t0 = Host_Cycles();
+   delay_us(500);
+   t = since(t0);
+   CHECK(t >= 500 * HOST_CYCLES_US);
+   CHECK(t <= 500 * HOST_CYCLES_US + SLACK);
+
+   return TEST_DONE();
+}
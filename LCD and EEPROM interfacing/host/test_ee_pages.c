@@ -0,0 +1,128 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, 24LC256 model
+ * SW: Page-buffered writer - runs split at page boundaries, one
+ *     write cycle per page touched, never a wrap inside the latch
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "eeprom.h"
+#include "i2c_async.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+static unsigned char data[EE_SIZE];
+
+
+static void start(void)
+{
+   Host_Reset();
+   EEModel_Reset();
+   EEModel_Attach(EE_CONTROL);
+   Host_SetIsr(I2C_Isr);
+   HAL_TimerInit();
+   I2C_SetSpeed(FOSC, EE_MAX_HZ);
+   I2C_Init();
+}
+
+static EEModel_Stats* stats(void)
+{
+   return EEModel_GetStats(EE_CONTROL);
+}
+
+static unsigned int write_run(unsigned int addr, unsigned int length)
+{
+   unsigned long long t0 = Host_Cycles();
+   unsigned int i;
+
+   EEModel_ResetStats();
+   for(i = 0; i < length; i++) EE_Write(addr + i, data[(addr + i) & (EE_SIZE - 1)]);
+   EE_Flush();
+
+   return (unsigned int)((Host_Cycles() - t0) / 1000);
+}
+
+
+int main(void)
+{
+   unsigned char* memory;
+   unsigned int i, page_ms, byte_ms;
+   unsigned long cycles;
+   unsigned long long t0;
+
+   for(i = 0; i < EE_SIZE; i++) data[i] = (unsigned char)(i * 13 + (i >> 8));
+
+   /* 200 bytes from offset 10 - pages 0..3, 54 + 64 + 64 + 18 bytes */
+   start();
+   memory = EEModel_Memory(EE_CONTROL);
+   page_ms = write_run(10, 200);
+   cycles = stats()->write_cycles;
+   CHECK_EQ(cycles, 4);
+   CHECK_EQ(stats()->bytes_written, 200);
+   CHECK_EQ(stats()->page_wraps, 0);
+   CHECK(memcmp(memory + 10, data + 10, 200) == 0);
+   CHECK_EQ(memory[9], 0xFF);
+   CHECK_EQ(memory[210], 0xFF);
+
+   /* Same bytes one write cycle each */
+   start();
+   memory = EEModel_Memory(EE_CONTROL);
+   EEModel_ResetStats();
+   t0 = Host_Cycles();
+   for(i = 10; i < 210; i++) HDByteWriteI2C(EE_CONTROL, i >> 8, i & 0xFF, data[i]);
+   byte_ms = (unsigned int)((Host_Cycles() - t0) / 1000);
+   CHECK_EQ(stats()->write_cycles, 200);
+   CHECK(memcmp(memory + 10, data + 10, 200) == 0);
+
+   printf("200 bytes from offset 10: %lu write cycles in %u ms, byte writes %u ms\n",
+          cycles, page_ms, byte_ms);
+   CHECK(page_ms * 20 < byte_ms);
+
+   /* Page aligned run - whole pages commit as they fill, no flush needed */
+   start();
+   memory = EEModel_Memory(EE_CONTROL);
+   EEModel_ResetStats();
+   for(i = 0; i < 4 * EE_PAGE_SIZE; i++) EE_Write(0x1000 + i, data[0x1000 + i]);
+   CHECK_EQ(stats()->write_cycles, 4);
+   EE_Flush();
+   CHECK_EQ(stats()->write_cycles, 4);
+   CHECK(memcmp(memory + 0x1000, data + 0x1000, 4 * EE_PAGE_SIZE) == 0);
+
+   /* A jump commits what was gathered */
+   EEModel_ResetStats();
+   EE_Write(0x2000, 1);
+   EE_Write(0x2001, 2);
+   EE_Write(0x2005, 3);
+   CHECK_EQ(stats()->write_cycles, 1);
+   EE_Flush();
+   CHECK_EQ(stats()->write_cycles, 2);
+   CHECK_EQ(memory[0x2001], 2);
+   CHECK_EQ(memory[0x2002], 0xFF);
+   CHECK_EQ(memory[0x2005], 3);
+
+   /* Off the top of the array and on at 0 */
+   write_run(EE_SIZE - 20, 40);
+   CHECK_EQ(stats()->write_cycles, 2);
+   CHECK_EQ(stats()->page_wraps, 0);
+   CHECK(memcmp(memory + EE_SIZE - 20, data + EE_SIZE - 20, 20) == 0);
+   CHECK(memcmp(memory, data, 20) == 0);
+
+   /* Every alignment and length up to three pages */
+   start();
+   memory = EEModel_Memory(EE_CONTROL);
+   for(i = 0; i < 3 * EE_PAGE_SIZE; i += 7)
+   {
+      unsigned int addr = 0x4000 + i * 5, length = 1 + i;
+      unsigned int pages = ((addr + length - 1) / EE_PAGE_SIZE) - (addr / EE_PAGE_SIZE) + 1;
+
+      write_run(addr, length);
+      CHECK_EQ(stats()->write_cycles, pages);
+      CHECK_EQ(stats()->page_wraps, 0);
+      CHECK(memcmp(memory + addr, data + addr, length) == 0);
+   }
+
+   return TEST_DONE();
+}
@@ -0,0 +1,153 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, eight 24LC256 models
+ * SW: Multi-chip array - pages striped over the chips, the whole
+ *     256KB round tripped in mixed lengths, range checks, write
+ *     cycles of different chips overlapping, a chip that is not fitted
+ *
+ *******************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "eearray.h"
+#include "i2c_async.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+#define CHIP(n) (EE_CONTROL | ((n) << 1))
+
+static unsigned char image[EEARRAY_SIZE];
+static unsigned char got[EEARRAY_SIZE];
+
+
+/* All chips fitted but missing, 0xFF for none */
+static void start(unsigned char missing)
+{
+   unsigned char c;
+
+   Host_Reset();
+   EEModel_Reset();
+   for(c = 0; c < EEARRAY_CHIPS; c++) if(c != missing) EEModel_Attach(CHIP(c));
+   Host_SetIsr(I2C_Isr);
+   HAL_TimerInit();
+   I2C_SetSpeed(FOSC, EE_MAX_HZ);
+   I2C_Init();
+}
+
+/* Where linear address a lives */
+static unsigned char stored(unsigned long a)
+{
+   unsigned long page = a / EE_PAGE_SIZE;
+
+   return EEModel_Memory(CHIP(page % EEARRAY_CHIPS))
+          [(page / EEARRAY_CHIPS) * EE_PAGE_SIZE + a % EE_PAGE_SIZE];
+}
+
+
+int main(void)
+{
+   unsigned long addr, a, cycles;
+   unsigned long long t0, bus;
+   unsigned int length;
+   double ms, bus_ms;
+   unsigned char c, ok;
+
+   srand(24);
+   for(a = 0; a < EEARRAY_SIZE; a++) image[a] = (unsigned char)rand();
+
+   /* No EEArray_Init - the static slots are free from the start */
+   start(0xFF);
+   CHECK(EEArray_Write(100, image + 100, 10));
+   CHECK(EEArray_Sync());
+   CHECK_EQ(stored(100), image[100]);
+
+   /* Whole array in mixed lengths, page aligned or not */
+   EEArray_Init();
+   EEModel_ResetStats();
+   bus = Host_I2cBusCycles();
+   t0 = Host_Cycles();
+   for(addr = 0; addr < EEARRAY_SIZE; addr += length)
+   {
+      length = 1 + rand() % 300;
+      if(length > EEARRAY_SIZE - addr) length = (unsigned int)(EEARRAY_SIZE - addr);
+      CHECK(EEArray_Write(addr, image + addr, length));
+   }
+   CHECK(EEArray_Sync());
+   ms = (Host_Cycles() - t0) / (1000.0 * HOST_CYCLES_US);
+   bus_ms = (Host_I2cBusCycles() - bus) / (1000.0 * HOST_CYCLES_US);
+
+   for(a = 0, ok = 1; a < EEARRAY_SIZE; a++) if(stored(a) != image[a]) ok = 0;
+   CHECK(ok);
+
+   cycles = 0;
+   for(c = 0; c < EEARRAY_CHIPS; c++)
+   {
+      CHECK_EQ(EEModel_GetStats(CHIP(c))->page_wraps, 0);
+      CHECK_EQ(EEModel_GetStats(CHIP(c))->bytes_written, EE_SIZE);
+      cycles += EEModel_GetStats(CHIP(c))->write_cycles;
+   }
+   printf("%lu bytes over %u chips: %lu write cycles in %.0f ms (bus busy %.0f ms), "
+          "%.0f ms of write cycles alone if they ran in turn\n",
+          EEARRAY_SIZE, EEARRAY_CHIPS, cycles, ms, bus_ms, cycles * I2C_WRITE_CYCLE_US / 1000.0);
+
+   /* Write cycles hide behind other chips' transfers - what is left is
+      mostly bus time */
+   CHECK(ms < 0.7 * cycles * I2C_WRITE_CYCLE_US / 1000.0);
+   CHECK(bus_ms > 0.5 * ms);
+
+   /* Back in mixed lengths */
+   memset(got, 0, sizeof(got));
+   for(addr = 0; addr < EEARRAY_SIZE; addr += length)
+   {
+      length = 1 + rand() % 1000;
+      if(length > EEARRAY_SIZE - addr) length = (unsigned int)(EEARRAY_SIZE - addr);
+      CHECK(EEArray_Read(addr, got + addr, length));
+   }
+   CHECK(memcmp(got, image, EEARRAY_SIZE) == 0);
+
+   /* A read right after a write sees it */
+   image[5000] ^= 0xFF;
+   CHECK(EEArray_Write(4990, image + 4990, 20));
+   CHECK(EEArray_Read(4995, got, 10));
+   CHECK(memcmp(got, image + 4995, 10) == 0);
+
+   /* Range ends */
+   CHECK(EEArray_Read(EEARRAY_SIZE - 3, got, 3));
+   CHECK(memcmp(got, image + EEARRAY_SIZE - 3, 3) == 0);
+   CHECK(EEArray_Read(EEARRAY_SIZE, got, 0));
+   CHECK(!EEArray_Read(EEARRAY_SIZE - 3, got, 4));
+   CHECK(!EEArray_Write(EEARRAY_SIZE + 1, got, 0));
+   CHECK(!EEArray_Write(0xFFFFFFF0UL, got, 32));
+
+   /* Chip 5 not fitted - linear pages 5, 13, 21 ... go nowhere */
+   start(5);
+   EEArray_Init();
+   CHECK(EEArray_Write(0, image, 4 * EE_PAGE_SIZE));
+   CHECK(EEArray_Sync());
+   CHECK(EEArray_Write(4 * EE_PAGE_SIZE, image + 4 * EE_PAGE_SIZE, 4 * EE_PAGE_SIZE));
+   CHECK(!EEArray_Sync());
+   CHECK_EQ(stored(6 * EE_PAGE_SIZE), image[6 * EE_PAGE_SIZE]);
+
+   /* Reported once, then the next sync is clean again */
+   CHECK(EEArray_Sync());
+
+   /* The write failure shows at the sync, not in a read between */
+   CHECK(EEArray_Write(5 * EE_PAGE_SIZE + 10, image, 5));
+   CHECK(EEArray_Read(0, got, 4 * EE_PAGE_SIZE));
+   CHECK(memcmp(got, image, 4 * EE_PAGE_SIZE) == 0);
+   CHECK(!EEArray_Sync());
+
+   /* A read over the missing chip fails, the rest still arrives */
+   memset(got, 0, sizeof(got));
+   CHECK(!EEArray_Read(4 * EE_PAGE_SIZE, got, 3 * EE_PAGE_SIZE));
+   CHECK(memcmp(got, image + 4 * EE_PAGE_SIZE, EE_PAGE_SIZE) == 0);
+   CHECK(memcmp(got + 2 * EE_PAGE_SIZE, image + 6 * EE_PAGE_SIZE, EE_PAGE_SIZE) == 0);
+   CHECK(!EEArray_Sync());
+   CHECK(EEArray_Read(6 * EE_PAGE_SIZE, got, EE_PAGE_SIZE));
+   CHECK(EEArray_Sync());
+
+   return TEST_DONE();
+}
@@ -0,0 +1,222 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, 24LC256 model
+ * SW: Circular EEPROM log - wear spread over every page, recovery
+ *     after a restart at any point of a lap, the head search over
+ *     prepared images including the sequence number wrap
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "eelog.h"
+#include "i2c_async.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+#define LAP ((unsigned long)EELOG_PAGES * EELOG_DATA)
+
+static unsigned char before[2048], after[2048];
+
+
+/* PIC restart - the clock runs on, so the chip's write cycle in
+   progress, if any, ends when it would have */
+static void power_up(void)
+{
+   Host_SetIsr(I2C_Isr);
+   HAL_TimerInit();
+   I2C_SetSpeed(FOSC, EE_MAX_HZ);
+   I2C_Init();
+}
+
+/* What the log writes as byte n */
+static unsigned char logged(unsigned long n)
+{
+   return (unsigned char)(n * 7 + (n >> 9));
+}
+
+/* Append from byte n on, committing every 16 like the app */
+static unsigned long append(unsigned long n, unsigned long count)
+{
+   while(count--)
+   {
+      EELog_Append(logged(n));
+      n++;
+      if(n % 16 == 0) EELog_Flush();
+   }
+   return n;
+}
+
+/* The last count bytes end at byte n */
+static int holds_up_to(unsigned long n, unsigned int count)
+{
+   unsigned int got, i;
+
+   got = EELog_ReadLast(after, count);
+   if(got != count) return 0;
+   for(i = 0; i < count; i++)
+      if(after[i] != logged(n - count + i)) return 0;
+
+   return 1;
+}
+
+/* Commit and restart - the log must come back with the same tail */
+static int restart(unsigned int count)
+{
+   unsigned int got;
+
+   EELog_Flush();
+   while(I2C_Busy()) I2C_Poll();
+   got = EELog_ReadLast(before, count);
+
+   power_up();
+   EELog_Init();
+   return EELog_ReadLast(after, count) == got && memcmp(before, after, got) == 0;
+}
+
+/* Device image with the head at page head, fill bytes in it, lap sequence
+   numbers from s0 and the previous lap behind the head if full */
+static void prepare(unsigned char* memory, unsigned int head, unsigned char fill,
+                    unsigned int s0, unsigned char full)
+{
+   unsigned int p, s, i;
+   unsigned char len, *page;
+
+   memset(memory, 0xFF, EE_SIZE);
+   for(p = 0; p < EELOG_PAGES; p++)
+   {
+      if(p <= head) s = s0 + p;
+      else if(full) s = s0 + p - EELOG_PAGES;
+      else break;
+
+      s &= 0xFFFF;
+      len = (p == head) ? fill : EELOG_DATA;
+      page = memory + p * EE_PAGE_SIZE;
+      page[0] = s >> 8;
+      page[1] = s & 0xFF;
+      page[2] = len;
+      for(i = 0; i < len; i++) page[EELOG_HEADER + i] = (unsigned char)(s * 3 + i);
+   }
+}
+
+
+int main(void)
+{
+   static const unsigned int heads[] = { 0, 1, 2, 100, 255, 256, 257, 400, 510, 511 };
+   static const unsigned int seqs[] = { 0, 1000, 0xFF00, 0xFFFF - 200, 0xFFFF };
+   unsigned long n, min, max;
+   unsigned char* memory;
+   EEModel_Stats* stats;
+   unsigned int h, q, p, s, i;
+   unsigned char full, ok;
+
+   EEModel_Reset();
+   EEModel_Attach(EE_CONTROL);
+   memory = EEModel_Memory(EE_CONTROL);
+   stats = EEModel_GetStats(EE_CONTROL);
+
+   /* Blank device */
+   Host_Reset();
+   power_up();
+   EELog_Init();
+   CHECK_EQ(EELog_ReadLast(after, 16), 0);
+
+   /* Partial first page, short read moves to the front */
+   n = append(0, 40);
+   CHECK(restart(40));
+   CHECK(holds_up_to(40, 40));
+   CHECK_EQ(EELog_ReadLast(after, 100), 40);
+   CHECK_EQ(after[0], logged(0));
+
+   /* Restarts all through two and a half laps, off page boundaries
+      and on them - the tail always comes back */
+   ok = 1;
+   for(i = 0; n < 5 * LAP / 2; i++)
+   {
+      n = append(n, 997 + (i % 3) * EELOG_DATA);
+      if(i % 4 == 0) n = append(n, EELOG_DATA - (n % EELOG_DATA));
+      if(!restart(1500) || !holds_up_to(n, n < 1500 ? n : 1500)) ok = 0;
+   }
+   CHECK(ok);
+
+   /* Bytes appended but never flushed are the only loss */
+   n = append(n, 5);
+   EELog_Flush();
+   while(I2C_Busy()) I2C_Poll();
+   EELog_Append(0xAA);
+   EELog_Append(0xBB);
+   power_up();
+   EELog_Init();
+   CHECK(holds_up_to(n, 100));
+
+   /* A full page's write lost to a bus collision goes out again before
+      the next page does - the sequence has no gap and the head search
+      still finds the tail */
+   n = append(n, EELOG_DATA - 1 - n % EELOG_DATA);
+   EELog_Flush();
+   while(I2C_Busy()) I2C_Poll();
+   Host_I2cCollide();
+   n = append(n, 1);
+   n = append(n, EELOG_DATA + 10);
+   CHECK(restart(200));
+   CHECK(holds_up_to(n, 200));
+
+   /* Wear - every page took its share of write cycles */
+   min = max = stats->page_cycles[0];
+   for(p = 1; p < EELOG_PAGES; p++)
+   {
+      if(stats->page_cycles[p] < min) min = stats->page_cycles[p];
+      if(stats->page_cycles[p] > max) max = stats->page_cycles[p];
+   }
+   printf("%lu bytes in %lu write cycles, per page %lu..%lu - "
+          "1M cycle pages last %.0f MB of log at this flush rate\n",
+          n, stats->write_cycles, min, max, 1e6 / max * (double)n / 1e6);
+   CHECK(min > 0);
+   CHECK(max <= min + 2 * ((EELOG_DATA + 15) / 16));
+   CHECK_EQ(stats->page_wraps, 0);
+
+   /* Head search - every head position tried reads a handful of
+      headers, whatever the sequence numbers */
+   for(q = 0; q < sizeof(seqs) / sizeof(seqs[0]); q++)
+   {
+      for(h = 0; h < sizeof(heads) / sizeof(heads[0]); h++)
+      {
+         for(full = 0; full < 2; full++)
+         {
+            prepare(memory, heads[h], 20, seqs[q], full);
+            power_up();
+            EEModel_ResetStats();
+            EELog_Init();
+            CHECK(stats->bytes_read <= 16 * EELOG_HEADER + EE_PAGE_SIZE);
+
+            /* Newest bytes are the head page's */
+            s = (seqs[q] + heads[h]) & 0xFFFF;
+            CHECK_EQ(EELog_ReadLast(after, 20), 20);
+            for(i = 0, ok = 1; i < 20; i++)
+               if(after[i] != (unsigned char)(s * 3 + i)) ok = 0;
+            CHECK(ok);
+
+            /* Older pages follow back across the lap */
+            if(full || heads[h] > 0)
+            {
+               s = (s - 1) & 0xFFFF;
+               CHECK_EQ(EELog_ReadLast(after, 20 + EELOG_DATA), 20 + EELOG_DATA);
+               CHECK_EQ(after[0], (unsigned char)(s * 3));
+            }
+            CHECK_EQ(EELog_ReadLast(before, 2048),
+                     (full ? EELOG_PAGES - 1 : heads[h]) * EELOG_DATA + 20 > 2048 ? 2048 :
+                     (full ? EELOG_PAGES - 1 : heads[h]) * EELOG_DATA + 20);
+
+            /* Appends carry on in the head page */
+            EELog_Append(0x5A);
+            EELog_Flush();
+            while(I2C_Busy()) I2C_Poll();
+            CHECK_EQ(memory[heads[h] * EE_PAGE_SIZE + 2], 21);
+            CHECK_EQ(memory[heads[h] * EE_PAGE_SIZE + EELOG_HEADER + 20], 0x5A);
+         }
+      }
+   }
+
+   return TEST_DONE();
+}
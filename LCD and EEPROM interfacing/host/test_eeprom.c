@@ -0,0 +1,38 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, 24LC256 model
+ * SW: EEPROM smoke test - byte write, sequential read back
+ *
+ *******************************************************************/
+
+#include "eeprom.h"
+#include "i2c_async.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+int main(void)
+{
+   unsigned char data[4];
+
+   Host_Reset();
+   EEModel_Reset();
+   EEModel_Attach(EE_CONTROL);
+   Host_SetIsr(I2C_Isr);
+
+   HAL_TimerInit();
+   CHECK_EQ(I2C_SetSpeed(FOSC, EE_MAX_HZ), 250000);
+   I2C_Init();
+
+   HDByteWriteI2C(EE_CONTROL, 0x12, 0x34, 0x5A);
+   CHECK_EQ(EEModel_Memory(EE_CONTROL)[0x1234], 0x5A);
+   CHECK_EQ(EEModel_GetStats(EE_CONTROL)->write_cycles, 1);
+
+   EE_Read(0x1233, data, 3);
+   CHECK_EQ(data[0], 0xFF);
+   CHECK_EQ(data[1], 0x5A);
+   CHECK_EQ(data[2], 0xFF);
+
+   return TEST_DONE();
+}
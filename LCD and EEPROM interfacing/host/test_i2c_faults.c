@@ -0,0 +1,171 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, 24LC256 model
+ * SW: I2C faults - a missing chip, a write cycle that overruns the
+ *     poll limit, bus collisions. Every wait ends, the engine carries
+ *     on with the next request.
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "eeprom.h"
+#include "i2c_async.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+#define MISSING (EE_CONTROL | 0x02)
+
+static unsigned char frame[2 + 8], got[8];
+
+
+static void start(void)
+{
+   Host_Reset();
+   EEModel_Reset();
+   EEModel_Attach(EE_CONTROL);
+   Host_SetIsr(I2C_Isr);
+   HAL_TimerInit();
+   I2C_SetSpeed(FOSC, EE_MAX_HZ);
+   I2C_Init();
+}
+
+/* Page write of 8 bytes at addr, polled for the device */
+static void page_write(I2C_Request* req, unsigned char control, unsigned int addr, unsigned char fill)
+{
+   frame[0] = addr >> 8;
+   frame[1] = addr & 0xFF;
+   memset(frame + 2, fill, 8);
+
+   req->control = control;
+   req->write = frame;
+   req->write_len = sizeof(frame);
+   req->read_len = 0;
+   req->flags = I2C_POLL | I2C_WCYCLE;
+   CHECK(I2C_Submit(req));
+}
+
+static unsigned long wait_us(I2C_Request* req)
+{
+   unsigned long long t0 = Host_Cycles();
+
+   while(req->status == I2C_PENDING) I2C_Poll();
+   return (unsigned long)((Host_Cycles() - t0) / HOST_CYCLES_US);
+}
+
+
+int main(void)
+{
+   I2C_Request a, b;
+   unsigned long us;
+   unsigned char* memory;
+
+   /* Nobody at the address - polled for the limit, then NACK, and the
+      request queued behind it still runs */
+   start();
+   memory = EEModel_Memory(EE_CONTROL);
+   page_write(&a, MISSING, 0x0100, 0x11);
+   page_write(&b, EE_CONTROL, 0x0200, 0x22);
+   us = wait_us(&a);
+   printf("missing chip given up after %lu us\n", us);
+   CHECK_EQ(a.status, I2C_NACK);
+   CHECK(us >= I2C_POLL_LIMIT_US);
+   CHECK(us < I2C_POLL_LIMIT_US + 1000);
+   wait_us(&b);
+   CHECK_EQ(b.status, I2C_OK);
+   CHECK_EQ(memory[0x0200], 0x22);
+   CHECK(!I2C_Busy());
+
+   /* A slow write cycle inside the limit is just polled through */
+   EEModel_SetWriteCycle(12000);
+   page_write(&a, EE_CONTROL, 0x0300, 0x33);
+   wait_us(&a);
+   page_write(&b, EE_CONTROL, 0x0308, 0x44);
+   wait_us(&b);
+   CHECK_EQ(a.status, I2C_OK);
+   CHECK_EQ(b.status, I2C_OK);
+   CHECK_EQ(memory[0x030F], 0x44);
+
+   /* One that outlasts it fails the request, not the engine */
+   EEModel_SetWriteCycle(30000);
+   page_write(&a, EE_CONTROL, 0x0400, 0x55);
+   wait_us(&a);
+   page_write(&b, EE_CONTROL, 0x0408, 0x66);
+   wait_us(&b);
+   CHECK_EQ(a.status, I2C_OK);
+   CHECK_EQ(b.status, I2C_NACK);
+   CHECK_EQ(memory[0x0408], 0xFF);
+   Host_Advance(30000);
+   page_write(&b, EE_CONTROL, 0x0408, 0x66);
+   wait_us(&b);
+   CHECK_EQ(b.status, I2C_OK);
+   CHECK_EQ(memory[0x0408], 0x66);
+   EEModel_SetWriteCycle(5000);
+
+   /* Bus lost mid-frame - the write is dropped with its status, the
+      next request goes ahead */
+   start();
+   memory = EEModel_Memory(EE_CONTROL);
+   page_write(&a, EE_CONTROL, 0x0500, 0x77);
+   Host_Advance(100);
+   Host_I2cCollide();
+   page_write(&b, EE_CONTROL, 0x0600, 0x88);
+   wait_us(&a);
+   wait_us(&b);
+   CHECK_EQ(a.status, I2C_COLLISION);
+   CHECK_EQ(memory[0x0500], 0xFF);
+   CHECK_EQ(EEModel_GetStats(EE_CONTROL)->write_cycles, 1);
+   CHECK_EQ(b.status, I2C_OK);
+   CHECK_EQ(memory[0x0600], 0x88);
+   CHECK(!I2C_Busy());
+
+   /* Collision on the START of an idle engine */
+   Host_I2cCollide();
+   page_write(&a, EE_CONTROL, 0x0700, 0x99);
+   wait_us(&a);
+   CHECK_EQ(a.status, I2C_COLLISION);
+   page_write(&a, EE_CONTROL, 0x0700, 0x99);
+   wait_us(&a);
+   CHECK_EQ(a.status, I2C_OK);
+
+   /* Blocking routines - bounded as well */
+   start();
+   memory = EEModel_Memory(EE_CONTROL);
+   memory[0x0800] = 0xA5;
+   EEModel_SetWriteCycle(30000);
+   CHECK_EQ(HDByteWriteI2C(EE_CONTROL, 0x09, 0x00, 0x5A), (unsigned char)-1);
+   CHECK_EQ(memory[0x0900], 0x5A);
+
+   us = (unsigned long)Host_Cycles();
+   EE_Read(0x0800, got, 4);
+   us = (unsigned long)(Host_Cycles() - us) / HOST_CYCLES_US;
+   printf("EE_Read behind an overlong write cycle gave up after %lu us\n", us);
+   CHECK(us < 2 * I2C_POLL_LIMIT_US);
+   CHECK_EQ(got[0], 0xFF);
+
+   Host_Advance(30000);
+   EE_Read(0x0800, got, 4);
+   CHECK_EQ(got[0], 0xA5);
+
+   us = (unsigned long)Host_Cycles();
+   CHECK(HDByteWriteI2C(MISSING, 0x00, 0x00, 0x01) != 0);
+   EE_Read(0x0800, got, 1);
+   us = (unsigned long)(Host_Cycles() - us) / HOST_CYCLES_US;
+   CHECK(us < 2 * I2C_POLL_LIMIT_US);
+   CHECK(EE_WaitReady(EE_CONTROL));
+   CHECK(!EE_WaitReady(MISSING));
+
+   /* One address attempt per poll, each closed with a STOP - a write
+      cycle shows up as a run of NACKed ones, and the chip still
+      answers afterwards */
+   EEModel_SetWriteCycle(5000);
+   EEModel_ResetStats();
+   CHECK_EQ(HDByteWriteI2C(EE_CONTROL, 0x00, 0x10, 0x5A), 0);
+   CHECK(EEModel_GetStats(EE_CONTROL)->busy_nacks > 1);
+   EE_Read(0x0010, got, 1);
+   CHECK_EQ(got[0], 0x5A);
+
+   return TEST_DONE();
+}
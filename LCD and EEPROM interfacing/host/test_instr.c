@@ -0,0 +1,167 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, HD44780, 24LC256 and UART models
+ * SW: Latency histograms built in (INSTR_ENABLE) - bucketing, 16-bit
+ *     saturation, dump text over the UART, LCD and EEPROM paths
+ *     counted on the simulated clock
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include "instr.h"
+#include "lcd.h"
+#include "eeprom.h"
+#include "serial.h"
+#include "i2c_async.h"
+#include "host_pic18.h"
+#include "eeprom_model.h"
+#include "host_test.h"
+
+#ifndef INSTR_ENABLE
+#error "build with -DINSTR_ENABLE"
+#endif
+
+static char report[1024];
+static unsigned int length;
+
+static void out(char c)
+{
+   if(length < sizeof(report) - 1) report[length++] = c;
+   report[length] = 0;
+}
+
+static void dump(void)
+{
+   length = 0;
+   report[0] = 0;
+   Instr_Dump(out);
+}
+
+/* As the apps send it */
+static void uart_out(char c)
+{
+   while(!HAL_UartTxReady());
+   HAL_UartWrite(c);
+}
+
+/* Line of the dump for one operation id */
+static const char* line(unsigned char id)
+{
+   const char* p = report;
+
+   while(p && *p)
+   {
+      if(strtoul(p, 0, 10) == id) return p;
+      p = strchr(p, '\n');
+      if(p) p++;
+   }
+
+   return 0;
+}
+
+/* Count in one bucket, or in all of them with bucket -1 */
+static unsigned long count(unsigned char id, int bucket)
+{
+   const char* p = line(id);
+   unsigned long total = 0, n;
+   char* end;
+   long b;
+
+   if(!p) return 0;
+   p = strchr(strchr(p, ' ') + 1, ' ');
+
+   while(p && *p == ' ')
+   {
+      b = strtol(p + 1, &end, 10);
+      if(*end != ':') break;
+      n = strtoul(end + 1, &end, 10);
+      if(bucket < 0 || b == bucket) total += n;
+      p = end;
+   }
+
+   return total;
+}
+
+static unsigned long worst(unsigned char id)
+{
+   const char* p = line(id);
+
+   return p ? strtoul(strchr(p, ' ') + 1, 0, 10) : 0;
+}
+
+
+int main(void)
+{
+   unsigned char data[64], sent[sizeof(report)];
+   unsigned long i;
+   unsigned char row, col;
+
+   /* Bucket edges - 0 and 1 share bucket 0, 65535 is the last */
+   Instr_Reset();
+   Instr_Record(INSTR_LCD_BUSY, 0);
+   Instr_Record(INSTR_LCD_BUSY, 1);
+   Instr_Record(INSTR_LCD_BUSY, 2);
+   Instr_Record(INSTR_LCD_BUSY, 3);
+   Instr_Record(INSTR_LCD_BUSY, 4);
+   Instr_Record(INSTR_EE_READ, 65535);
+   dump();
+   CHECK(strcmp(report,
+                "0 4 0:2 1:2 2:1\r\n"
+                "1 0\r\n"
+                "2 0\r\n"
+                "3 65535 15:1\r\n") == 0);
+
+   /* Counters stop at 65535 instead of wrapping to 0 */
+   for(i = 0; i < 70000; i++) Instr_Record(INSTR_EE_ACK_POLL, 8);
+   dump();
+   CHECK(strstr(report, "1 8 3:65535\r\n") != 0);
+
+   /* Same text over the UART, as the apps dump on Ctrl-T */
+   Host_Reset();
+   HAL_TimerInit();
+   CHECK(Serial_SetBaud(FOSC, 19200, 0));
+   Instr_Dump(uart_out);
+   Host_Advance(20000);
+   CHECK_EQ(Host_UartReceived(sent, sizeof(sent)), length);
+   CHECK(memcmp(sent, report, length) == 0);
+
+   /* LCD - every busy wait of init and a full screen */
+   HAL_LcdPower(0);
+   Host_Reset();
+   HAL_TimerInit();
+   Instr_Reset();
+   init_lcd();
+   for(row = 0; row < LCD_ROWS; row++)
+      for(col = 0; col < LCD_COLS; col++) put_at_lcd(row, col, 'A' + col);
+   flush_lcd();
+   while(poll_lcd()) Host_Advance(50);
+
+   /* EEPROM - 4 page writes, 3 reads */
+   EEModel_Reset();
+   EEModel_Attach(EE_CONTROL);
+   Host_SetIsr(I2C_Isr);
+   I2C_SetSpeed(FOSC, EE_MAX_HZ);
+   I2C_Init();
+   for(i = 0; i < 4 * EE_PAGE_SIZE; i++) EE_Write(i, (unsigned char)i);
+   EE_Flush();
+   for(i = 0; i < 3; i++) EE_Read(i * 64, data, sizeof(data));
+   CHECK_EQ(data[63], 191);
+
+   dump();
+   printf("%s", report);
+
+   /* The clear takes 1.52ms, bucket 10 - no busy wait runs past 2048us */
+   CHECK(count(INSTR_LCD_BUSY, -1) > 0);
+   CHECK(worst(INSTR_LCD_BUSY) < 2048);
+   CHECK_EQ(count(INSTR_LCD_BUSY, 10), 1);
+
+   CHECK_EQ(count(INSTR_EE_WRITE, -1), 4);
+   CHECK_EQ(count(INSTR_EE_ACK_POLL, -1), 4);
+   CHECK(worst(INSTR_EE_ACK_POLL) < I2C_POLL_LIMIT_US);
+   CHECK_EQ(count(INSTR_EE_READ, -1), 3);
+   CHECK(worst(INSTR_EE_READ) < worst(INSTR_EE_WRITE));
+
+   return TEST_DONE();
+}
@@ -0,0 +1,45 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, HD44780 model
+ * SW: LCD driver smoke test - init and text on the glass
+ *
+ *******************************************************************/
+
+#include "lcd.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "hd44780_model.h"
+#include "host_test.h"
+
+static void show(unsigned char row, const char* text)
+{
+   unsigned char col;
+
+   for(col = 0; text[col]; col++) put_at_lcd(row, col, text[col]);
+}
+
+int main(void)
+{
+   Host_Reset();
+   HAL_TimerInit();
+
+   init_lcd();
+   CHECK(HD44780_FourBit());
+   CHECK_EQ(HD44780_Lines(), 2);
+   CHECK_EQ(hd44780_stats.violations, 0);
+
+   show(0, "HELLO");
+   show(1, "WORLD");
+   flush_lcd();
+   while(poll_lcd());
+
+   CHECK_EQ(HD44780_Cell(0, 0, 2, 16), 'H');
+   CHECK_EQ(HD44780_Cell(0, 4, 2, 16), 'O');
+   CHECK_EQ(HD44780_Cell(1, 0, 2, 16), 'W');
+   CHECK_EQ(HD44780_Cell(1, 4, 2, 16), 'D');
+   CHECK_EQ(HD44780_Cell(1, 5, 2, 16), ' ');
+   CHECK_EQ(hd44780_stats.violations, 0);
+
+   return TEST_DONE();
+}
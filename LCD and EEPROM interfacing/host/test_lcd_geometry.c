@@ -0,0 +1,107 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, HD44780 model
+ * SW: LCD driver at the panel size it was built for - function set,
+ *     every cell at its DDRAM address, teletype wrap, range checks.
+ *     Built once per geometry with -DLCD_COLS/-DLCD_ROWS.
+ *
+ *******************************************************************/
+
+#include "lcd.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "hd44780_model.h"
+#include "host_test.h"
+
+#define CELLS (LCD_ROWS * LCD_COLS)
+
+/* Distinct printable character per cell and pass */
+static unsigned char glyph(unsigned int cell, unsigned char pass)
+{
+   return (unsigned char)(0x21 + (cell * 7 + pass * 13) % 94);
+}
+
+static int shows(unsigned char pass)
+{
+   unsigned char row, col;
+
+   for(row = 0; row < LCD_ROWS; row++)
+      for(col = 0; col < LCD_COLS; col++)
+         if(HD44780_Cell(row, col, LCD_ROWS, LCD_COLS) != glyph(row * LCD_COLS + col, pass)) return 0;
+
+   return 1;
+}
+
+static void drain(void)
+{
+   do
+   {
+      update_lcd();
+      Host_Advance(1000);
+   }
+   while(poll_lcd());
+}
+
+
+int main(void)
+{
+   unsigned char row, col;
+   unsigned int cell;
+
+   printf("%ux%u panel\n", LCD_COLS, LCD_ROWS);
+
+   Host_Reset();
+   HAL_TimerInit();
+   init_lcd();
+   CHECK(HD44780_FourBit());
+   CHECK_EQ(HD44780_Lines(), (LCD_ROWS == 1) ? 1 : 2);
+
+   /* Every cell by position - one address set per row at most */
+   HD44780_ResetStats();
+   for(row = 0; row < LCD_ROWS; row++)
+      for(col = 0; col < LCD_COLS; col++) put_at_lcd(row, col, glyph(row * LCD_COLS + col, 0));
+   flush_lcd();
+   drain();
+   CHECK(shows(0));
+   CHECK_EQ(hd44780_stats.data_writes, CELLS);
+   CHECK(hd44780_stats.address_sets <= LCD_ROWS);
+
+   /* Teletype fills row by row and wraps to the top left */
+   for(cell = 0; cell < CELLS; cell++) put_char_lcd(glyph(cell, 1));
+   flush_lcd();
+   drain();
+   CHECK(shows(1));
+   put_char_lcd('#');
+   flush_lcd();
+   drain();
+   CHECK_EQ(HD44780_Cell(0, 0, LCD_ROWS, LCD_COLS), '#');
+   CHECK_EQ(HD44780_Cell(0, LCD_COLS > 1 ? 1 : 0, LCD_ROWS, LCD_COLS), LCD_COLS > 1 ? glyph(1, 1) : '#');
+
+   /* Off the panel - ignored, nothing on the bus */
+   HD44780_ResetStats();
+   put_at_lcd(LCD_ROWS, 0, '!');
+   put_at_lcd(0, LCD_COLS, '!');
+   put_at_lcd(255, 255, '!');
+   flush_lcd();
+   CHECK(!poll_lcd());
+   CHECK_EQ(hd44780_stats.data_writes, 0);
+
+   /* Last cell of each row, first of the next - the DDRAM jumps */
+   HD44780_ResetStats();
+   for(row = 0; row < LCD_ROWS; row++)
+   {
+      put_at_lcd(row, LCD_COLS - 1, 'L');
+      put_at_lcd(row, 0, 'F');
+   }
+   flush_lcd();
+   drain();
+   for(row = 0; row < LCD_ROWS; row++)
+   {
+      CHECK_EQ(HD44780_Cell(row, LCD_COLS - 1, LCD_ROWS, LCD_COLS), LCD_COLS > 1 ? 'L' : 'F');
+      CHECK_EQ(HD44780_Cell(row, 0, LCD_ROWS, LCD_COLS), 'F');
+   }
+   CHECK_EQ(hd44780_stats.violations, 0);
+
+   return TEST_DONE();
+}
@@ -0,0 +1,114 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, HD44780 model, UART line
+ * SW: Input lost to LCD waits - a polled USART loop showing a
+ *     scrolling text, once draining each refresh on the spot and once
+ *     clocking it out one byte per pass through poll_lcd
+ *
+ *******************************************************************/
+
+#include "lcd.h"
+#include "serial.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "hd44780_model.h"
+#include "host_test.h"
+
+#define BAUD  19200
+#define TOTAL 2000
+
+#define LCD_CELLS (LCD_ROWS * LCD_COLS)
+
+static unsigned char input[TOTAL];
+static unsigned char history[LCD_CELLS];
+
+
+/* The panel shows the last LCD_CELLS characters, oldest first */
+static void scroll(unsigned char c)
+{
+   unsigned char i;
+
+   for(i = 0; i < LCD_CELLS - 1; i++) history[i] = history[i + 1];
+   history[LCD_CELLS - 1] = c;
+
+   for(i = 0; i < LCD_CELLS; i++) put_at_lcd(i / LCD_COLS, i % LCD_COLS, history[i]);
+}
+
+/* Receive everything, returns the bytes that made it in */
+static unsigned int run(unsigned char blocking, unsigned long* worst_us)
+{
+   unsigned long long t0;
+   unsigned int got = 0, i;
+
+   HAL_LcdPower(0);
+   Host_Reset();
+   HAL_TimerInit();
+   init_lcd();
+   CHECK(Serial_SetBaud(FOSC, BAUD, 0));
+   for(i = 0; i < LCD_CELLS; i++) history[i] = ' ';
+
+   *worst_us = 0;
+   Host_UartSend(input, TOTAL);
+
+   while(Host_UartPending() || HAL_UartRxReady())
+   {
+      if(HAL_UartOverrun()) HAL_UartClearOverrun();
+
+      if(HAL_UartRxReady())
+      {
+         scroll(HAL_UartRead());
+         got++;
+      }
+
+      /* The refresh tick, then the LCD's share of the pass */
+      t0 = Host_Cycles();
+      update_lcd();
+      if(blocking) while(poll_lcd());
+      else poll_lcd();
+      t0 = (Host_Cycles() - t0) / HOST_CYCLES_US;
+      if(t0 > *worst_us) *worst_us = (unsigned long)t0;
+   }
+
+   /* Settle - a refresh larger than the queue takes two ticks - and
+      compare the panel with what arrived last */
+   for(i = 0; i < 2; i++)
+   {
+      Host_Advance(LCD_REFRESH_US);
+      update_lcd();
+      while(poll_lcd());
+   }
+   for(i = 0; i < LCD_CELLS; i++)
+      CHECK_EQ(HD44780_Cell(i / LCD_COLS, i % LCD_COLS, LCD_ROWS, LCD_COLS), history[i]);
+   CHECK_EQ(hd44780_stats.violations, 0);
+
+   return got;
+}
+
+
+int main(void)
+{
+   unsigned long blocking_us, polled_us;
+   unsigned int blocking_got, polled_got, i;
+
+   for(i = 0; i < TOTAL; i++) input[i] = 'A' + i % 26;
+
+   blocking_got = run(1, &blocking_us);
+   CHECK_EQ(blocking_got + Host_UartLost(), TOTAL);
+
+   polled_got = run(0, &polled_us);
+   CHECK_EQ(polled_got + Host_UartLost(), TOTAL);
+
+   printf("%u bytes at %u baud: drained refresh kept %u (longest pass %lu us), "
+          "polled queue kept %u (longest pass %lu us)\n",
+          TOTAL, BAUD, blocking_got, blocking_us, polled_got, polled_us);
+
+   /* A full panel refresh outlasts the 2 byte FIFO and the shift
+      register - the queue never holds the loop that long */
+   CHECK(blocking_got < TOTAL);
+   CHECK(blocking_us * BAUD > 3 * 10 * 1000000UL);
+   CHECK_EQ(polled_got, TOTAL);
+   CHECK(polled_us * BAUD < 10 * 1000000UL);
+
+   return TEST_DONE();
+}
@@ -0,0 +1,139 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, HD44780 model
+ * SW: Bus transactions of the dirty-cell refresh against redrawing
+ *     the whole panel - a status screen with a running clock
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include "lcd.h"
+#include "delay.h"
+#include "host_pic18.h"
+#include "hd44780_model.h"
+#include "host_test.h"
+
+#define SECONDS 600
+
+static char text[LCD_ROWS][40];
+
+
+/* Screen for second s - fixed labels, a clock, a value that changes
+   every 10 seconds */
+static void screen(unsigned int s)
+{
+   snprintf(text[0], sizeof(text[0]), "TEMP %2u.%uC  OK  ", 20 + (s / 10) % 5, (s / 10) % 10);
+   snprintf(text[1], sizeof(text[1]), "UP %02u:%02u:%02u     ", s / 3600, (s / 60) % 60, s % 60);
+}
+
+static unsigned long bytes(void)
+{
+   return hd44780_stats.instructions + hd44780_stats.data_writes;
+}
+
+static int on_glass(void)
+{
+   unsigned char row, col;
+
+   for(row = 0; row < LCD_ROWS; row++)
+      for(col = 0; col < LCD_COLS; col++)
+         if(HD44780_Cell(row, col, LCD_ROWS, LCD_COLS) != (unsigned char)text[row][col]) return 0;
+
+   return 1;
+}
+
+/* Power cycle the panel along with the clock going back to 0 */
+static void start(void)
+{
+   HAL_LcdPower(0);
+   Host_Reset();
+   HAL_TimerInit();
+   init_lcd();
+   HD44780_ResetStats();
+}
+
+
+int main(void)
+{
+   unsigned long shadow_bytes, full_bytes, before;
+   unsigned long long t0, shadow_cycles, full_cycles;
+   unsigned int s;
+   unsigned char row, col;
+
+   /* Framebuffer - only what changed goes out */
+   start();
+   t0 = Host_Cycles();
+   for(s = 0; s < SECONDS; s++)
+   {
+      screen(s);
+      for(row = 0; row < LCD_ROWS; row++)
+         for(col = 0; col < LCD_COLS; col++) put_at_lcd(row, col, text[row][col]);
+      flush_lcd();
+      while(poll_lcd());
+   }
+   shadow_bytes = bytes();
+   shadow_cycles = Host_Cycles() - t0;
+   CHECK(on_glass());
+   CHECK_EQ(hd44780_stats.violations, 0);
+
+   /* Same screens redrawn in full - a row address and every cell */
+   start();
+   t0 = Host_Cycles();
+   for(s = 0; s < SECONDS; s++)
+   {
+      screen(s);
+      for(row = 0; row < LCD_ROWS; row++)
+      {
+         send_to_lcd(0x80 | (row ? 0x40 : 0x00), 1);
+         wait_busy_lcd();
+         for(col = 0; col < LCD_COLS; col++)
+         {
+            send_to_lcd(text[row][col], 0);
+            wait_busy_lcd();
+         }
+      }
+   }
+   full_bytes = bytes();
+   full_cycles = Host_Cycles() - t0;
+   CHECK(on_glass());
+   CHECK_EQ(full_bytes, SECONDS * (unsigned long)LCD_ROWS * (LCD_COLS + 1));
+
+   printf("%u screens: full redraw %lu bytes %.1f ms, dirty cells %lu bytes %.1f ms (%.1f%%)\n",
+          SECONDS, full_bytes, full_cycles / 1000.0, shadow_bytes, shadow_cycles / 1000.0,
+          100.0 * shadow_bytes / full_bytes);
+
+   /* A clock ticking is mostly one or two cells */
+   CHECK(shadow_bytes * 8 < full_bytes);
+   CHECK(shadow_cycles * 4 < full_cycles);
+
+   /* Nothing changed - nothing on the bus */
+   start();
+   screen(0);
+   for(row = 0; row < LCD_ROWS; row++)
+      for(col = 0; col < LCD_COLS; col++) put_at_lcd(row, col, text[row][col]);
+   flush_lcd();
+   while(poll_lcd());
+   before = bytes();
+   for(row = 0; row < LCD_ROWS; row++)
+      for(col = 0; col < LCD_COLS; col++) put_at_lcd(row, col, text[row][col]);
+   flush_lcd();
+   CHECK(!poll_lcd());
+   CHECK_EQ(bytes(), before);
+
+   /* A run of changed cells takes one address set, a second run
+      elsewhere one more */
+   HD44780_ResetStats();
+   put_at_lcd(0, 5, 'X');
+   put_at_lcd(0, 6, 'Y');
+   put_at_lcd(0, 7, 'Z');
+   put_at_lcd(1, 10, '!');
+   flush_lcd();
+   while(poll_lcd());
+   CHECK_EQ(hd44780_stats.data_writes, 4);
+   CHECK_EQ(hd44780_stats.address_sets, 2);
+   CHECK_EQ(HD44780_Cell(0, 6, LCD_ROWS, LCD_COLS), 'Y');
+   CHECK_EQ(HD44780_Cell(1, 10, LCD_ROWS, LCD_COLS), '!');
+
+   return TEST_DONE();
+}
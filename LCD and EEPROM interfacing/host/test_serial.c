@@ -0,0 +1,189 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, UART line
+ * SW: Serial ring buffers under load - bursts of back to back input
+ *     echoed by a main loop that stalls, nothing lost or reordered
+ *     while the stalls fit the RX ring, losses counted in the ring
+ *     (never in the FIFO) once they don't. Then the UART echo app
+ *     itself, ISR ring and LCD queue, against the HD44780 model at
+ *     its line rate
+ *
+ *******************************************************************/
+
+#include <setjmp.h>
+#include <string.h>
+#include "serial.h"
+#include "delay.h"
+#include "lcd.h"
+#include "host_pic18.h"
+#include "hd44780_model.h"
+#include "host_test.h"
+
+#define BAUD     57600
+#define TOTAL    4000
+#define BURST    64
+
+/* 16x2_lcd_plus_uart.c, main renamed and Serial_Read routed through
+ * app_read. The far end starts sending once
+ * it is up, and one pass of its loop costs APP_PASS_US. */
+#define APP_BAUD    19200
+#define APP_BOOT_US 100000UL
+#define APP_PASS_US 20
+#define LCD_CELLS   (LCD_ROWS * LCD_COLS)
+
+void uart_app_main(void);
+void high_isr(void);
+unsigned char app_read(unsigned char* c);
+
+static unsigned char out[TOTAL];
+static unsigned char back[TOTAL + 64];
+static jmp_buf app_exit;
+static unsigned long long app_stop;
+
+
+/* The far end sends bursts of BURST bytes back to back, one every
+ * 2 * BURST frames. The main loop echoes whatever arrived and sits in
+ * "other work" for stall_us after every 16 bytes. */
+static unsigned int echo(unsigned long frame_us, unsigned long stall_us)
+{
+   unsigned long long next_burst = 0;
+   unsigned int sent = 0, echoed = 0, since = 0, n;
+   unsigned char c;
+
+   while(sent < TOTAL || Host_UartPending() || Serial_RxCount())
+   {
+      if(sent < TOTAL && Host_Cycles() >= next_burst)
+      {
+         n = (TOTAL - sent < BURST) ? TOTAL - sent : BURST;
+         Host_UartSend(out + sent, n);
+         sent += n;
+         next_burst = Host_Cycles() + 2ULL * BURST * frame_us * HOST_CYCLES_US;
+      }
+
+      if(Serial_Read(&c))
+      {
+         while(!Serial_Write(c)) Host_Advance(10);
+         echoed++;
+         if(++since == 16)
+         {
+            Host_Advance(stall_us);
+            since = 0;
+         }
+      }
+      else
+      {
+         Host_Advance(20);
+      }
+   }
+
+   /* Let the TX ring run dry */
+   Host_Advance(SERIAL_TX_SIZE * frame_us * 2);
+   return echoed;
+}
+
+/* The app's Serial_Read - once it is up, the far end sends TOTAL bytes
+ * back to back; once they and a few refreshes are through, leave */
+unsigned char app_read(unsigned char* c)
+{
+   unsigned long frame_us = 10 * 1000000UL / APP_BAUD;
+
+   Host_Advance(APP_PASS_US);
+
+   if(!app_stop && Host_Cycles() >= APP_BOOT_US * HOST_CYCLES_US)
+   {
+      /* init_serial is through, the BRG within 1% of the line rate */
+      CHECK(Host_UartBaud() > APP_BAUD * 99 / 100 && Host_UartBaud() < APP_BAUD * 101 / 100);
+      Host_UartSend(out, TOTAL);
+      app_stop = Host_Cycles() + (TOTAL + SERIAL_TX_SIZE) * frame_us * HOST_CYCLES_US +
+                 3ULL * LCD_REFRESH_US * HOST_CYCLES_US;
+   }
+   if(app_stop && Host_Cycles() >= app_stop) longjmp(app_exit, 1);
+
+   return Serial_Read(c);
+}
+
+static void start(void)
+{
+   Host_Reset();
+   Host_SetIsr(Serial_Isr);
+   HAL_TimerInit();
+   CHECK(Serial_SetBaud(FOSC, BAUD, 0));
+   Serial_Init();
+   serial_rx_overruns = serial_hw_overruns = 0;
+}
+
+
+int main(void)
+{
+   unsigned long frame_us;
+   unsigned int i, n, echoed;
+
+   for(i = 0; i < TOTAL; i++) out[i] = (unsigned char)(i * 7 + (i >> 8));
+   frame_us = 10 * 1000000UL / BAUD;
+
+   /* Stalls of 3/4 of what the RX ring holds - every byte comes back,
+      in order */
+   start();
+   echoed = echo(frame_us, frame_us * SERIAL_RX_SIZE * 3 / 4);
+   n = Host_UartReceived(back, sizeof(back));
+   printf("%u bytes at %lu baud, stalls of %lu us: echoed %u\n",
+          TOTAL, Serial_GetBaud(), frame_us * SERIAL_RX_SIZE * 3 / 4, n);
+   CHECK_EQ(echoed, TOTAL);
+   CHECK_EQ(n, TOTAL);
+   CHECK(memcmp(out, back, TOTAL) == 0);
+   CHECK_EQ(serial_rx_overruns, 0);
+   CHECK_EQ(serial_hw_overruns, 0);
+   CHECK_EQ(Host_UartLost(), 0);
+
+   /* Stalls of twice the ring - the ISR still empties the FIFO, so
+      every dropped byte shows up as an RX ring overrun */
+   start();
+   echoed = echo(frame_us, frame_us * SERIAL_RX_SIZE * 2);
+   n = Host_UartReceived(back, sizeof(back));
+   printf("stalls of %lu us: echoed %u, ring overruns %u\n",
+          frame_us * SERIAL_RX_SIZE * 2, n, serial_rx_overruns);
+   CHECK(serial_rx_overruns > 0);
+   CHECK_EQ(echoed + serial_rx_overruns, TOTAL);
+   CHECK_EQ(n, echoed);
+   CHECK_EQ(serial_hw_overruns, 0);
+   CHECK_EQ(Host_UartLost(), 0);
+
+   /* What did get through is still in order */
+   for(i = 0, echoed = 0; i < TOTAL && echoed < n; i++)
+   {
+      if(out[i] == back[echoed]) echoed++;
+   }
+   CHECK_EQ(echoed, n);
+
+   /* A full TX ring refuses, and drains back to accepting */
+   start();
+   for(i = 0; Serial_Write('x'); i++);
+   CHECK(i >= SERIAL_TX_SIZE);
+   Host_Advance(frame_us * 2);
+   CHECK(Serial_Write('y'));
+
+   /* The echo app at its line rate - every byte echoed and on the
+      panel, which ends up showing the last LCD_CELLS of them where
+      put_char_lcd's teletype wrap put them */
+   HAL_LcdPower(0);
+   Host_Reset();
+   Host_SetIsr(high_isr);
+   serial_rx_overruns = serial_hw_overruns = 0;
+   if(!setjmp(app_exit)) uart_app_main();
+
+   n = Host_UartReceived(back, sizeof(back));
+   printf("echo app: %u bytes at %u baud, echoed %u\n", TOTAL, APP_BAUD, n);
+   CHECK_EQ(n, TOTAL);
+   CHECK(memcmp(out, back, TOTAL) == 0);
+   CHECK_EQ(serial_rx_overruns, 0);
+   CHECK_EQ(serial_hw_overruns, 0);
+   CHECK_EQ(Host_UartLost(), 0);
+
+   for(i = TOTAL - LCD_CELLS; i < TOTAL; i++)
+      CHECK_EQ(HD44780_Cell((i % LCD_CELLS) / LCD_COLS, (i % LCD_CELLS) % LCD_COLS,
+                            LCD_ROWS, LCD_COLS), out[i]);
+   CHECK_EQ(hd44780_stats.violations, 0);
+
+   return TEST_DONE();
+}
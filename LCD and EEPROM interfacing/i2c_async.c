@@ -0,0 +1,354 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Interrupt driven I2C master transactions
+ *
+ * Every bus phase (start, address/data byte, receive, ACK, stop) is
+ * started from I2C_Isr() and its completion raises SSPIF, which runs
+ * the next phase. The CPU only spends the ISR time per byte instead
+ * of spinning through the whole transaction. Callers queue a request
+ * and watch its status. I2C_Isr() has to be called from the high
+ * priority interrupt handler.
+ *
+ * A device that was just written is left alone for its whole write
+ * cycle instead of being hammered with ACK polls: requests flagged
+ * I2C_WCYCLE stamp the device on completion, and requests to a device
+ * still inside its cycle are held back while work for other devices
+ * goes ahead. Held requests start from I2C_Poll() once the cycle time
+ * is up, so call it from the main loop (and from wait loops).
+ *
+ * Address polling gives up after I2C_POLL_LIMIT_US with I2C_NACK, so
+ * a missing chip can't hold the queue. A bus collision drops the
+ * active request with I2C_COLLISION and the engine carries on with
+ * the next one.
+ *
+ * The blocking HD*I2C routines must not run while requests are in
+ * flight - wait for !I2C_Busy() first.
+ *
+ *******************************************************************/
+
+#include "i2c_async.h"
+#include "delay.h"
+
+#if I2C_POLL_LIMIT_US > TIMEOUT_MAX_US
+#error "I2C_POLL_LIMIT_US is longer than Timer1 can time at this FOSC"
+#endif
+
+/* Transaction state machine - named after the phase in progress */
+#define I2C_IDLE     0
+#define I2C_START    1
+#define I2C_ADDR_W   2
+#define I2C_WRITE    3
+#define I2C_RESTART  4
+#define I2C_ADDR_R   5
+#define I2C_READ     6
+#define I2C_ACK      7
+#define I2C_STOP     8
+
+static I2C_Request* queue[I2C_DEPTH];
+static volatile unsigned char head, tail;
+
+static I2C_Request* volatile active;
+static volatile unsigned char state = I2C_IDLE;
+static unsigned char pos, result;
+
+/* Address polling of the active request - set and stamped on its first NACK */
+static unsigned char polling;
+static unsigned int poll_start;
+
+/* Write cycle start per device (A2..A0), bit set while one may be running */
+static unsigned int cycle_start[8];
+static volatile unsigned char cycle_busy;
+
+#define DEVICE(control) (((control) >> 1) & 0x07)
+
+
+/* Device past its write cycle ? */
+unsigned char I2C_Ready(unsigned char control)
+{
+   unsigned char dev = DEVICE(control);
+
+   if(!(cycle_busy & (1 << dev))) return 1;
+
+   return Timeout_Expired(cycle_start[dev], I2C_WRITE_CYCLE_US);
+}
+
+
+/* Start the oldest request whose device is ready, ISR context or
+ * interrupts masked. Stays idle if every queued device is busy. */
+static void start_next(void)
+{
+   unsigned char i, j;
+
+   active = 0;
+   state = I2C_IDLE;
+
+   for(i = tail; i != head; i++)
+   {
+      if(!I2C_Ready(queue[i & (I2C_DEPTH - 1)]->control)) continue;
+
+      active = queue[i & (I2C_DEPTH - 1)];
+      cycle_busy &= ~(1 << DEVICE(active->control));
+      polling = 0;
+
+      /* Close the gap - skipped requests keep their order */
+      for(j = i; j != tail; j--)
+      {
+         queue[j & (I2C_DEPTH - 1)] = queue[(j - 1) & (I2C_DEPTH - 1)];
+      }
+      tail++;
+
+      state = I2C_START;
+      HAL_I2cSendStart();
+      return;
+   }
+}
+
+/* End the transaction with a STOP, status is posted when it completes */
+static void stop(unsigned char status)
+{
+   result = status;
+   state = I2C_STOP;
+   HAL_I2cSendStop();
+}
+
+/* Read phase, or STOP if there is none */
+static void begin_read(void)
+{
+   if(active->read_len == 0)
+   {
+      stop(I2C_OK);
+   }
+   else if(active->write_len == 0)
+   {
+      /* Nothing written - already right after START */
+      state = I2C_ADDR_R;
+      HAL_I2cPut(active->control | 0x01);
+   }
+   else
+   {
+      state = I2C_RESTART;
+      HAL_I2cSendRestart();
+   }
+}
+
+
+/* Configure the MSSP as master at the fastest clock not above hz.
+ * Slew rate control is only wanted in the 400kHz class - standard
+ * (100kHz) and 1MHz modes run with it off. Returns the bus clock
+ * achieved, 0 if even the slowest divider is too fast. */
+unsigned long I2C_SetSpeed(unsigned long fosc, unsigned long hz)
+{
+   unsigned long div, actual;
+
+   if(hz == 0) return 0;
+
+   /* Round the divider up so the bus never runs faster than asked */
+   div = (fosc + 4 * hz - 1) / (4 * hz);
+   if(div < I2C_SSPADD_MIN + 1) div = I2C_SSPADD_MIN + 1;
+   if(div > I2C_SSPADD_MAX + 1) return 0;
+
+   actual = fosc / (4 * div);
+
+   /* SMP = 1 disables slew rate control */
+   HAL_I2cConfig(div - 1, (actual > 100000UL && actual <= 400000UL) ? 0 : 1);
+
+   return actual;
+}
+
+void I2C_Init()
+{
+   head = tail = 0;
+   active = 0;
+   state = I2C_IDLE;
+   cycle_busy = 0;
+
+   HAL_I2cIntClear();
+   HAL_I2cCollisionClear();
+   HAL_I2cIntEnable(1);
+   HAL_I2cCollisionIntEnable(1);
+   HAL_IntEnable();
+}
+
+/* Queue a request - returns 0 if the queue is full */
+unsigned char I2C_Submit(I2C_Request* req)
+{
+   if((unsigned char)(head - tail) >= I2C_DEPTH) return 0;
+
+   req->status = I2C_PENDING;
+   queue[head & (I2C_DEPTH - 1)] = req;
+   head++;
+
+   /* Kick an idle engine with the ISR held off - a collision runs
+      start_next as well */
+   HAL_I2cIntEnable(0);
+   HAL_I2cCollisionIntEnable(0);
+   if(state == I2C_IDLE) start_next();
+   HAL_I2cCollisionIntEnable(1);
+   HAL_I2cIntEnable(1);
+
+   return 1;
+}
+
+unsigned char I2C_Busy()
+{
+   return (state != I2C_IDLE) || (head != tail);
+}
+
+/* Retire finished write cycles and start held requests whose device is
+ * ready. A stamp left standing would read as busy again once Timer1
+ * wraps onto it, so call this at least every 60ms. The ISR sets
+ * cycle_busy bits too - SSPIE and BCLIE are masked for the update. */
+void I2C_Poll()
+{
+   unsigned char dev;
+
+   HAL_I2cWait();
+   if(cycle_busy == 0 && (state != I2C_IDLE || head == tail)) return;
+
+   HAL_I2cIntEnable(0);
+   HAL_I2cCollisionIntEnable(0);
+   for(dev = 0; dev < 8; dev++)
+   {
+      if((cycle_busy & (1 << dev)) && Timeout_Expired(cycle_start[dev], I2C_WRITE_CYCLE_US))
+      {
+         cycle_busy &= ~(1 << dev);
+      }
+   }
+   if(state == I2C_IDLE) start_next();
+   HAL_I2cCollisionIntEnable(1);
+   HAL_I2cIntEnable(1);
+}
+
+/* SSP interrupt - one bus phase has completed */
+void I2C_Isr()
+{
+   /* Bus lost - the MSSP is idle again, drop the request in flight.
+      Collisions in the blocking routines are theirs to see. */
+   if(HAL_I2cCollision())
+   {
+      HAL_I2cCollisionClear();
+      if(active != 0)
+      {
+         active->status = I2C_COLLISION;
+         start_next();
+      }
+      return;
+   }
+
+   if(!HAL_I2cIntPending()) return;
+   HAL_I2cIntClear();
+
+   /* Blocking routines also raise SSPIF */
+   if(active == 0) return;
+
+   switch(state)
+   {
+   case I2C_START:
+      pos = 0;
+      if(active->write_len == 0)
+      {
+         begin_read();
+      }
+      else
+      {
+         state = I2C_ADDR_W;
+         HAL_I2cPut(active->control);
+      }
+      break;
+
+   case I2C_ADDR_W:
+   case I2C_ADDR_R:
+      /* Busy device (EEPROM write cycle) keeps NACKing its address -
+         polled for I2C_POLL_LIMIT_US from the first NACK, then given up */
+      if(!HAL_I2cAcked())
+      {
+         if(!(active->flags & I2C_POLL))
+         {
+            stop(I2C_NACK);
+         }
+         else if(!polling)
+         {
+            polling = 1;
+            poll_start = Timeout_Start();
+            stop(I2C_PENDING);
+         }
+         else
+         {
+            stop(Timeout_Expired(poll_start, I2C_POLL_LIMIT_US) ? I2C_NACK : I2C_PENDING);
+         }
+      }
+      else if(state == I2C_ADDR_R)
+      {
+         pos = 0;
+         state = I2C_READ;
+         HAL_I2cReceive();
+      }
+      else
+      {
+         state = I2C_WRITE;
+         HAL_I2cPut(active->write[pos++]);
+      }
+      break;
+
+   case I2C_WRITE:
+      if(!HAL_I2cAcked())
+      {
+         stop(I2C_NACK);
+      }
+      else if(pos < active->write_len)
+      {
+         HAL_I2cPut(active->write[pos++]);
+      }
+      else
+      {
+         begin_read();
+      }
+      break;
+
+   case I2C_RESTART:
+      state = I2C_ADDR_R;
+      HAL_I2cPut(active->control | 0x01);
+      break;
+
+   case I2C_READ:
+      active->read[pos++] = HAL_I2cGet();
+      /* ACK all but the last byte */
+      state = I2C_ACK;
+      HAL_I2cSendAck(pos == active->read_len);
+      break;
+
+   case I2C_ACK:
+      if(pos < active->read_len)
+      {
+         state = I2C_READ;
+         HAL_I2cReceive();
+      }
+      else
+      {
+         stop(I2C_OK);
+      }
+      break;
+
+   case I2C_STOP:
+      if(result == I2C_PENDING)
+      {
+         /* Polling a busy device - go again */
+         state = I2C_START;
+         HAL_I2cSendStart();
+      }
+      else
+      {
+         /* Device is programming from the STOP on */
+         if(result == I2C_OK && (active->flags & I2C_WCYCLE))
+         {
+            cycle_start[DEVICE(active->control)] = Timeout_Start();
+            cycle_busy |= 1 << DEVICE(active->control);
+         }
+         active->status = result;
+         start_next();
+      }
+      break;
+   }
+}
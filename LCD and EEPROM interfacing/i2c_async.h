@@ -0,0 +1,60 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Interrupt driven I2C master transactions
+ *
+ *******************************************************************/
+#ifndef I2C_ASYNC_H
+#define I2C_ASYNC_H
+
+#include "hal_pic18.h"
+
+/* Request status while queued or in flight - then I2C_OK, I2C_NACK
+ * or I2C_COLLISION (bus lost, the request was dropped). I2C_OK is 0,
+ * so a static request that was never submitted reads as done. */
+#define I2C_OK        0
+#define I2C_PENDING   1
+#define I2C_NACK      2
+#define I2C_COLLISION 3
+
+/* Request flags */
+#define I2C_POLL   0x01   /* address NACK means busy - retry up to I2C_POLL_LIMIT_US */
+#define I2C_WCYCLE 0x02   /* starts an internal write cycle on success */
+
+/* Longest EEPROM write cycle - 24LC256 tWC */
+#define I2C_WRITE_CYCLE_US 5000
+
+/* A device still NACKing after this long is missing or stuck */
+#define I2C_POLL_LIMIT_US (2 * I2C_WRITE_CYCLE_US)
+
+/* Master clock = Fosc / (4 * (SSPADD + 1)), SSPADD 0-2 not supported */
+#define I2C_SSPADD_MIN 3
+#define I2C_SSPADD_MAX 127
+
+/* Queue depth - must be a power of two */
+#define I2C_DEPTH 4
+
+/* One transaction: START, control + write bytes, then RESTART and read
+ * bytes if read_len is set, STOP. Either phase may be empty. */
+typedef struct I2C_Request
+{
+   unsigned char control;          /* device address, R/W bit clear */
+   unsigned char* write;
+   unsigned char write_len;
+   unsigned char* read;
+   unsigned char read_len;
+   unsigned char flags;
+   volatile unsigned char status;
+} I2C_Request;
+
+/* Prototypes */
+unsigned long I2C_SetSpeed(unsigned long fosc, unsigned long hz);
+void I2C_Init(void);
+void I2C_Isr(void);
+unsigned char I2C_Submit(I2C_Request* req);
+unsigned char I2C_Busy(void);
+void I2C_Poll(void);
+unsigned char I2C_Ready(unsigned char control);
+
+#endif
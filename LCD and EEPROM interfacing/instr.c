@@ -0,0 +1,86 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Latency histograms for the LCD and EEPROM hot paths
+ *
+ *******************************************************************/
+
+#include "instr.h"
+
+#ifdef INSTR_ENABLE
+
+/* Saturating 16-bit counters - 128 bytes of RAM */
+static unsigned short histogram[INSTR_COUNT][INSTR_BUCKETS];
+static instr_t worst[INSTR_COUNT];
+
+
+/* Count one sample - highest set bit picks the bucket */
+void Instr_Record(unsigned char id, instr_t ticks)
+{
+   unsigned char bucket = 0;
+
+   if(ticks > worst[id]) worst[id] = ticks;
+
+   while((ticks >>= 1) != 0) bucket++;
+
+   if(histogram[id][bucket] != 0xFFFF) histogram[id][bucket]++;
+}
+
+
+/* Clear all histograms */
+void Instr_Reset(void)
+{
+   unsigned char i, j;
+
+   for(i = 0; i < INSTR_COUNT; i++)
+   {
+      worst[i] = 0;
+      for(j = 0; j < INSTR_BUCKETS; j++) histogram[i][j] = 0;
+   }
+}
+
+
+static void put_number(void (*out)(char), unsigned int n)
+{
+   char digits[5];
+   unsigned char i = 0;
+
+   do
+   {
+      digits[i++] = '0' + (n % 10);
+      n /= 10;
+   } while(n != 0);
+
+   while(i > 0) out(digits[--i]);
+}
+
+
+/* Emit "<id> <max> <bucket>:<count> ..." per operation through out,
+ * e.g. a blocking UART write, empty buckets skipped */
+void Instr_Dump(void (*out)(char c))
+{
+   unsigned char i, j;
+
+   for(i = 0; i < INSTR_COUNT; i++)
+   {
+      put_number(out, i);
+      out(' ');
+      put_number(out, worst[i]);
+
+      for(j = 0; j < INSTR_BUCKETS; j++)
+      {
+         if(histogram[i][j] == 0) continue;
+
+         out(' ');
+         put_number(out, j);
+         out(':');
+         put_number(out, histogram[i][j]);
+      }
+
+      out('\r');
+      out('\n');
+   }
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Latency histograms for the LCD and EEPROM hot paths
+ *
+ *******************************************************************/
+#ifndef INSTR_H
+#define INSTR_H
+
+#include "hal_pic18.h"
+
+/* Uncomment, or build with -DINSTR_ENABLE, to build the instrumentation in -
+ * compiles out completely otherwise. Needs HAL_TimerInit() at start up */
+/* #define INSTR_ENABLE */
+
+/* Measured operations */
+#define INSTR_LCD_BUSY    0   /* wait_busy_lcd BF polling */
+#define INSTR_EE_ACK_POLL 1   /* EEAckPolling after a write */
+#define INSTR_EE_WRITE    2   /* whole HDByteWriteI2C/HDPageWriteI2C */
+#define INSTR_EE_READ     3   /* whole HDByteReadI2C/EE_Read */
+#define INSTR_COUNT       4
+
+/* Power of two buckets of Timer1 ticks (Fosc/4, 1us @ 4MHz):
+ * bucket n holds 2^n <= ticks < 2^(n+1) */
+#define INSTR_BUCKETS 16
+
+/* Byte on the UART that makes the apps dump - Ctrl-T */
+#define INSTR_DUMP_KEY 0x14
+
+#ifdef INSTR_ENABLE
+
+typedef unsigned int instr_t;
+
+/* Declare a start stamp among the other declarations - no ';' after
+ * it, the macro brings its own so it can vanish when disabled */
+#define INSTR_DECLARE(t)  instr_t t;
+#define INSTR_START(t)    t = HAL_TimerRead()
+#define INSTR_STOP(id, t) Instr_Record((id), (unsigned short)(HAL_TimerRead() - (t)))
+
+void Instr_Record(unsigned char id, instr_t ticks);
+void Instr_Reset(void);
+void Instr_Dump(void (*out)(char c));
+
+#else
+
+#define INSTR_DECLARE(t)
+#define INSTR_START(t)
+#define INSTR_STOP(id, t)
+#define Instr_Reset()
+#define Instr_Dump(out)
+
+#endif
+
+#endif
@@ -0,0 +1,281 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: HD44780 4-bit LCD driver with a shadow framebuffer
+ *
+ * frame[] holds what should be on the glass, shown[] what DDRAM will
+ * have once the queue drains. flush_lcd() only queues the cells that
+ * differ and sets the DDRAM address only when the auto-increment did
+ * not already land there.
+ *
+ * Nothing after init_lcd() waits on the controller: poll_lcd() checks
+ * BF once and clocks out the next queued byte if it is clear. It can be
+ * called from the main loop or a timer interrupt - the queue has one
+ * producer and one consumer with free running byte indices. Don't mix
+ * in direct send_to_lcd() calls while the queue is in use.
+ *
+ *******************************************************************/
+
+#include "lcd.h"
+#include "delay.h"
+#include "instr.h"
+
+#if LCD_REFRESH_US > TIMEOUT_MAX_US
+#error "LCD_REFRESH_US is longer than Timer1 can time at this FOSC"
+#endif
+
+#define LCD_CELLS (LCD_ROWS * LCD_COLS)
+
+/* DDRAM address of each row, fixed at compile time - 4 line panels
+   continue lines 0/1 in rows 2/3 */
+#if LCD_ROWS == 1
+static const unsigned char row_addr[LCD_ROWS] = { 0x00 };
+#elif LCD_ROWS == 2
+static const unsigned char row_addr[LCD_ROWS] = { 0x00, 0x40 };
+#else
+static const unsigned char row_addr[LCD_ROWS] = { 0x00, 0x40, LCD_COLS, 0x40 + LCD_COLS };
+#endif
+
+static unsigned char frame[LCD_CELLS];
+static unsigned char shown[LCD_CELLS];
+static unsigned char dirty;
+
+/* DDRAM address counter as last left by the driver */
+static unsigned char ddram;
+
+/* Teletype position for put_char_lcd - frame index, row major */
+static unsigned char position = 0;
+
+/* Refresh pacing */
+static unsigned int last_update;
+
+/* Queued bytes, RS in q_cmd - main loop writes q_head, poll_lcd q_tail */
+static unsigned char q_data[LCD_QUEUE_SIZE];
+static unsigned char q_cmd[LCD_QUEUE_SIZE];
+static volatile unsigned char q_head, q_tail;
+
+/* Initialize LCM HD44780 */
+void init_lcd()
+{
+   int command;
+   unsigned char i;
+   /* Configure PORTD to output */
+   HAL_LcdPortOut();
+  
+   /* Enable LCD */
+   HAL_LcdPower(1);
+
+   /* Wait for HD44780 to boot - 40ms after Vcc rises */
+   delay_ms(40);
+
+   /* Write 1 nibble - 4-bit interface */
+   HAL_LcdDataOut(); HAL_LcdRW(0); HAL_LcdRS(0);
+   HAL_LcdE(1);
+   command = HAL_LcdRead() & 0xF0; 
+   command |= 0x02;
+   HAL_LcdWrite(command); 
+   Nop(); 
+   HAL_LcdE(0); 
+   /* Busy flag not valid yet - command takes over 4.1ms */
+   delay_ms(5);
+
+   /* Function set - 4-bit interface, lines to match the panel */
+   command = LCD_FUNCTION;
+   send_to_lcd(command, 1);
+   wait_busy_lcd();
+
+   /* Display set */
+   command = 0x0D;
+   send_to_lcd(command, 1);
+   wait_busy_lcd();
+   
+   /* Entry mode set */
+   command = 0x06;
+   send_to_lcd(command, 1);
+   wait_busy_lcd();
+
+   /* Clear display */
+   command = 0x01;
+   send_to_lcd(command, 1);
+   wait_busy_lcd();
+
+   /* Clear leaves blanks and the address counter at 0 */
+   for(i = 0; i < LCD_CELLS; i++)
+   {
+      frame[i] = ' ';
+      shown[i] = ' ';
+   }
+   dirty = 0;
+   ddram = 0;
+   position = 0;
+   q_head = q_tail = 0;
+   last_update = Timeout_Start();
+}
+
+void send_to_lcd(int data, int command)
+{
+   int temp = 0;
+   /* Configure PORTD to output */
+   HAL_LcdDataOut();
+
+   /* Write */
+   HAL_LcdRW(0);
+    
+   /* Command or data register */
+   if(command == 1) 
+     HAL_LcdRS(0);
+   else
+     HAL_LcdRS(1);
+
+   /* Upper nibble */
+   HAL_LcdE(1);
+   temp = HAL_LcdRead() & 0xF0;
+   temp |= (0x0F & (data >> 4));
+   HAL_LcdWrite(temp);
+   Nop(); 
+   HAL_LcdE(0); 
+   
+   /* Enable cycle time - 1us minimum */
+   delay_us(1);
+   
+   /* Lower nibble */
+   HAL_LcdE(1);
+   temp = HAL_LcdRead() & 0xF0;
+   temp |= (0x0F & data);
+   HAL_LcdWrite(temp);
+   Nop(); HAL_LcdE(0);
+
+   delay_us(1);
+}
+
+void wait_busy_lcd()
+{
+   INSTR_DECLARE(t)
+
+   INSTR_START(t);
+   while(busy_lcd());
+   INSTR_STOP(INSTR_LCD_BUSY, t);
+}
+
+/* Single busy flag read */
+unsigned char busy_lcd()
+{
+   int busy = 0;
+
+   /* Make PORTD input */
+   HAL_LcdDataIn();
+
+   /* Read */
+   HAL_LcdRW(1);
+   HAL_LcdRS(0);
+   
+   /* High nibble first - BF is DB7 */
+   HAL_LcdE(1);
+   busy = HAL_LcdRead();
+   HAL_LcdE(0);
+
+   /* Low nibble (AC3-0) - clocked out to keep the nibble order */
+   HAL_LcdE(1);
+   Nop();
+   HAL_LcdE(0);
+
+   return (busy & 0x08) != 0;
+}
+
+/* Queue a command or data byte */
+unsigned char queue_lcd(unsigned char data, unsigned char command)
+{
+   if((unsigned char)(q_head - q_tail) >= LCD_QUEUE_SIZE) return 0;
+
+   q_data[q_head & (LCD_QUEUE_SIZE - 1)] = data;
+   q_cmd[q_head & (LCD_QUEUE_SIZE - 1)] = command;
+   q_head++;
+
+   return 1;
+}
+
+/* Send the next queued byte if the controller is ready */
+unsigned char poll_lcd()
+{
+   if(q_head == q_tail) return 0;
+
+   /* Still executing the last one - try again next time */
+   if(busy_lcd()) return 1;
+
+   send_to_lcd(q_data[q_tail & (LCD_QUEUE_SIZE - 1)],
+               q_cmd[q_tail & (LCD_QUEUE_SIZE - 1)]);
+   q_tail++;
+
+   return 1;
+}
+
+/* Place a character in the framebuffer */
+void put_at_lcd(unsigned char row, unsigned char col, unsigned char chr)
+{
+   unsigned char cell;
+
+   if(row >= LCD_ROWS || col >= LCD_COLS) return;
+
+   cell = row * LCD_COLS + col;
+   if(frame[cell] != chr)
+   {
+      frame[cell] = chr;
+      dirty = 1;
+   }
+}
+
+/* Teletype style - next cell, wrapping to the next row and back to the top */
+void put_char_lcd(unsigned char chr)
+{
+   if(frame[position] != chr)
+   {
+      frame[position] = chr;
+      dirty = 1;
+   }
+
+   position++;
+   if(position == LCD_CELLS) position = 0;
+}
+
+/* Periodic tick - refresh at most once per LCD_REFRESH_US */
+void update_lcd()
+{
+   if(!dirty) return;
+   if(!Timeout_Expired(last_update, LCD_REFRESH_US)) return;
+
+   last_update = Timeout_Start();
+   flush_lcd();
+}
+
+/* Queue the changed cells - what doesn't fit goes on the next tick */
+void flush_lcd()
+{
+   unsigned char row, col, cell, addr;
+
+   dirty = 0;
+   cell = 0;
+
+   for(row = 0; row < LCD_ROWS; row++)
+   {
+      for(col = 0; col < LCD_COLS; col++, cell++)
+      {
+         if(frame[cell] == shown[cell]) continue;
+
+         /* Room for an address set and the character ? */
+         if((unsigned char)(q_head - q_tail) > LCD_QUEUE_SIZE - 2)
+         {
+            dirty = 1;
+            return;
+         }
+
+         /* Skip the address set if auto-increment already points here */
+         addr = row_addr[row] + col;
+         if(addr != ddram) queue_lcd(0x80 | addr, 1);
+         queue_lcd(frame[cell], 0);
+
+         shown[cell] = frame[cell];
+         ddram = addr + 1;
+      }
+   }
+}
@@ -0,0 +1,56 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: HD44780 4-bit LCD driver with a shadow framebuffer
+ *
+ *******************************************************************/
+#ifndef LCD_H
+#define LCD_H
+
+#include "hal_pic18.h"
+
+/* Geometry - 8x1, 16x2, 20x4 or 40x2, e.g. -DLCD_COLS=20 -DLCD_ROWS=4 */
+#ifndef LCD_COLS
+#define LCD_COLS 16
+#endif
+#ifndef LCD_ROWS
+#define LCD_ROWS 2
+#endif
+
+#if LCD_ROWS < 1 || LCD_ROWS > 4 || LCD_ROWS == 3 || LCD_COLS < 1 || \
+    (LCD_ROWS <= 2 && LCD_COLS > 40) || (LCD_ROWS == 4 && LCD_COLS > 20)
+#error "Unsupported LCD geometry"
+#endif
+
+/* Function set - 4-bit interface, one or two line mode */
+#if LCD_ROWS == 1
+#define LCD_FUNCTION 0x20
+#else
+#define LCD_FUNCTION 0x28
+#endif
+
+/* Framebuffer refresh period - 50Hz */
+#define LCD_REFRESH_US 20000
+
+/* Command/data queue - power of two, at most 128 */
+#define LCD_QUEUE_SIZE 32
+
+/* Low level - one command/data byte and the busy flag wait */
+void init_lcd(void);
+void send_to_lcd(int, int);
+void wait_busy_lcd(void);
+unsigned char busy_lcd(void);
+
+/* Non-blocking - queue_lcd returns 0 when full, poll_lcd sends at most one
+ * byte when BF is clear and returns 0 once the queue has drained */
+unsigned char queue_lcd(unsigned char data, unsigned char command);
+unsigned char poll_lcd(void);
+
+/* Framebuffer - writes only touch RAM, update_lcd queues what changed */
+void put_at_lcd(unsigned char row, unsigned char col, unsigned char chr);
+void put_char_lcd(unsigned char chr);
+void update_lcd(void);
+void flush_lcd(void);
+
+#endif
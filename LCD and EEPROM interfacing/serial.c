@@ -0,0 +1,167 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Interrupt driven USART with RX/TX ring buffers
+ *
+ * Each ring has one producer and one consumer: the ISR fills RX and
+ * drains TX, the main loop does the opposite. Indices are free running
+ * bytes, so every update is a single atomic write and no interrupt
+ * masking is needed. Serial_Isr() has to be called from the high
+ * priority interrupt handler.
+ *
+ *******************************************************************/
+
+#include "serial.h"
+
+volatile unsigned int serial_rx_overruns = 0;
+volatile unsigned int serial_hw_overruns = 0;
+
+static unsigned char rx_buf[SERIAL_RX_SIZE];
+static unsigned char tx_buf[SERIAL_TX_SIZE];
+
+/* ISR writes rx_head/tx_tail, main loop writes rx_tail/tx_head */
+static volatile unsigned char rx_head, rx_tail;
+static volatile unsigned char tx_head, tx_tail;
+static volatile unsigned char rx_stopped;
+
+static unsigned long serial_baud = 0;
+
+/* Configure the USART for a baud rate, 8N1 with RX and TX enabled.
+ * The divider is rounded to nearest. The error against the target goes
+ * to *error in 0.01% units (may be 0). Rates out of tolerance are
+ * rejected and leave the USART untouched. Returns 1 on success. */
+unsigned char Serial_SetBaud(unsigned long fosc, unsigned long baud, int* error)
+{
+   unsigned long brg, actual;
+   long diff;
+
+   if(baud == 0 || baud > fosc / 4) return 0;
+
+   /* Nearest divider */
+   brg = (fosc + 2 * baud) / (4 * baud);
+   if(brg == 0) brg = 1;
+   if(brg > SERIAL_BRG_MAX + 1) return 0;
+
+   /* Achieved rate and error in 0.01%. The product fits a long while
+      the difference is under 214748 - past that the rate is far out of
+      tolerance and baud is large enough to scale down first */
+   actual = fosc / (4 * brg);
+   diff = (long)actual - (long)baud;
+   if(diff <= 214748L && diff >= -214748L) diff = diff * 10000 / (long)baud;
+   else diff = diff / (long)(baud / 10000);
+   if(error) *error = (int)diff;
+
+   if(diff > SERIAL_BAUD_TOLERANCE || diff < -SERIAL_BAUD_TOLERANCE) return 0;
+
+   /* BAUDCON BRG16, TXSTA TXEN|BRGH, RCSTA SPEN|CREN */
+   HAL_UartConfig((unsigned int)(brg - 1), 0x08, 0x26, 0x90);
+   serial_baud = actual;
+
+   return 1;
+}
+
+/* Achieved baud rate of the last successful Serial_SetBaud, 0 if none */
+unsigned long Serial_GetBaud()
+{
+   return serial_baud;
+}
+
+/* Start interrupt driven operation - USART must be configured */
+void Serial_Init()
+{
+   rx_head = rx_tail = 0;
+   tx_head = tx_tail = 0;
+   rx_stopped = 0;
+
+   HAL_UartTxIntEnable(0);
+   HAL_UartRxIntEnable(1);
+   HAL_IntEnable();
+}
+
+/* RX/TX interrupt service */
+void Serial_Isr()
+{
+   unsigned char c;
+
+   /* Drain the 2 byte receive FIFO */
+   while(HAL_UartRxReady())
+   {
+      c = HAL_UartRead();
+      if((unsigned char)(rx_head - rx_tail) < SERIAL_RX_SIZE)
+      {
+         rx_buf[rx_head & (SERIAL_RX_SIZE - 1)] = c;
+         rx_head++;
+      }
+      else
+      {
+         serial_rx_overruns++;
+      }
+   }
+
+   /* Receiver stops on OERR until CREN is cycled */
+   if(HAL_UartOverrun())
+   {
+      serial_hw_overruns++;
+      HAL_UartClearOverrun();
+   }
+
+   /* Ask the sender to pause before the ring fills */
+   if(!rx_stopped && (unsigned char)(rx_head - rx_tail) >= SERIAL_RX_HIGH)
+   {
+      rx_stopped = 1;
+      SERIAL_FLOW_STOP();
+   }
+
+   /* Transmit - TXIE is only set while the ring has data */
+   if(HAL_UartTxIntEnabled() && HAL_UartTxReady())
+   {
+      if(tx_tail != tx_head)
+      {
+         HAL_UartWrite(tx_buf[tx_tail & (SERIAL_TX_SIZE - 1)]);
+         tx_tail++;
+      }
+      else
+      {
+         HAL_UartTxIntEnable(0);
+      }
+   }
+}
+
+/* Fetch one received byte, 0 if none waiting */
+unsigned char Serial_Read(unsigned char* c)
+{
+   if(rx_head == rx_tail) return 0;
+
+   *c = rx_buf[rx_tail & (SERIAL_RX_SIZE - 1)];
+   rx_tail++;
+
+   /* Drained enough - let the sender resume */
+   if(rx_stopped && (unsigned char)(rx_head - rx_tail) <= SERIAL_RX_LOW)
+   {
+      rx_stopped = 0;
+      SERIAL_FLOW_START();
+   }
+
+   return 1;
+}
+
+/* Queue one byte for transmission, 0 if the ring is full */
+unsigned char Serial_Write(unsigned char c)
+{
+   if((unsigned char)(tx_head - tx_tail) >= SERIAL_TX_SIZE) return 0;
+
+   tx_buf[tx_head & (SERIAL_TX_SIZE - 1)] = c;
+   tx_head++;
+
+   /* Kick the transmitter */
+   HAL_UartTxIntEnable(1);
+
+   return 1;
+}
+
+/* Bytes waiting in the RX ring */
+unsigned char Serial_RxCount()
+{
+   return (unsigned char)(rx_head - rx_tail);
+}
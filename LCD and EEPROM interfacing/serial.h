@@ -0,0 +1,50 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC18F4520 on PICDEM2 Plus board
+ * SW: Interrupt driven USART with RX/TX ring buffers
+ *
+ *******************************************************************/
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include "hal_pic18.h"
+
+/* Ring sizes - powers of two, at most 128 */
+#define SERIAL_RX_SIZE 32
+#define SERIAL_TX_SIZE 32
+
+/* Flow control thresholds on the RX fill level */
+#define SERIAL_RX_HIGH (SERIAL_RX_SIZE - 8)
+#define SERIAL_RX_LOW  (SERIAL_RX_SIZE / 4)
+
+/* Flow control hooks - define before including to drive RTS or send
+ * XOFF/XON. STOP runs in the ISR, START from Serial_Read. */
+#ifndef SERIAL_FLOW_STOP
+#define SERIAL_FLOW_STOP()
+#endif
+#ifndef SERIAL_FLOW_START
+#define SERIAL_FLOW_START()
+#endif
+
+/* Async 8N1, BRG16 with BRGH: baud = Fosc / (4 * (SPBRGH:SPBRG + 1)) */
+#define SERIAL_BRG_MAX 65535UL
+
+/* Accepted baud error in 0.01% - ~5% is all a 10 bit frame takes for
+ * both ends together */
+#define SERIAL_BAUD_TOLERANCE 300
+
+/* Dropped byte counters */
+extern volatile unsigned int serial_rx_overruns;   /* RX ring full */
+extern volatile unsigned int serial_hw_overruns;   /* OERR - FIFO not drained in time */
+
+/* Prototypes */
+unsigned char Serial_SetBaud(unsigned long fosc, unsigned long baud, int* error);
+unsigned long Serial_GetBaud(void);
+void Serial_Init(void);
+void Serial_Isr(void);
+unsigned char Serial_Read(unsigned char* c);
+unsigned char Serial_Write(unsigned char c);
+unsigned char Serial_RxCount(void);
+
+#endif
@@ -0,0 +1,705 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: FAT32 file layer over pic32_sdcard
+ *
+ * Whole-sector reads and appends are merged across contiguous
+ * clusters into one multi-block command. The FAT is accessed
+ * through a window of FAT_WINDOW_SECTORS that is only written back
+ * when it moves or on sync.
+ *
+ *******************************************************************/
+
+#include "fat32.h"
+
+/* Volume layout */
+static unsigned int fat_lba, fat_size, data_lba, root_cluster;
+static unsigned int cluster_count, free_hint;
+static unsigned int sectors_per_cluster, num_fats;
+
+/* FAT window */
+static char fat_window[FAT_WINDOW_SECTORS * SECTOR_SIZE];
+static unsigned int fat_window_start = 0xFFFFFFFF;
+static unsigned int fat_window_count;   /* short for the last window */
+static int fat_window_dirty;
+
+/* fat_get/fat_alloc result when the card fails - not a FAT value */
+#define FAT_IO_ERROR 0xFFFFFFFF
+
+/* Directory sector scratch */
+static char dir_buffer[SECTOR_SIZE];
+static unsigned int dir_buffer_lba;
+
+/* Little endian field access */
+#define RD16(p) ((unsigned int)(unsigned char)(p)[0] | \
+                 ((unsigned int)(unsigned char)(p)[1] << 8))
+#define RD32(p) (RD16(p) | (RD16((p) + 2) << 16))
+
+static void wr16(char* p, unsigned int v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void wr32(char* p, unsigned int v)
+{
+    wr16(p, v & 0xFFFF);
+    wr16(p + 2, v >> 16);
+}
+
+
+/* First sector of a data cluster */
+static unsigned int cluster_lba(unsigned int cluster)
+{
+    return data_lba + (cluster - 2) * sectors_per_cluster;
+}
+
+
+/* Write the FAT window back to every FAT copy */
+static int fat_flush(void)
+{
+    unsigned int i;
+
+    if(!fat_window_dirty) return 1;
+
+    for(i = 0; i < num_fats; i++)
+    {
+        if(SDCard_WriteSectors(fat_lba + i * fat_size + fat_window_start,
+                               fat_window_count, fat_window, 0) != 1)
+        {
+            return ERROR_FAT_IO;
+        }
+    }
+
+    fat_window_dirty = 0;
+    return 1;
+}
+
+
+/* Slide the FAT window over the sector holding a cluster's entry */
+static char* fat_entry(unsigned int cluster)
+{
+    unsigned int sector = cluster / (SECTOR_SIZE / 4);
+    unsigned int start = sector - (sector % FAT_WINDOW_SECTORS);
+    unsigned int count;
+
+    if(sector >= fat_size) return 0;
+
+    if(start != fat_window_start)
+    {
+        if(fat_flush() != 1) return 0;
+
+        /* Stop at the end of the FAT - the sectors after it are the
+         * next copy or the data area, and fat_flush writes back
+         * exactly what was loaded */
+        count = fat_size - start;
+        if(count > FAT_WINDOW_SECTORS) count = FAT_WINDOW_SECTORS;
+
+        if(SDCard_ReadSectors(fat_lba + start, count, fat_window) != 1)
+        {
+            fat_window_start = 0xFFFFFFFF;
+            return 0;
+        }
+        fat_window_start = start;
+        fat_window_count = count;
+    }
+
+    return &fat_window[(cluster * 4) % sizeof(fat_window)];
+}
+
+
+/* Next cluster in a chain, FAT_IO_ERROR on I/O error */
+static unsigned int fat_get(unsigned int cluster)
+{
+    char* p = fat_entry(cluster);
+    if(!p) return FAT_IO_ERROR;
+    return RD32(p) & FAT32_MASK;
+}
+
+
+/* Set a FAT entry, keeping the reserved top bits */
+static int fat_set(unsigned int cluster, unsigned int value)
+{
+    char* p = fat_entry(cluster);
+    if(!p) return ERROR_FAT_IO;
+
+    wr32(p, (RD32(p) & ~FAT32_MASK) | (value & FAT32_MASK));
+    fat_window_dirty = 1;
+    return 1;
+}
+
+
+/* Allocate a cluster and link it after prev (0 = new chain).
+ * Prefers prev+1 so appended files stay contiguous. 0 if full,
+ * FAT_IO_ERROR as soon as the FAT cannot be read or written */
+static unsigned int fat_alloc(unsigned int prev)
+{
+    unsigned int c, n, value;
+
+    c = (prev != 0) ? prev + 1 : free_hint;
+
+    for(n = 0; n < cluster_count; n++, c++)
+    {
+        if(c >= cluster_count + 2) c = 2;
+
+        value = fat_get(c);
+        if(value == FAT_IO_ERROR) return FAT_IO_ERROR;
+
+        if(value == 0)
+        {
+            if(fat_set(c, FAT32_EOC) != 1) return FAT_IO_ERROR;
+            if(prev != 0 && fat_set(prev, c) != 1) return FAT_IO_ERROR;
+
+            free_hint = c + 1;
+            return c;
+        }
+    }
+
+    return 0;
+}
+
+
+/* Cluster after prev in a file being appended to, allocated when prev
+ * ends the chain. 0 if full, FAT_IO_ERROR on I/O error or when the
+ * chain is broken - a bad cluster marker is never linked past */
+static unsigned int fat_next_append(unsigned int prev)
+{
+    unsigned int next = fat_get(prev);
+
+    if(next >= FAT32_EOC_MIN && next <= FAT32_MASK) return fat_alloc(prev);
+    if(next < 2 || next >= cluster_count + 2) return FAT_IO_ERROR;
+
+    return next;
+}
+
+
+/* Load a directory sector into the scratch buffer */
+static int dir_load(unsigned int lba)
+{
+    if(lba == dir_buffer_lba) return 1;
+
+    if(SDCard_ReadSector(lba, dir_buffer) != 1)
+    {
+        dir_buffer_lba = 0;
+        return ERROR_FAT_IO;
+    }
+
+    dir_buffer_lba = lba;
+    return 1;
+}
+
+
+/* "log.txt" -> "LOG     TXT" */
+static void name_83(const char* name, char* out)
+{
+    int i;
+
+    for(i = 0; i < 11; i++) out[i] = ' ';
+
+    for(i = 0; *name && *name != '.' && i < 8; name++, i++)
+    {
+        out[i] = (*name >= 'a' && *name <= 'z') ? *name - 32 : *name;
+    }
+
+    while(*name && *name != '.') name++;
+    if(*name == '.') name++;
+
+    for(i = 8; *name && i < 11; name++, i++)
+    {
+        out[i] = (*name >= 'a' && *name <= 'z') ? *name - 32 : *name;
+    }
+}
+
+
+/* Mount the first FAT32 volume - bare VBR or first MBR partition */
+int Fat32_Mount(void)
+{
+    char* p = dir_buffer;
+    unsigned int part_lba = 0, total;
+
+    dir_buffer_lba = 0;
+    fat_window_start = 0xFFFFFFFF;
+    fat_window_dirty = 0;
+
+    if(SDCard_ReadSector(0, p) != 1) return ERROR_FAT_IO;
+    if((unsigned char)p[510] != 0x55 || (unsigned char)p[511] != 0xAA) return ERROR_FAT_MOUNT;
+
+    /* Not a boot sector - take partition 1 from the MBR */
+    if(p[82] != 'F' || p[83] != 'A' || p[84] != 'T' || p[85] != '3' || p[86] != '2')
+    {
+        if(p[450] != 0x0B && p[450] != 0x0C) return ERROR_FAT_MOUNT;
+
+        part_lba = RD32(p + 454);
+        if(SDCard_ReadSector(part_lba, p) != 1) return ERROR_FAT_IO;
+    }
+
+    if(RD16(p + 11) != SECTOR_SIZE) return ERROR_FAT_MOUNT;
+
+    sectors_per_cluster = (unsigned char)p[13];
+    num_fats = (unsigned char)p[16];
+    fat_size = RD32(p + 36);
+    root_cluster = RD32(p + 44);
+    total = RD32(p + 32);
+
+    if(sectors_per_cluster == 0 || fat_size == 0) return ERROR_FAT_MOUNT;
+
+    fat_lba = part_lba + RD16(p + 14);
+    data_lba = fat_lba + num_fats * fat_size;
+    cluster_count = (total - (data_lba - part_lba)) / sectors_per_cluster;
+    free_hint = 2;
+
+    return 1;
+}
+
+
+/* Open a root directory file - FAT32_APPEND creates it if missing */
+int Fat32_Open(FAT32_File* file, const char* name, int mode)
+{
+    char name83[11];
+    char* entry;
+    unsigned int cluster = root_cluster, prev = 0;
+    unsigned int lba, i, j, k, free_lba = 0, free_offset = 0;
+
+    name_83(name, name83);
+
+    /* Scan the root directory chain */
+    while(cluster >= 2 && cluster < FAT32_BAD)
+    {
+        for(i = 0; i < sectors_per_cluster; i++)
+        {
+            lba = cluster_lba(cluster) + i;
+            if(dir_load(lba) != 1) return ERROR_FAT_IO;
+
+            for(j = 0; j < SECTOR_SIZE; j += 32)
+            {
+                entry = dir_buffer + j;
+
+                /* Free slot - remember the first one, 0x00 ends the table */
+                if(entry[0] == 0x00 || (unsigned char)entry[0] == 0xE5)
+                {
+                    if(free_lba == 0) { free_lba = lba; free_offset = j; }
+                    if(entry[0] == 0x00) goto not_found;
+                    continue;
+                }
+
+                /* Skip long names, volume label and directories */
+                if(entry[11] & 0x18) continue;
+
+                for(k = 0; k < 11 && entry[k] == name83[k]; k++);
+                if(k < 11) continue;
+
+                file->first_cluster = (RD16(entry + 20) << 16) | RD16(entry + 26);
+                file->size = RD32(entry + 28);
+                file->dir_lba = lba;
+                file->dir_offset = j;
+                goto found;
+            }
+        }
+
+        prev = cluster;
+        cluster = fat_get(cluster);
+        if(cluster == FAT_IO_ERROR) return ERROR_FAT_IO;
+    }
+
+    not_found:
+    if(mode != FAT32_APPEND) return ERROR_FAT_NOFILE;
+
+    /* Root directory full - grow it by one zeroed cluster */
+    if(free_lba == 0)
+    {
+        /* Only past a proper end of chain */
+        if(cluster < FAT32_EOC_MIN) return ERROR_FAT_IO;
+
+        cluster = fat_alloc(prev);
+        if(cluster == FAT_IO_ERROR) return ERROR_FAT_IO;
+        if(cluster == 0) return ERROR_FAT_FULL;
+
+        for(j = 0; j < SECTOR_SIZE; j++) dir_buffer[j] = 0;
+        for(i = 0; i < sectors_per_cluster; i++)
+        {
+            if(SDCard_WriteSector(cluster_lba(cluster) + i, dir_buffer) != 1) return ERROR_FAT_IO;
+        }
+        dir_buffer_lba = cluster_lba(cluster) + sectors_per_cluster - 1;
+
+        free_lba = cluster_lba(cluster);
+        free_offset = 0;
+    }
+
+    if(dir_load(free_lba) != 1) return ERROR_FAT_IO;
+
+    entry = dir_buffer + free_offset;
+    for(j = 0; j < 32; j++) entry[j] = 0;
+    for(j = 0; j < 11; j++) entry[j] = name83[j];
+    entry[11] = 0x20;
+
+    if(SDCard_WriteSector(free_lba, dir_buffer) != 1) return ERROR_FAT_IO;
+
+    file->first_cluster = 0;
+    file->size = 0;
+    file->dir_lba = free_lba;
+    file->dir_offset = free_offset;
+
+    found:
+    file->mode = mode;
+    file->position = 0;
+    file->cluster = 0;
+    file->buffer_lba = 0;
+    file->buffer_dirty = 0;
+    file->stream_sectors = 0;
+
+    /* Appends start at the end of the chain */
+    if(mode == FAT32_APPEND && file->size > 0)
+    {
+        i = (file->size - 1) / (sectors_per_cluster * SECTOR_SIZE);
+        cluster = file->first_cluster;
+        while(i-- > 0)
+        {
+            cluster = fat_get(cluster);
+            if(cluster < 2 || cluster >= FAT32_BAD) return ERROR_FAT_IO;
+        }
+        file->cluster = cluster;
+        file->position = file->size;
+
+        /* Keep the partial tail sector in RAM */
+        if(file->size % SECTOR_SIZE)
+        {
+            lba = cluster_lba(cluster) +
+                  ((file->size - 1) / SECTOR_SIZE) % sectors_per_cluster;
+            if(SDCard_ReadSector(lba, file->buffer) != 1) return ERROR_FAT_IO;
+            file->buffer_lba = lba;
+        }
+    }
+
+    return 1;
+}
+
+
+/* Write back the buffered sector */
+static int file_flush_buffer(FAT32_File* file)
+{
+    if(file->buffer_dirty)
+    {
+        if(SDCard_WriteSector(file->buffer_lba, file->buffer) != 1) return ERROR_FAT_IO;
+        file->buffer_dirty = 0;
+    }
+    return 1;
+}
+
+
+/* Cluster holding byte position - steps the chain at cluster boundaries */
+static unsigned int file_cluster(FAT32_File* file)
+{
+    if(file->position % (sectors_per_cluster * SECTOR_SIZE) != 0) return file->cluster;
+    if(file->position == 0) return file->first_cluster;
+    return fat_get(file->cluster);
+}
+
+
+/* Read up to length bytes, returns bytes read or -1 on error */
+int Fat32_Read(FAT32_File* file, char* buffer, unsigned int length)
+{
+    unsigned int cur, next, last, lba, offset, sector, run, n, chunk;
+    int total = 0;
+
+    while(length > 0 && file->position < file->size)
+    {
+        cur = file_cluster(file);
+        if(cur < 2 || cur >= FAT32_BAD) return -1;
+
+        sector = (file->position / SECTOR_SIZE) % sectors_per_cluster;
+        offset = file->position % SECTOR_SIZE;
+        lba = cluster_lba(cur) + sector;
+
+        n = file->size - file->position;
+        if(n > length) n = length;
+        n /= SECTOR_SIZE;
+
+        if(offset == 0 && n > 0)
+        {
+            /* Whole sectors - extend the run over contiguous clusters */
+            run = sectors_per_cluster - sector;
+            last = cur;
+            while(run < n)
+            {
+                next = fat_get(last);
+                if(next != last + 1) break;
+                last = next;
+                run += sectors_per_cluster;
+            }
+            if(run > n) run = n;
+
+            if(file_flush_buffer(file) != 1) return -1;
+            if(SDCard_ReadSectors(lba, run, buffer) != 1) return -1;
+
+            chunk = run * SECTOR_SIZE;
+            file->cluster = cur + (sector + run - 1) / sectors_per_cluster;
+        }
+        else
+        {
+            /* Partial sector through the file buffer */
+            if(file->buffer_lba != lba)
+            {
+                if(file_flush_buffer(file) != 1) return -1;
+                if(SDCard_ReadSector(lba, file->buffer) != 1) return -1;
+                file->buffer_lba = lba;
+            }
+
+            chunk = SECTOR_SIZE - offset;
+            if(chunk > length) chunk = length;
+            if(chunk > file->size - file->position) chunk = file->size - file->position;
+
+            for(n = 0; n < chunk; n++) buffer[n] = file->buffer[offset + n];
+            file->cluster = cur;
+        }
+
+        file->position += chunk;
+        buffer += chunk;
+        length -= chunk;
+        total += chunk;
+    }
+
+    return total;
+}
+
+
+/* Append length bytes at the end of file, returns bytes written or -1 */
+int Fat32_Write(FAT32_File* file, char* buffer, unsigned int length)
+{
+    unsigned int cur, next, last, lba, offset, sector, run, n, chunk;
+    int total = 0;
+
+    if(file->mode != FAT32_APPEND || file->position != file->size) return -1;
+
+    /* Preallocated streams only take whole sectors via Fat32_StreamAppend */
+    if(file->stream_sectors != 0) return -1;
+
+    while(length > 0)
+    {
+        /* Crossing into a cluster - follow the chain or grow it */
+        if(file->position % (sectors_per_cluster * SECTOR_SIZE) == 0)
+        {
+            if(file->position == 0)
+            {
+                if(file->first_cluster == 0)
+                {
+                    cur = fat_alloc(0);
+                    if(cur == FAT_IO_ERROR) return -1;
+                    if(cur == 0) return total ? total : -1;
+                    file->first_cluster = cur;
+                }
+                cur = file->first_cluster;
+            }
+            else
+            {
+                /* Full volume ends the write short, a failed card fails it */
+                cur = fat_next_append(file->cluster);
+                if(cur == FAT_IO_ERROR) return -1;
+                if(cur == 0) return total ? total : -1;
+            }
+        }
+        else
+        {
+            cur = file->cluster;
+        }
+
+        sector = (file->position / SECTOR_SIZE) % sectors_per_cluster;
+        offset = file->position % SECTOR_SIZE;
+        lba = cluster_lba(cur) + sector;
+        n = length / SECTOR_SIZE;
+
+        if(offset == 0 && n > 0)
+        {
+            /* Whole sectors - grab contiguous clusters and burst them out */
+            run = sectors_per_cluster - sector;
+            last = cur;
+            while(run < n)
+            {
+                next = fat_next_append(last);
+                if(next == FAT_IO_ERROR) return -1;
+                if(next != last + 1) break;
+                last = next;
+                run += sectors_per_cluster;
+            }
+            if(run > n) run = n;
+
+            if(file_flush_buffer(file) != 1) return -1;
+            if(SDCard_WriteSectors(lba, run, buffer, 1) != 1) return -1;
+
+            chunk = run * SECTOR_SIZE;
+            file->cluster = cur + (sector + run - 1) / sectors_per_cluster;
+        }
+        else
+        {
+            /* Tail sector stays in RAM until it fills up or sync */
+            if(file->buffer_lba != lba)
+            {
+                if(file_flush_buffer(file) != 1) return -1;
+
+                /* Fresh sector past EOF - nothing to read back */
+                for(n = 0; n < SECTOR_SIZE; n++) file->buffer[n] = 0;
+                file->buffer_lba = lba;
+            }
+
+            chunk = SECTOR_SIZE - offset;
+            if(chunk > length) chunk = length;
+
+            for(n = 0; n < chunk; n++) file->buffer[offset + n] = buffer[n];
+            file->buffer_dirty = 1;
+            file->cluster = cur;
+
+            /* Sector complete - write it now, it will not change again */
+            if(offset + chunk == SECTOR_SIZE && file_flush_buffer(file) != 1) return -1;
+        }
+
+        file->position += chunk;
+        file->size = file->position;
+        buffer += chunk;
+        length -= chunk;
+        total += chunk;
+    }
+
+    return total;
+}
+
+
+/* Commit buffered data, FAT window and directory entry */
+int Fat32_Sync(FAT32_File* file)
+{
+    char* entry;
+
+    if(file->mode != FAT32_APPEND) return 1;
+
+    if(file_flush_buffer(file) != 1) return ERROR_FAT_IO;
+    if(fat_flush() != 1) return ERROR_FAT_IO;
+
+    if(dir_load(file->dir_lba) != 1) return ERROR_FAT_IO;
+
+    entry = dir_buffer + file->dir_offset;
+    wr16(entry + 20, file->first_cluster >> 16);
+    wr16(entry + 26, file->first_cluster & 0xFFFF);
+    wr32(entry + 28, file->size);
+
+    if(SDCard_WriteSector(file->dir_lba, dir_buffer) != 1) return ERROR_FAT_IO;
+
+    return 1;
+}
+
+
+/* Find n free consecutive clusters, returns the first, 0 if there
+ * is no such run or FAT_IO_ERROR. Bad clusters just break a run */
+static unsigned int fat_find_extent(unsigned int n)
+{
+    unsigned int c, start = 0, run = 0, value;
+
+    for(c = 2; c < cluster_count + 2; c++)
+    {
+        value = fat_get(c);
+        if(value == FAT_IO_ERROR) return FAT_IO_ERROR;
+
+        if(value != 0)
+        {
+            run = 0;
+            continue;
+        }
+
+        if(run == 0) start = c;
+        if(++run == n) return start;
+    }
+
+    return 0;
+}
+
+
+/* Create an empty file backed by one contiguous extent of size bytes.
+ * Appends then go straight to the card with no FAT/directory traffic */
+int Fat32_Preallocate(FAT32_File* file, const char* name, unsigned int size)
+{
+    unsigned int cluster_bytes = sectors_per_cluster * SECTOR_SIZE;
+    unsigned int n, start, c;
+    int result;
+
+    result = Fat32_Open(file, name, FAT32_APPEND);
+    if(result != 1) return result;
+
+    /* Stream files start empty */
+    if(file->size != 0 || file->first_cluster != 0) return ERROR_FAT_FULL;
+
+    n = (size + cluster_bytes - 1) / cluster_bytes;
+    if(n == 0) n = 1;
+
+    start = fat_find_extent(n);
+    if(start == FAT_IO_ERROR) return ERROR_FAT_IO;
+    if(start == 0) return ERROR_FAT_FULL;
+
+    /* Chain the extent in one pass */
+    for(c = start; c < start + n - 1; c++)
+    {
+        if(fat_set(c, c + 1) != 1) return ERROR_FAT_IO;
+    }
+    if(fat_set(c, FAT32_EOC) != 1) return ERROR_FAT_IO;
+
+    file->first_cluster = start;
+    file->stream_lba = cluster_lba(start);
+    file->stream_sectors = n * sectors_per_cluster;
+
+    /* Chain and first cluster must be on the card before any data */
+    return Fat32_Sync(file);
+}
+
+
+/* Append one full sector to a preallocated file - a single CMD24 */
+int Fat32_StreamAppend(FAT32_File* file, char* sector)
+{
+    unsigned int index = file->size / SECTOR_SIZE;
+
+    if(file->stream_sectors == 0) return ERROR_FAT_NOFILE;
+    if(index >= file->stream_sectors) return ERROR_FAT_FULL;
+
+    if(SDCard_WriteSector(file->stream_lba + index, sector) != 1) return ERROR_FAT_IO;
+
+    file->size += SECTOR_SIZE;
+    file->position = file->size;
+
+    return 1;
+}
+
+
+/* Give back the unused end of a preallocated extent */
+static int fat_trim_stream(FAT32_File* file)
+{
+    unsigned int cluster_bytes = sectors_per_cluster * SECTOR_SIZE;
+    unsigned int used, total, c;
+
+    total = file->stream_sectors / sectors_per_cluster;
+    used = (file->size + cluster_bytes - 1) / cluster_bytes;
+    if(used == 0) used = 1;
+
+    for(c = file->first_cluster + used; c < file->first_cluster + total; c++)
+    {
+        if(fat_set(c, 0) != 1) return ERROR_FAT_IO;
+    }
+    if(fat_set(file->first_cluster + used - 1, FAT32_EOC) != 1) return ERROR_FAT_IO;
+
+    file->cluster = file->first_cluster + used - 1;
+    file->stream_sectors = 0;
+
+    return 1;
+}
+
+
+/* Sync and forget the file */
+int Fat32_Close(FAT32_File* file)
+{
+    int result = 1;
+
+    /* Stream extent shrinks to what was written */
+    if(file->stream_sectors != 0) result = fat_trim_stream(file);
+
+    if(Fat32_Sync(file) != 1) result = ERROR_FAT_IO;
+
+    file->buffer_lba = 0;
+    file->buffer_dirty = 0;
+
+    return result;
+}
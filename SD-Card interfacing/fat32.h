@@ -0,0 +1,71 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: FAT32 file layer over pic32_sdcard
+ *
+ *******************************************************************/
+#ifndef FAT32_H
+#define	FAT32_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include "pic32_sdcard.h"
+
+/* FAT sectors kept in RAM, loaded and written back as one run */
+#define FAT_WINDOW_SECTORS 4
+
+/* Open modes */
+#define FAT32_READ   0
+#define FAT32_APPEND 1
+
+/* Error codes */
+#define ERROR_FAT_MOUNT  201
+#define ERROR_FAT_NOFILE 202
+#define ERROR_FAT_FULL   203
+#define ERROR_FAT_IO     204
+
+/* Cluster chain markers */
+#define FAT32_EOC     0x0FFFFFFF
+#define FAT32_EOC_MIN 0x0FFFFFF8   /* any value from here up ends a chain */
+#define FAT32_BAD     0x0FFFFFF7
+#define FAT32_MASK    0x0FFFFFFF
+
+/* Open file - root directory, 8.3 names only */
+typedef struct
+{
+    unsigned int first_cluster;
+    unsigned int cluster;        /* cluster holding byte position-1 */
+    unsigned int size;
+    unsigned int position;
+    unsigned int dir_lba;        /* sector holding the directory entry */
+    unsigned int dir_offset;
+    unsigned int buffer_lba;     /* sector held in buffer, 0 = none */
+    unsigned int stream_lba;     /* preallocated extent, 0 sectors = none */
+    unsigned int stream_sectors;
+    unsigned char buffer_dirty;
+    unsigned char mode;
+    char buffer[SECTOR_SIZE];    /* partial sector / append tail */
+} FAT32_File;
+
+/* Preallocated streams: Fat32_StreamAppend writes raw sectors only,
+ * Fat32_Sync is the checkpoint that publishes the size, and
+ * Fat32_Close frees the unused part of the extent */
+
+/* Prototypes */
+int Fat32_Mount(void);
+int Fat32_Open(FAT32_File* file, const char* name, int mode);
+int Fat32_Read(FAT32_File* file, char* buffer, unsigned int length);
+int Fat32_Write(FAT32_File* file, char* buffer, unsigned int length);
+int Fat32_Sync(FAT32_File* file);
+int Fat32_Close(FAT32_File* file);
+int Fat32_Preallocate(FAT32_File* file, const char* name, unsigned int size);
+int Fat32_StreamAppend(FAT32_File* file, char* sector);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* FAT32_H */
@@ -0,0 +1,137 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: Hardware abstraction for the SD Card driver
+ *
+ * On target every call is a macro over the SFRs, so the driver
+ * compiles to the same register accesses as before. Building with
+ * HAL_HOST turns them into functions provided by host/hal_host.c,
+ * which runs SPI2 against the SD card model on a simulated core timer.
+ *
+ *******************************************************************/
+#ifndef HAL_PIC32_H
+#define	HAL_PIC32_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#ifndef HAL_HOST
+
+#include <p32xxxx.h>
+#include <sys/attribs.h>
+#include <sys/kmem.h>
+
+/*
+ * WD - RF1/RG1
+ * CD - RF0/RG0
+ * CS - RB1/RB9
+ * SCK - RF6/RG6
+ * SDI - RF7/RG7
+ * SDO - RF8/RG8
+ */
+
+/* SPI2 */
+#define HAL_SpiPins()         _TRISG6 = 0; _TRISG8 = 0; _TRISG7 = 1
+#define HAL_SpiConfig(brg, con) SPI2CON = 0; SPI2BRG = (brg); SPI2CON = (con)
+#define HAL_SpiPut(c)         (SPI2BUF = (c))
+#define HAL_SpiRxFull()       (SPI2STATbits.SPIRBF)
+#define HAL_SpiGet()          (SPI2BUF)
+
+/* SD Card socket */
+#define HAL_CardPins()        _TRISB9 = 0; _TRISB1 = 0; _TRISG0 = 1; _TRISG1 = 0
+#define HAL_CardSelect(v)     (_RB9 = (v))
+#define HAL_CardWriteProtect(v) (_RG1 = (v))
+#define HAL_CardDetect()      (_RG0)
+
+/* Starter kit LEDs on RD0-RD2 */
+#define HAL_LedPins()         _TRISD0 = 0; _TRISD1 = 0; _TRISD2 = 0
+#define HAL_Led(n, v)         ((v) ? (LATDSET = 1 << (n)) : (LATDCLR = 1 << (n)))
+#define HAL_LedWrite(v)       (PORTD = (v))
+
+/* Core timer - counts at SYS_FREQ/2 */
+#define HAL_TimerRead()       _CP0_GET_COUNT()
+
+/* Multi-vector interrupts on */
+#define HAL_IntEnable()       INTCONbits.MVEC = 1; __builtin_enable_interrupts()
+
+/* Drop a stale receive byte and the overflow flag */
+#define HAL_SpiFlush()        do { volatile unsigned int d_ = SPI2BUF; (void)d_; \
+                                   SPI2STATbits.SPIROV = 0; } while(0)
+
+/* Wait out the byte still in the shifter, then flush */
+#define HAL_SpiDrain()        do { while(SPI2STATbits.SPIBUSY); HAL_SpiFlush(); } while(0)
+
+/* DMA channel 0 - SPI2BUF -> dst, one byte per receive-buffer-full event,
+ * block done interrupt at ipl5 */
+#define HAL_DmaOn()           (DMACONbits.ON = 1)
+#define HAL_DmaRxStart(dst, n) do { \
+        DCH0CON = 0x03; DCH0ECON = (_SPI2_RX_IRQ << 8) | 0x10; \
+        DCH0INTCLR = 0x00FF00FF; \
+        DCH0SSA = KVA_TO_PA(&SPI2BUF); DCH0DSA = KVA_TO_PA(dst); \
+        DCH0SSIZ = 1; DCH0DSIZ = (n); DCH0CSIZ = 1; \
+        DCH0INTSET = 0x00080000; \
+        IFS1bits.DMA0IF = 0; IPC9bits.DMA0IP = 5; IEC1bits.DMA0IE = 1; \
+        DCH0CONbits.CHEN = 1; } while(0)
+
+/* DMA channel 1 - src -> SPI2BUF, one byte per transmit-buffer-empty event.
+ * irq asks for the block done interrupt (write only transfers). The TX
+ * buffer is already empty, so the first byte is forced out */
+#define HAL_DmaTxStart(src, n, irq) do { \
+        DCH1CON = 0x03; DCH1ECON = (_SPI2_TX_IRQ << 8) | 0x10; \
+        DCH1INTCLR = 0x00FF00FF; \
+        DCH1SSA = KVA_TO_PA(src); DCH1DSA = KVA_TO_PA(&SPI2BUF); \
+        DCH1SSIZ = (n); DCH1DSIZ = 1; DCH1CSIZ = 1; \
+        if(irq) { DCH1INTSET = 0x00080000; IFS1bits.DMA1IF = 0; \
+                  IPC9bits.DMA1IP = 5; IEC1bits.DMA1IE = 1; } \
+        DCH1CONbits.CHEN = 1; DCH1ECONbits.CFORCE = 1; } while(0)
+
+/* Acknowledge and mask the block done interrupt */
+#define HAL_DmaRxAck()        DCH0INTCLR = 0x000000FF; IFS1bits.DMA0IF = 0; IEC1bits.DMA0IE = 0
+#define HAL_DmaTxAck()        DCH1INTCLR = 0x000000FF; IFS1bits.DMA1IF = 0; IEC1bits.DMA1IE = 0
+
+/* Nothing else to run while a blocking transfer is in flight */
+#define HAL_DmaIdle()         ((void)0)
+
+#else
+
+/* Host backend */
+void HAL_SpiPins(void);
+void HAL_SpiConfig(unsigned int brg, unsigned int con);
+void HAL_SpiPut(unsigned char c);
+int HAL_SpiRxFull(void);
+unsigned char HAL_SpiGet(void);
+
+void HAL_CardPins(void);
+void HAL_CardSelect(int v);
+void HAL_CardWriteProtect(int v);
+int HAL_CardDetect(void);
+
+void HAL_LedPins(void);
+void HAL_Led(int n, int v);
+void HAL_LedWrite(unsigned char v);
+
+unsigned int HAL_TimerRead(void);
+
+/* Interrupts are plain calls from the simulated DMA */
+#define __ISR(vector, ipl)
+
+void HAL_IntEnable(void);
+void HAL_SpiFlush(void);
+void HAL_SpiDrain(void);
+
+void HAL_DmaOn(void);
+void HAL_DmaRxStart(char* dst, int n);
+void HAL_DmaTxStart(char* src, int n, int irq);
+void HAL_DmaRxAck(void);
+void HAL_DmaTxAck(void);
+void HAL_DmaIdle(void);
+
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* HAL_PIC32_H */
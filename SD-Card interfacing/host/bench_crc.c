@@ -0,0 +1,98 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Cycles/byte of the table driven and bit-serial CRC kernels
+ *
+ * Host cycles, not M4K ones - the ratio is what carries over.
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include <time.h>
+#include "sd_crc.h"
+#include "host_test.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#else
+#define CYCLES() 0
+#endif
+
+#define BLOCK  512
+#define BLOCKS 2000
+#define TRIES  5
+
+/* sd_crc.c built with SD_CRC_SMALL */
+unsigned char SD_Crc7_Small(const unsigned char* data, int length);
+unsigned short SD_Crc16_Small(const char* data, int length, unsigned short crc);
+
+static char block[BLOCK];
+static volatile unsigned int sink;
+
+typedef struct { double ns, cycles; } Cost;
+
+static double now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* Best of TRIES runs over BLOCKS sectors, per byte */
+static Cost measure(int kernel)
+{
+    Cost best = { 1e9, 1e9 }, c;
+    unsigned long long c0;
+    double t0;
+    int t, b;
+
+    for(t = 0; t < TRIES; t++)
+    {
+        t0 = now_ns();
+        c0 = CYCLES();
+        for(b = 0; b < BLOCKS; b++)
+        {
+            block[0] = b;
+            switch(kernel)
+            {
+            case 0: sink += SD_Crc16(block, BLOCK, 0); break;
+            case 1: sink += SD_Crc16_Small(block, BLOCK, 0); break;
+            case 2: sink += SD_Crc7((unsigned char*)block, BLOCK); break;
+            case 3: sink += SD_Crc7_Small((unsigned char*)block, BLOCK); break;
+            }
+        }
+        c.cycles = (double)(CYCLES() - c0) / (BLOCKS * BLOCK);
+        c.ns = (now_ns() - t0) / (BLOCKS * BLOCK);
+        if(c.ns < best.ns) best = c;
+    }
+
+    return best;
+}
+
+
+int main(void)
+{
+    static const char* names[] = { "CRC16 table", "CRC16 bitwise", "CRC7 table", "CRC7 bitwise" };
+    Cost cost[4];
+    int i, k;
+
+    for(i = 0; i < BLOCK; i++) block[i] = i * 37;
+
+    printf("%14s %10s %12s\n", "", "ns/byte", "cycles/byte");
+    for(k = 0; k < 4; k++)
+    {
+        cost[k] = measure(k);
+        printf("%14s %10.2f %12.2f\n", names[k], cost[k].ns, cost[k].cycles);
+    }
+    printf("bitwise/table: CRC16 %.1fx, CRC7 %.1fx\n",
+           cost[1].ns / cost[0].ns, cost[3].ns / cost[2].ns);
+
+    /* Same answers, and the tables have to earn their 768 bytes */
+    CHECK_EQ(SD_Crc16(block, BLOCK, 0), SD_Crc16_Small(block, BLOCK, 0));
+    CHECK(cost[0].ns < cost[1].ns);
+    CHECK(cost[2].ns < cost[3].ns);
+
+    return TEST_DONE();
+}
@@ -0,0 +1,165 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: Acquisition stalls - a 2kHz sampler logging to the card with
+ *     blocking SDCard_WriteSector and through the request queue
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "sd_queue.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#define PERIOD_US   500     /* one sample every PERIOD_US */
+#define SAMPLE_US   20      /* CPU time to take a sample */
+#define SAMPLE_SIZE 16      /* bytes logged per sample */
+#define SAMPLES     1024    /* 32 sectors */
+#define FIRST       2000    /* first sector of the log */
+
+#define PER_SECTOR (SECTOR_SIZE / SAMPLE_SIZE)
+
+typedef struct
+{
+    unsigned long long worst_us, total_us;
+    unsigned int late;      /* taken a whole period or more behind */
+    unsigned int sectors;
+} Run;
+
+static char block[2][SECTOR_SIZE];
+
+
+static void sample(char* at, unsigned int n)
+{
+    int i;
+
+    Host_Advance(SAMPLE_US);
+    for(i = 0; i < SAMPLE_SIZE; i++) at[i] = n * 3 + i;
+}
+
+
+/* Take SAMPLES samples on schedule, logging each full block */
+static void acquire(int queued, Run* run)
+{
+    SDQueue_Request req[2];
+    unsigned long long next, now, lag;
+    unsigned int n = 0;
+    int fill = 0;
+
+    memset(run, 0, sizeof(*run));
+    SDQueue_Init();
+    req[0].status = req[1].status = 1;
+    next = Host_Ticks();
+
+    while(n < SAMPLES)
+    {
+        if(queued) SDCard_Poll();
+
+        now = Host_Ticks();
+        if(now < next)
+        {
+            Host_Advance(1);
+            continue;
+        }
+
+        lag = (now - next) / CORE_TICKS_US;
+        if(lag > run->worst_us) run->worst_us = lag;
+        if(lag >= PERIOD_US) run->late++;
+        run->total_us += lag;
+
+        sample(block[fill] + (n % PER_SECTOR) * SAMPLE_SIZE, n);
+        n++;
+        next += PERIOD_US * CORE_TICKS_US;
+
+        if(n % PER_SECTOR) continue;
+
+        /* Block full - log it and carry on in the other one */
+        if(queued)
+        {
+            CHECK(req[fill].status != SDQ_PENDING);
+            CHECK(SDQueue_Write(&req[fill], FIRST + n / PER_SECTOR - 1, block[fill], 0));
+        }
+        else
+        {
+            CHECK_EQ(SDCard_WriteSector(FIRST + n / PER_SECTOR - 1, block[fill]), 1);
+        }
+        run->sectors++;
+        fill ^= 1;
+    }
+
+    /* Drain - other work between polls */
+    while(queued && SDCard_Poll()) Host_Advance(1);
+    if(queued) CHECK(req[0].status == 1 && req[1].status == 1);
+}
+
+
+/* Log on the card is the sampler's output */
+static void verify(void)
+{
+    char data[SECTOR_SIZE];
+    unsigned int n;
+    int i;
+
+    for(n = 0; n < SAMPLES; n++)
+    {
+        if(n % PER_SECTOR == 0) SDModel_Read(FIRST + n / PER_SECTOR, data);
+        for(i = 0; i < SAMPLE_SIZE; i++)
+        {
+            if(data[(n % PER_SECTOR) * SAMPLE_SIZE + i] != (char)(n * 3 + i))
+            {
+                CHECK(0);
+                return;
+            }
+        }
+    }
+}
+
+
+static void report(const char* name, Run* run)
+{
+    printf("%10s %8u %12llu %12.1f %8u\n", name, run->sectors, run->worst_us,
+           (double)run->total_us / SAMPLES, run->late);
+}
+
+
+int main(void)
+{
+    char blank[SECTOR_SIZE];
+    Run blocking, queued;
+    unsigned int s;
+
+    CHECK(SDModel_Init(SDMODEL_SDHC, 8192));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+
+    printf("sample every %u us, %u bytes, sector every %u ms\n",
+           PERIOD_US, SAMPLE_SIZE, PERIOD_US * PER_SECTOR / 1000);
+    printf("%10s %8s %12s %12s %8s\n", "", "sectors", "worst us", "mean us", "late");
+
+    acquire(0, &blocking);
+    report("blocking", &blocking);
+    verify();
+
+    memset(blank, 0, sizeof(blank));
+    for(s = 0; s < SAMPLES / PER_SECTOR; s++) SDModel_Write(FIRST + s, blank);
+
+    acquire(1, &queued);
+    report("queued", &queued);
+    verify();
+
+    /* A blocking write holds the sampler for the whole card programming
+       time, the queue only for the longest single poll step */
+    CHECK(blocking.worst_us > 2 * PERIOD_US);
+    CHECK(blocking.late >= blocking.sectors);
+    CHECK(queued.worst_us < PERIOD_US / 4);
+    CHECK_EQ(queued.late, 0);
+
+    CHECK_EQ(sdmodel_stats.crc_errors, 0);
+    SDModel_Close();
+    return TEST_DONE();
+}
@@ -0,0 +1,174 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: Sector cache - a recorded block trace replayed straight to the
+ *     card and through SDCache_*, card commands and time compared
+ *
+ * The trace is test_fat32.trace, written by "test_fat32 <file>": the
+ * blocks the FAT layer read and wrote, one per line, in order. Both
+ * runs replay it a sector at a time, as the cache would see it.
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "sd_cache.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#define SECTORS  8192
+#define OPS_MAX  8192
+
+static struct
+{
+    char write;
+    unsigned int sector;
+} ops[OPS_MAX];
+static unsigned int op_count;
+
+/* Card contents after each run, for the touched sectors */
+static unsigned int last_op[SECTORS];
+
+typedef struct
+{
+    unsigned int commands;
+    unsigned int reads, writes;       /* CMD17+CMD18, CMD24+CMD25 */
+    unsigned int blocks_read, blocks_written;
+    double ms;
+    SDCache_Stats cache;
+} Run;
+
+
+static int load(const char* path)
+{
+    char line[64], kind;
+    unsigned int sector;
+    FILE* in = fopen(path, "r");
+
+    if(in == 0) return 0;
+
+    while(fgets(line, sizeof(line), in) && op_count < OPS_MAX)
+    {
+        if(line[0] == '#') continue;
+        if(sscanf(line, "%c %u", &kind, &sector) != 2 || sector >= SECTORS) continue;
+
+        ops[op_count].write = (kind == 'W');
+        ops[op_count].sector = sector;
+        op_count++;
+    }
+
+    fclose(in);
+    return op_count > 0;
+}
+
+/* Data of the i-th operation */
+static void fill(char* data, unsigned int i)
+{
+    int n;
+    for(n = 0; n < SECTOR_SIZE; n++) data[n] = i * 7 + n;
+}
+
+
+static void replay(int cached, Run* run)
+{
+    static char buffer[SECTOR_SIZE];
+    unsigned long long t0;
+    unsigned int i, c;
+
+    CHECK(SDModel_Init(SDMODEL_SDHC, SECTORS));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+    SDCache_Init();
+    SDModel_ResetStats();
+
+    t0 = Host_Ticks();
+    for(i = 0; i < op_count; i++)
+    {
+        if(ops[i].write)
+        {
+            fill(buffer, i);
+            if(cached) CHECK_EQ(SDCache_WriteSector(ops[i].sector, buffer), 1);
+            else CHECK_EQ(SDCard_WriteSector(ops[i].sector, buffer), 1);
+        }
+        else
+        {
+            if(cached) CHECK_EQ(SDCache_ReadSector(ops[i].sector, buffer), 1);
+            else CHECK_EQ(SDCard_ReadSector(ops[i].sector, buffer), 1);
+        }
+    }
+    if(cached) CHECK_EQ(SDCache_Flush(), 1);
+
+    run->ms = (double)(Host_Ticks() - t0) / CORE_TICKS_US / 1000;
+    run->commands = 0;
+    for(c = 0; c < 64; c++) run->commands += sdmodel_stats.commands[c] + sdmodel_stats.app_commands[c];
+    run->reads = sdmodel_stats.commands[CMD17] + sdmodel_stats.commands[CMD18];
+    run->writes = sdmodel_stats.commands[CMD24] + sdmodel_stats.commands[CMD25];
+    run->blocks_read = sdmodel_stats.blocks_read;
+    run->blocks_written = sdmodel_stats.blocks_written;
+    SDCache_GetStats(&run->cache);
+
+    /* Every written sector holds its last write */
+    for(i = 0; i < op_count; i++)
+        if(ops[i].write) last_op[ops[i].sector] = i;
+    for(i = 0; i < op_count; i++)
+    {
+        char expect[SECTOR_SIZE];
+
+        if(!ops[i].write || last_op[ops[i].sector] != i) continue;
+        SDModel_Read(ops[i].sector, buffer);
+        fill(expect, i);
+        CHECK(memcmp(buffer, expect, SECTOR_SIZE) == 0);
+    }
+
+    CHECK_EQ(sdmodel_stats.crc_errors, 0);
+    SDModel_Close();
+}
+
+static void report(const char* name, Run* run)
+{
+    printf("%8s %6u %6u %6u %9u %7u %6u %6u %6u %9.1f\n", name,
+           run->cache.hits, run->cache.misses, run->cache.evictions,
+           run->commands, run->reads, run->writes,
+           run->blocks_read, run->blocks_written, run->ms);
+}
+
+
+int main(int argc, char** argv)
+{
+    Run direct, cached;
+    unsigned int i, writes = 0;
+
+    CHECK(argc > 1 && load(argv[1]));
+    if(op_count == 0) return TEST_DONE();
+
+    for(i = 0; i < op_count; i++) writes += ops[i].write;
+
+    printf("%s: %u blocks, %u written, cache %u sets x %u ways\n",
+           argv[1], op_count, writes, SDCACHE_SETS, SDCACHE_WAYS);
+    printf("%8s %6s %6s %6s %9s %7s %6s %6s %6s %9s\n", "",
+           "hits", "misses", "evict", "commands", "reads", "writes",
+           "blk rd", "blk wr", "ms");
+
+    replay(0, &direct);
+    report("direct", &direct);
+    replay(1, &cached);
+    report("cached", &cached);
+
+    /* Straight to the card - one command per block */
+    CHECK_EQ(direct.reads + direct.writes, op_count);
+    CHECK_EQ(direct.cache.hits + direct.cache.misses, 0);
+
+    /* Every block goes through the cache once, and the card sees less
+       of both kinds of traffic for it */
+    CHECK_EQ(cached.cache.hits + cached.cache.misses, op_count);
+    CHECK(cached.reads < direct.reads);
+    CHECK(cached.blocks_written < direct.blocks_written);
+    CHECK(cached.commands < direct.commands);
+    CHECK(cached.ms < direct.ms);
+
+    return TEST_DONE();
+}
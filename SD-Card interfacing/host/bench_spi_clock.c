@@ -0,0 +1,92 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: Bytes/second per SPI clock profile - raw byte loop, DMA buffer
+ *     and whole sector reads
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include "pic32_sdcard.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#define ROUNDS 8
+
+static char buffer[SECTOR_SIZE];
+
+static double per_second(unsigned long long since, unsigned long bytes)
+{
+    return bytes * (double)CORE_TICKS_MS * 1000 / (double)(Host_Ticks() - since);
+}
+
+
+int main(void)
+{
+    static const struct { const char* name; unsigned int hz; } profiles[] =
+    {
+        { "init",  SPI_CLOCK_INIT },
+        { "1MHz",  1000000 },
+        { "2MHz",  2000000 },
+        { "data",  SPI_CLOCK_DATA },
+    };
+    double loop, dma, sector, wire[4];
+    unsigned long long t0;
+    unsigned int clock;
+    int p, i, r;
+
+    CHECK(SDModel_Init(SDMODEL_SDHC, 8192));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+
+    /* Identification runs on the init profile */
+    CHECK(SPI_GetClock() <= 400000);
+    CHECK_EQ(SDCard_Init(), 0);
+    CHECK_EQ(SPI_GetClock(), PB_FREQ / 2);
+
+    printf("PBCLK %u Hz\n", PB_FREQ);
+    printf("%6s %10s %12s %12s %12s %12s\n",
+           "", "SPI Hz", "wire B/s", "loop B/s", "DMA B/s", "sector B/s");
+
+    for(p = 0; p < 4; p++)
+    {
+        clock = SPI_SetClock(profiles[p].hz);
+        CHECK(clock <= profiles[p].hz);
+        wire[p] = clock / 8.0;
+
+        /* Byte at a time through SPI_Write */
+        SDCard_Disable();
+        t0 = Host_Ticks();
+        for(r = 0; r < ROUNDS; r++)
+            for(i = 0; i < SECTOR_SIZE; i++) SPI_Write(0xFF);
+        loop = per_second(t0, ROUNDS * SECTOR_SIZE);
+
+        /* Same bytes by DMA */
+        t0 = Host_Ticks();
+        for(r = 0; r < ROUNDS; r++) SPI_ReadBuffer(buffer, SECTOR_SIZE);
+        dma = per_second(t0, ROUNDS * SECTOR_SIZE);
+
+        /* Sector reads, command and token overhead included */
+        t0 = Host_Ticks();
+        for(r = 0; r < ROUNDS; r++) CHECK_EQ(SDCard_ReadSector(r, buffer), 1);
+        sector = per_second(t0, ROUNDS * SECTOR_SIZE);
+
+        printf("%6s %10u %12.0f %12.0f %12.0f %12.0f\n",
+               profiles[p].name, clock, wire[p], loop, dma, sector);
+
+        /* DMA keeps the wire full, the loop pays per byte on top */
+        CHECK(dma <= wire[p] && dma > wire[p] * 0.98);
+        CHECK(loop < dma);
+        CHECK(sector < dma);
+    }
+
+    /* The data profile is the fastest PBCLK allows - PBCLK/2 */
+    CHECK_EQ(SPI_GetClock(), PB_FREQ / 2);
+    CHECK(wire[3] / wire[0] >= 10);
+
+    SDModel_Close();
+    return TEST_DONE();
+}
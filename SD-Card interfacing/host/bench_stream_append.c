@@ -0,0 +1,195 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model on an image file
+ * SW: Append latency - preallocated stream vs plain Fat32_Write of
+ *     whole sectors, same checkpoint interval
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fat32.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#define IMAGE      "bench_stream_append.img"
+#define SECTORS    65536
+#define RESERVED   32
+#define FAT_SIZE   64
+#define CLUSTER    8        /* sectors */
+#define APPENDS    2048
+#define CHECKPOINT 256      /* Fat32_Sync every so many sectors */
+
+static unsigned int latency[APPENDS];
+static unsigned int sync_worst;
+
+
+/* Empty bare FAT32 volume, root directory in cluster 2 */
+static int format(void)
+{
+    unsigned char sector[SECTOR_SIZE];
+    unsigned int s;
+    FILE* out = fopen(IMAGE, "wb");
+
+    if(out == 0) return 0;
+
+    for(s = 0; s < SECTORS; s++)
+    {
+        memset(sector, 0, sizeof(sector));
+        if(s == 0)
+        {
+            sector[11] = SECTOR_SIZE & 0xFF; sector[12] = SECTOR_SIZE >> 8;
+            sector[13] = CLUSTER;
+            sector[14] = RESERVED;
+            sector[16] = 2;
+            sector[32] = SECTORS & 0xFF; sector[33] = (SECTORS >> 8) & 0xFF;
+            sector[34] = SECTORS >> 16;
+            sector[36] = FAT_SIZE;
+            sector[44] = 2;
+            memcpy(sector + 82, "FAT32   ", 8);
+            sector[510] = 0x55; sector[511] = 0xAA;
+        }
+        if(s == RESERVED || s == RESERVED + FAT_SIZE)
+        {
+            /* Media, reserved and the root directory's end of chain */
+            memset(sector, 0xFF, 12);
+            sector[0] = 0xF8;
+            sector[3] = sector[7] = sector[11] = 0x0F;
+        }
+        fwrite(sector, sizeof(sector), 1, out);
+    }
+
+    fclose(out);
+    return 1;
+}
+
+
+static int by_value(const void* a, const void* b)
+{
+    unsigned int x = *(const unsigned int*)a, y = *(const unsigned int*)b;
+    return (x > y) - (x < y);
+}
+
+/* Print the distribution, returns the 99th percentile */
+static unsigned int report(const char* name)
+{
+    static const unsigned int edges[] = { 1000, 1500, 2000, 3000, 5000, 10000 };
+    unsigned int sorted[APPENDS], count[7];
+    unsigned int i, b;
+
+    memset(count, 0, sizeof(count));
+    for(i = 0; i < APPENDS; i++)
+    {
+        for(b = 0; b < 6 && latency[i] >= edges[b]; b++);
+        count[b]++;
+    }
+
+    memcpy(sorted, latency, sizeof(sorted));
+    qsort(sorted, APPENDS, sizeof(sorted[0]), by_value);
+
+    printf("%8s %6u %6u %6u %6u %6u %6u %6u  %6u %6u %6u %6u  %6u\n", name,
+           count[0], count[1], count[2], count[3], count[4], count[5], count[6],
+           sorted[APPENDS / 2], sorted[APPENDS * 9 / 10], sorted[APPENDS * 99 / 100],
+           sorted[APPENDS - 1], sync_worst);
+
+    return sorted[APPENDS * 99 / 100];
+}
+
+
+/* Append APPENDS sectors, one timed call each */
+static void run(int stream)
+{
+    static char data[SECTOR_SIZE];
+    unsigned long long t0;
+    FAT32_File file;
+    unsigned int i;
+
+    sync_worst = 0;
+
+    if(stream)
+        CHECK_EQ(Fat32_Preallocate(&file, "stream.bin", APPENDS * SECTOR_SIZE), 1);
+    else
+        CHECK_EQ(Fat32_Open(&file, "plain.bin", FAT32_APPEND), 1);
+
+    SDModel_ResetStats();
+    for(i = 0; i < APPENDS; i++)
+    {
+        memset(data, i, sizeof(data));
+
+        t0 = Host_Ticks();
+        if(stream)
+            CHECK_EQ(Fat32_StreamAppend(&file, data), 1);
+        else
+            CHECK_EQ(Fat32_Write(&file, data, SECTOR_SIZE), SECTOR_SIZE);
+        latency[i] = (unsigned int)((Host_Ticks() - t0) / CORE_TICKS_US);
+
+        if((i + 1) % CHECKPOINT) continue;
+
+        /* A stream appends with one CMD24 and no metadata at all */
+        if(stream && i + 1 == CHECKPOINT)
+        {
+            CHECK_EQ(sdmodel_stats.commands[CMD24], CHECKPOINT);
+            CHECK_EQ(sdmodel_stats.commands[CMD25], 0);
+            CHECK_EQ(sdmodel_stats.commands[CMD17] + sdmodel_stats.commands[CMD18], 0);
+        }
+
+        t0 = Host_Ticks();
+        CHECK_EQ(Fat32_Sync(&file), 1);
+        t0 = (Host_Ticks() - t0) / CORE_TICKS_US;
+        if(t0 > sync_worst) sync_worst = (unsigned int)t0;
+    }
+
+    CHECK_EQ(file.size, APPENDS * SECTOR_SIZE);
+    CHECK_EQ(Fat32_Close(&file), 1);
+}
+
+
+int main(void)
+{
+    static char back[SECTOR_SIZE];
+    unsigned int stream_p99, plain_p99, stream_max, i;
+    FAT32_File file;
+
+    CHECK(format());
+    CHECK(SDModel_Open(IMAGE, SDMODEL_SDHC));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+    CHECK_EQ(Fat32_Mount(), 1);
+
+    printf("%u appends of one sector, Fat32_Sync every %u, latency in us\n", APPENDS, CHECKPOINT);
+    printf("%8s %6s %6s %6s %6s %6s %6s %6s  %6s %6s %6s %6s  %6s\n", "",
+           "<1000", "<1500", "<2000", "<3000", "<5000", "<10000", "more",
+           "p50", "p90", "p99", "max", "sync");
+
+    run(1);
+    stream_p99 = report("stream");
+    for(stream_max = 0, i = 0; i < APPENDS; i++)
+        if(latency[i] > stream_max) stream_max = latency[i];
+
+    run(0);
+    plain_p99 = report("plain");
+
+    /* Every stream append costs the same single CMD24 */
+    CHECK(stream_p99 <= plain_p99);
+    CHECK(stream_max < 2 * stream_p99);
+
+    /* Both files are intact after the close */
+    CHECK_EQ(Fat32_Open(&file, "stream.bin", FAT32_READ), 1);
+    CHECK_EQ(file.size, APPENDS * SECTOR_SIZE);
+    for(i = 0; i < APPENDS; i++)
+    {
+        CHECK_EQ(Fat32_Read(&file, back, SECTOR_SIZE), SECTOR_SIZE);
+        CHECK_EQ((unsigned char)back[SECTOR_SIZE - 1], i & 0xFF);
+    }
+    CHECK_EQ(Fat32_Open(&file, "plain.bin", FAT32_READ), 1);
+    CHECK_EQ(file.size, APPENDS * SECTOR_SIZE);
+
+    SDModel_Close();
+    remove(IMAGE);
+    return TEST_DONE();
+}
@@ -0,0 +1,89 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: Write throughput - CMD24 per sector vs CMD25 bursts, with and
+ *     without the ACMD23 pre-erase count
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include "pic32_sdcard.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#define BURST_MAX 64
+
+static char buffer[BURST_MAX * SECTOR_SIZE];
+
+/* Simulated microseconds to write count sectors at addr */
+static double run(int mode, unsigned int addr, unsigned int count)
+{
+    unsigned long long t0 = Host_Ticks();
+    unsigned int i;
+
+    if(mode == 0)
+    {
+        for(i = 0; i < count; i++)
+            CHECK_EQ(SDCard_WriteSector(addr + i, buffer + i * SECTOR_SIZE), 1);
+    }
+    else
+    {
+        CHECK_EQ(SDCard_WriteSectors(addr, count, buffer, mode == 2), 1);
+    }
+
+    return (double)(Host_Ticks() - t0) / CORE_TICKS_US;
+}
+
+
+int main(void)
+{
+    static const unsigned int bursts[] = { 1, 4, 16, 64 };
+    static const char* names[] = { "CMD24 x n", "CMD25", "CMD25+ACMD23" };
+    double us[3];
+    unsigned int b, n;
+    int mode, i;
+
+    for(i = 0; i < (int)sizeof(buffer); i++) buffer[i] = i * 13;
+
+    CHECK(SDModel_Init(SDMODEL_SDHC, 8192));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+
+    printf("SPI %u Hz, program %u us, block %u us, erase %u us\n",
+           SPI_GetClock(), sdmodel.program_us, sdmodel.block_us, sdmodel.erase_us);
+    printf("%8s %16s %12s %10s\n", "sectors", "mode", "ms", "KB/s");
+
+    for(b = 0; b < sizeof(bursts) / sizeof(bursts[0]); b++)
+    {
+        n = bursts[b];
+        for(mode = 0; mode < 3; mode++)
+        {
+            SDModel_ResetStats();
+            us[mode] = run(mode, 1000, n);
+            printf("%8u %16s %12.2f %10.1f\n", n, names[mode], us[mode] / 1000,
+                   n * SECTOR_SIZE / 1.024 / us[mode] * 1000);
+
+            CHECK_EQ(sdmodel_stats.blocks_written, n);
+            CHECK_EQ(sdmodel_stats.crc_errors, 0);
+            /* A burst of one falls back to CMD24 */
+            CHECK_EQ(sdmodel_stats.commands[CMD24], mode == 0 ? n : (n == 1));
+            CHECK_EQ(sdmodel_stats.commands[CMD25], mode != 0 && n > 1);
+            CHECK_EQ(sdmodel_stats.app_commands[23], mode == 2 && n > 1);
+        }
+
+        /* Telling the card the count up front wins from 4 sectors on,
+           a bare CMD25 only once the close busy is spread far enough */
+        if(n >= 4) CHECK(us[2] < us[1] && us[2] < us[0]);
+        if(n >= 16) CHECK(us[1] < us[0]);
+    }
+
+    /* Long pre-erased burst against sector by sector */
+    CHECK(us[0] / us[2] > 1.5);
+
+    SDModel_Close();
+    return TEST_DONE();
+}
@@ -0,0 +1,326 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host standing in for the PIC32MX795F512L
+ * SW: HAL_HOST backend - SPI2, card socket, LEDs, core timer
+ *
+ * Time is simulated. Every SPI byte moves the core timer on by its
+ * bus time at the current SPI2BRG, and every HAL call by a nominal
+ * CPU cost, so timeouts and benchmarks read in target time. SPI2 is
+ * wired to the SD card model.
+ *
+ * DMA channels 0/1 clock the whole transfer through the model when
+ * started but leave the CPU free: received bytes land in memory as
+ * their bus time passes, and the block done handler of pic32_sdcard.c
+ * is called from the first HAL call after the last byte, as long as
+ * interrupts are on.
+ *
+ *******************************************************************/
+
+#include "pic32_sdcard.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+
+/* Core timer ticks for one HAL call - a few M4K cycles of SFR access */
+#define CALL_TICKS 1
+
+/* Core timer ticks per PBCLK cycle */
+#define PB_TICKS ((SYS_FREQ / 2) / PB_FREQ)
+
+/* Longest DMA transfer */
+#define DMA_MAX 4096
+
+static unsigned long long ticks;
+static unsigned long spi_bytes;
+static unsigned int spi_brg;
+static unsigned char spi_rx;
+static int spi_full;
+static unsigned char leds;
+
+/* Shifter busy with a DMA transfer until spi_free */
+static unsigned long long spi_free;
+static unsigned long spi_overlaps;
+
+static int int_on, in_isr;
+
+static struct
+{
+    int active;
+    char* rx;                      /* 0 - write only */
+    int length, landed;
+    unsigned long long start, bt;  /* first byte clocked from start */
+    int rx_irq, tx_irq, pending;   /* IE bits, block done waiting */
+    unsigned long bytes;
+    unsigned char data[DMA_MAX];
+} dma;
+
+
+/* Move received bytes to memory as their time passes, then raise the
+ * block done interrupt */
+static void dma_service(void)
+{
+    int n;
+
+    if(dma.active)
+    {
+        n = (int)((ticks - dma.start) / dma.bt);
+        if(ticks < dma.start) n = 0;
+        if(n > dma.length) n = dma.length;
+        if(dma.rx)
+            for(; dma.landed < n; dma.landed++) dma.rx[dma.landed] = dma.data[dma.landed];
+        if(n == dma.length)
+        {
+            dma.active = 0;
+            dma.pending = 1;
+        }
+    }
+
+    if(!dma.pending || !int_on || in_isr) return;
+
+    in_isr = 1;
+    if(dma.rx && dma.rx_irq) SPI_DmaRxHandler();
+    else if(!dma.rx && dma.tx_irq) SPI_DmaTxHandler();
+    in_isr = 0;
+}
+
+
+static void advance(unsigned long long n)
+{
+    ticks += n;
+    dma_service();
+}
+
+
+static unsigned long long now_ns(void)
+{
+    return ticks * 1000 / CORE_TICKS_US;
+}
+
+
+/* 8 SPI clocks of 2*(SPI2BRG+1) PBCLK cycles */
+static unsigned long long byte_ticks(void)
+{
+    return 16ULL * (spi_brg + 1) * PB_TICKS;
+}
+
+
+void Host_Reset(void)
+{
+    ticks = 0;
+    spi_bytes = 0;
+    spi_brg = SPI_BRG_MAX;
+    spi_full = 0;
+    spi_free = 0;
+    spi_overlaps = 0;
+    int_on = in_isr = 0;
+    dma.active = dma.pending = 0;
+    dma.rx_irq = dma.tx_irq = 0;
+    dma.bytes = 0;
+    leds = 0;
+    SDModel_Select(0);
+}
+
+
+unsigned long long Host_Ticks(void)
+{
+    return ticks;
+}
+
+
+void Host_Advance(unsigned int us)
+{
+    advance((unsigned long long)us * CORE_TICKS_US);
+}
+
+
+unsigned long Host_SpiBytes(void)
+{
+    return spi_bytes;
+}
+
+
+unsigned long Host_DmaBytes(void)
+{
+    return dma.bytes;
+}
+
+
+unsigned long Host_SpiOverlaps(void)
+{
+    return spi_overlaps;
+}
+
+
+unsigned char Host_Leds(void)
+{
+    return leds;
+}
+
+
+/* SPI2 */
+void HAL_SpiPins(void)
+{
+}
+
+void HAL_SpiConfig(unsigned int brg, unsigned int con)
+{
+    spi_brg = brg;
+    spi_full = 0;
+    advance(CALL_TICKS);
+}
+
+void HAL_SpiPut(unsigned char c)
+{
+    /* SPI2BUF written under a running DMA transfer */
+    if(ticks < spi_free)
+    {
+        spi_overlaps++;
+        advance(spi_free - ticks);
+    }
+    advance(CALL_TICKS + byte_ticks());
+    spi_rx = SDModel_Exchange(c, now_ns());
+    spi_full = 1;
+    spi_bytes++;
+}
+
+int HAL_SpiRxFull(void)
+{
+    advance(CALL_TICKS);
+    return spi_full;
+}
+
+unsigned char HAL_SpiGet(void)
+{
+    advance(CALL_TICKS);
+    spi_full = 0;
+    return spi_rx;
+}
+
+
+void HAL_SpiFlush(void)
+{
+    advance(CALL_TICKS);
+    spi_full = 0;
+}
+
+void HAL_SpiDrain(void)
+{
+    if(ticks < spi_free) advance(spi_free - ticks);
+    HAL_SpiFlush();
+}
+
+
+/* Interrupts and DMA */
+void HAL_IntEnable(void)
+{
+    int_on = 1;
+    advance(CALL_TICKS);
+}
+
+void HAL_DmaOn(void)
+{
+    advance(CALL_TICKS);
+}
+
+void HAL_DmaRxStart(char* dst, int n)
+{
+    advance(CALL_TICKS);
+    dma.rx = dst;
+    dma.rx_irq = 1;
+}
+
+/* The channel pair runs from here - TX paces the clock */
+void HAL_DmaTxStart(char* src, int n, int irq)
+{
+    unsigned long long at;
+    unsigned char c;
+    int i;
+
+    advance(CALL_TICKS);
+    if(n > DMA_MAX) n = DMA_MAX;
+
+    dma.start = ticks > spi_free ? ticks : spi_free;
+    dma.bt = byte_ticks();
+    dma.length = n;
+    dma.landed = 0;
+    dma.tx_irq = irq;
+    if(irq) dma.rx = 0;
+
+    for(i = 0; i < n; i++)
+    {
+        at = dma.start + (i + 1) * dma.bt;
+        c = SDModel_Exchange(src[i], at * 1000 / CORE_TICKS_US);
+        dma.data[i] = c;
+    }
+
+    spi_bytes += n;
+    dma.bytes += n;
+    spi_free = dma.start + n * dma.bt;
+    spi_rx = dma.data[n - 1];
+    spi_full = 1;
+    dma.active = 1;
+    dma.pending = 0;
+}
+
+void HAL_DmaRxAck(void)
+{
+    dma.rx_irq = 0;
+    dma.pending = 0;
+}
+
+void HAL_DmaTxAck(void)
+{
+    dma.tx_irq = 0;
+    dma.pending = 0;
+}
+
+void HAL_DmaIdle(void)
+{
+    advance(CALL_TICKS);
+}
+
+
+/* SD Card socket - CS is active low, card always present */
+void HAL_CardPins(void)
+{
+}
+
+void HAL_CardSelect(int v)
+{
+    advance(CALL_TICKS);
+    SDModel_Select(!v);
+}
+
+void HAL_CardWriteProtect(int v)
+{
+}
+
+int HAL_CardDetect(void)
+{
+    return 0;
+}
+
+
+/* LEDs */
+void HAL_LedPins(void)
+{
+}
+
+void HAL_Led(int n, int v)
+{
+    if(v) leds |= 1 << n;
+    else leds &= ~(1 << n);
+}
+
+void HAL_LedWrite(unsigned char v)
+{
+    leds = v;
+}
+
+
+/* Core timer */
+unsigned int HAL_TimerRead(void)
+{
+    advance(CALL_TICKS);
+    return (unsigned int)ticks;
+}
@@ -0,0 +1,39 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Controls of the simulated PIC32 for tests and benchmarks
+ *
+ *******************************************************************/
+#ifndef HOST_PIC32_H
+#define	HOST_PIC32_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+/* Core timer back to 0, SPI off, card deselected */
+void Host_Reset(void);
+
+/* Simulated time in core timer ticks (CORE_TICKS_US per us), no wrap */
+unsigned long long Host_Ticks(void);
+
+/* Let time pass without touching the bus - stands in for other work */
+void Host_Advance(unsigned int us);
+
+/* Bytes clocked over SPI2 since Host_Reset */
+unsigned long Host_SpiBytes(void);
+
+/* Bytes moved by DMA channels 0/1, and SPI2BUF writes that landed on
+ * top of a running DMA transfer (a driver bug) */
+unsigned long Host_DmaBytes(void);
+unsigned long Host_SpiOverlaps(void);
+
+/* LED port as last written */
+unsigned char Host_Leds(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* HOST_PIC32_H */
@@ -0,0 +1,30 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Checks shared by the host tests and benchmarks
+ *
+ * A failed CHECK prints where and carries on, TEST_DONE() turns the
+ * count into the exit status CTest looks at.
+ *
+ *******************************************************************/
+#ifndef HOST_TEST_H
+#define	HOST_TEST_H
+
+#include <stdio.h>
+
+static int test_failures;
+
+#define CHECK(cond) \
+    do { if(!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+                       test_failures++; } } while(0)
+
+#define CHECK_EQ(a, b) \
+    do { long long a_ = (long long)(a), b_ = (long long)(b); \
+         if(a_ != b_) { printf("%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #a, a_, b_); \
+                        test_failures++; } } while(0)
+
+#define TEST_DONE() \
+    (test_failures ? (printf("%d check(s) failed\n", test_failures), 1) : (printf("ok\n"), 0))
+
+#endif	/* HOST_TEST_H */
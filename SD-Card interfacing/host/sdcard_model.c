@@ -0,0 +1,644 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Behavioral SD card model on the SPI bus
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdcard_model.h"
+
+#define BLOCK 512
+#define NS_US 1000ULL
+
+/* R1 bits */
+#define R1_IDLE     0x01
+#define R1_ILLEGAL  0x04
+#define R1_CRC      0x08
+#define R1_ADDRESS  0x20
+#define R1_PARAM    0x40
+
+/* Data error token - out of range */
+#define TOKEN_RANGE 0x08
+
+/* Data phase */
+#define IDLE      0
+#define READ_ONE  1
+#define READ_MANY 2
+#define READ_CSD  3
+#define WRITE_ONE 4
+#define WRITE_MANY 5
+
+SDModel_Config sdmodel;
+SDModel_Stats sdmodel_stats;
+
+static struct
+{
+    int present;
+    int type;
+    unsigned int sectors;
+    char* ram;
+    FILE* image;
+
+    int spi;                    /* CMD0 seen - SPI mode */
+    int idle;
+    int app;                    /* last command was CMD55 */
+    int crc_on;
+    int selected;
+    long long init_start;       /* first ACMD41, -1 none */
+    unsigned int pre_erase;     /* ACMD23 count for the next CMD25 */
+
+    unsigned char cmd[6];
+    int cmd_len;
+
+    unsigned char out[BLOCK + 8];
+    int out_len;
+    int out_pos;
+    int out_block;              /* out holds a streamed data block */
+    long out_lba;               /* sector in out, -1 for the CSD */
+
+    int phase;
+    unsigned int lba;
+    unsigned long long ready_ns;
+    unsigned long long busy_until;
+    int stream_dead;            /* CMD18 stream stopped by an error token */
+
+    int receiving;              /* write data after the token */
+    unsigned char wbuf[BLOCK + 2];
+    int wlen;
+    unsigned int burst;         /* blocks written in this CMD25 */
+} card;
+
+/* Block trace, kept across cards */
+static FILE* trace;
+
+
+/* Bit-serial CRCs - kept apart from sd_crc.c so the model checks it */
+static unsigned char crc7(const unsigned char* data, int length)
+{
+    unsigned char crc = 0;
+    int i, bit;
+
+    for(i = 0; i < length; i++)
+    {
+        for(bit = 7; bit >= 0; bit--)
+        {
+            crc <<= 1;
+            if(((data[i] >> bit) ^ (crc >> 7)) & 1) crc ^= 0x09;
+        }
+    }
+    return ((crc & 0x7F) << 1) | 1;
+}
+
+static unsigned short crc16(const unsigned char* data, int length)
+{
+    unsigned short crc = 0;
+    int i, bit;
+
+    for(i = 0; i < length; i++)
+    {
+        crc ^= data[i] << 8;
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+
+static void defaults(void)
+{
+    sdmodel.init_us = 20000;
+    sdmodel.access_us = 400;
+    sdmodel.next_us = 40;
+    sdmodel.program_us = 1500;
+    sdmodel.block_us = 250;
+    sdmodel.erase_us = 900;
+    sdmodel.close_us = 1500;
+    sdmodel.stop_us = 20;
+    sdmodel.ncr = 1;
+    sdmodel.stuff = 0x7F;
+    sdmodel.mute_cmd = -1;
+    sdmodel.fail_read = -1;
+    sdmodel.corrupt_read = -1;
+}
+
+
+static void power_up(int type, unsigned int sectors)
+{
+    memset(&card, 0, sizeof(card));
+    card.present = 1;
+    card.type = type;
+    card.sectors = sectors;
+    card.init_start = -1;
+    defaults();
+    SDModel_ResetStats();
+}
+
+
+static int fits(int type, unsigned int sectors)
+{
+    if(sectors == 0) return 0;
+    if(type == SDMODEL_SDHC) return (sectors % 1024) == 0;
+    return (sectors % 512) == 0 && sectors <= 4096 * 512;
+}
+
+
+int SDModel_Init(int type, unsigned int sectors)
+{
+    SDModel_Close();
+    if(!fits(type, sectors)) return 0;
+
+    power_up(type, sectors);
+    card.ram = calloc(sectors, BLOCK);
+    return card.ram != 0;
+}
+
+
+int SDModel_Open(const char* path, int type)
+{
+    FILE* f;
+    long size;
+    unsigned int sectors;
+
+    SDModel_Close();
+
+    f = fopen(path, "r+b");
+    if(f == 0) return 0;
+
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    sectors = (unsigned int)(size / BLOCK);
+    sectors -= sectors % (type == SDMODEL_SDHC ? 1024 : 512);
+    if(!fits(type, sectors))
+    {
+        fclose(f);
+        return 0;
+    }
+
+    power_up(type, sectors);
+    card.image = f;
+    return 1;
+}
+
+
+void SDModel_Close(void)
+{
+    if(card.image) fclose(card.image);
+    free(card.ram);
+    memset(&card, 0, sizeof(card));
+}
+
+
+unsigned int SDModel_Sectors(void)
+{
+    return card.sectors;
+}
+
+
+void SDModel_ResetStats(void)
+{
+    memset(&sdmodel_stats, 0, sizeof(sdmodel_stats));
+}
+
+
+void SDModel_Trace(FILE* out)
+{
+    trace = out;
+}
+
+
+void SDModel_Read(unsigned int sector, char* buffer)
+{
+    if(card.image)
+    {
+        fseek(card.image, (long)sector * BLOCK, SEEK_SET);
+        if(fread(buffer, 1, BLOCK, card.image) != BLOCK) memset(buffer, 0, BLOCK);
+    }
+    else
+    {
+        memcpy(buffer, card.ram + (size_t)sector * BLOCK, BLOCK);
+    }
+}
+
+
+void SDModel_Write(unsigned int sector, const char* buffer)
+{
+    if(card.image)
+    {
+        fseek(card.image, (long)sector * BLOCK, SEEK_SET);
+        fwrite(buffer, 1, BLOCK, card.image);
+        fflush(card.image);
+    }
+    else
+    {
+        memcpy(card.ram + (size_t)sector * BLOCK, buffer, BLOCK);
+    }
+}
+
+
+void SDModel_Select(int selected)
+{
+    card.selected = selected;
+}
+
+
+/* Queue a response behind the Ncr gap */
+static void respond(const unsigned char* bytes, int n)
+{
+    int i;
+
+    card.out_len = card.out_pos = 0;
+    card.out_block = 0;
+    for(i = 0; i < sdmodel.ncr; i++) card.out[card.out_len++] = 0xFF;
+    for(i = 0; i < n; i++) card.out[card.out_len++] = bytes[i];
+}
+
+static void respond_r1(unsigned char r1)
+{
+    respond(&r1, 1);
+}
+
+
+/* Build the CSD matching the capacity */
+static void csd(unsigned char* reg)
+{
+    unsigned int c_size;
+
+    memset(reg, 0, 16);
+    reg[5] = 0x59;                          /* CCC, READ_BL_LEN = 9 */
+    if(card.type == SDMODEL_SDHC)
+    {
+        reg[0] = 0x40;
+        c_size = card.sectors / 1024 - 1;
+        reg[7] = (c_size >> 16) & 0x3F;
+        reg[8] = c_size >> 8;
+        reg[9] = c_size;
+    }
+    else
+    {
+        /* C_SIZE_MULT = 7: (C_SIZE+1) * 512 blocks */
+        c_size = card.sectors / 512 - 1;
+        reg[6] = (c_size >> 10) & 0x03;
+        reg[7] = c_size >> 2;
+        reg[8] = (c_size & 0x03) << 6;
+        reg[9] = 0x03;
+        reg[10] = 0x80;
+    }
+    reg[15] = crc7(reg, 15);
+}
+
+
+/* Next data block of a read into out, or an error token */
+static void load_block(void)
+{
+    unsigned char data[BLOCK];
+    unsigned short crc;
+    int n = BLOCK;
+
+    card.out_len = card.out_pos = 0;
+    card.out_block = 1;
+
+    card.out_lba = card.lba;
+
+    if(card.phase == READ_CSD)
+    {
+        csd(data);
+        n = 16;
+        card.out_lba = -1;
+    }
+    else if(card.lba >= card.sectors || (long)card.lba == sdmodel.fail_read)
+    {
+        card.out[card.out_len++] = TOKEN_RANGE;
+        card.out_block = 0;
+        card.stream_dead = 1;
+        card.phase = IDLE;
+        return;
+    }
+    else
+    {
+        SDModel_Read(card.lba, (char*)data);
+        sdmodel_stats.blocks_read++;
+    }
+
+    crc = crc16(data, n);
+    if((long)card.lba == sdmodel.corrupt_read && card.phase != READ_CSD) crc ^= 0x0001;
+
+    card.out[card.out_len++] = 0xFE;
+    memcpy(card.out + card.out_len, data, n);
+    card.out_len += n;
+    card.out[card.out_len++] = crc >> 8;
+    card.out[card.out_len++] = crc & 0xFF;
+
+    if(card.phase == READ_MANY) card.lba++;
+    else card.phase = IDLE;
+}
+
+
+/* Sector from the command argument, 0 and the R1 bits if unusable */
+static int address(unsigned int arg, unsigned int* lba, unsigned char* r1)
+{
+    if(card.type == SDMODEL_SDHC)
+    {
+        *lba = arg;
+    }
+    else
+    {
+        if(arg % BLOCK)
+        {
+            *r1 |= R1_ADDRESS;
+            return 0;
+        }
+        *lba = arg / BLOCK;
+    }
+    if(*lba >= card.sectors)
+    {
+        *r1 |= R1_PARAM;
+        return 0;
+    }
+    return 1;
+}
+
+
+static void busy(unsigned long long now_ns, unsigned int us)
+{
+    card.busy_until = now_ns + us * NS_US;
+    sdmodel_stats.busy_ns += us * NS_US;
+}
+
+
+static void command(unsigned long long now_ns)
+{
+    unsigned char index = card.cmd[0] & 0x3F, r[5];
+    unsigned int arg = ((unsigned int)card.cmd[1] << 24) | (card.cmd[2] << 16) |
+                       (card.cmd[3] << 8) | card.cmd[4];
+    unsigned int ocr;
+    int app = card.app;
+    int i;
+
+    card.app = 0;
+    if(app) sdmodel_stats.app_commands[index]++;
+    else sdmodel_stats.commands[index]++;
+
+    if(index == sdmodel.mute_cmd && !app) return;
+
+    /* Native mode until a CMD0 with CS low */
+    if(!card.spi)
+    {
+        if(index != 0) return;
+        card.spi = 1;
+    }
+
+    r[0] = card.idle ? R1_IDLE : 0;
+
+    /* CMD0 and CMD8 are always checked, the rest after CMD59 */
+    if((card.crc_on || index == 0 || index == 8) && crc7(card.cmd, 5) != card.cmd[5])
+    {
+        sdmodel_stats.crc_errors++;
+        respond_r1(r[0] | R1_CRC);
+        return;
+    }
+
+    if(app)
+    {
+        switch(index)
+        {
+        case 41:
+            if(card.init_start < 0) card.init_start = now_ns;
+            /* SDHC stays idle until the host says it can take it */
+            if((card.type != SDMODEL_SDHC || (arg & 0x40000000)) &&
+               now_ns - card.init_start >= sdmodel.init_us * NS_US)
+            {
+                card.idle = 0;
+            }
+            respond_r1(card.idle ? R1_IDLE : 0);
+            return;
+        case 23:
+            card.pre_erase = arg & 0x7FFFFF;
+            respond_r1(r[0]);
+            return;
+        }
+    }
+
+    switch(index)
+    {
+    case 0:
+        card.idle = 1;
+        card.crc_on = 0;
+        card.phase = IDLE;
+        card.receiving = 0;
+        card.stream_dead = 0;
+        card.init_start = -1;
+        respond_r1(R1_IDLE);
+        return;
+
+    case 8:
+        if(card.type == SDMODEL_SDSC_V1)
+        {
+            respond_r1(r[0] | R1_ILLEGAL);
+            return;
+        }
+        r[1] = 0;
+        r[2] = 0;
+        r[3] = (arg >> 8) & 0x0F;
+        r[4] = arg & 0xFF;
+        respond(r, 5);
+        return;
+
+    case 55:
+        card.app = 1;
+        respond_r1(r[0]);
+        return;
+
+    case 58:
+        ocr = 0x00FF8000;
+        if(!card.idle) ocr |= 0x80000000;
+        if(!card.idle && card.type == SDMODEL_SDHC) ocr |= 0x40000000;
+        r[1] = ocr >> 24;
+        r[2] = ocr >> 16;
+        r[3] = ocr >> 8;
+        r[4] = ocr;
+        respond(r, 5);
+        return;
+
+    case 59:
+        card.crc_on = arg & 1;
+        respond_r1(r[0]);
+        return;
+
+    case 16:
+        if(card.type != SDMODEL_SDHC && arg != BLOCK) r[0] |= R1_PARAM;
+        respond_r1(r[0]);
+        return;
+
+    case 12:
+        /* Stuff byte, then the usual Ncr gap, R1 and a short busy */
+        card.phase = IDLE;
+        card.stream_dead = 0;
+        card.out_len = card.out_pos = 0;
+        card.out_block = 0;
+        card.out[card.out_len++] = sdmodel.stuff;
+        for(i = 0; i < sdmodel.ncr; i++) card.out[card.out_len++] = 0xFF;
+        card.out[card.out_len++] = r[0];
+        busy(now_ns, sdmodel.stop_us);
+        return;
+
+    case 9:
+    case 17:
+    case 18:
+    case 24:
+    case 25:
+        if(card.idle)
+        {
+            respond_r1(r[0] | R1_ILLEGAL);
+            return;
+        }
+        if(index != 9 && !address(arg, &card.lba, &r[0]))
+        {
+            sdmodel_stats.rejected++;
+            respond_r1(r[0]);
+            return;
+        }
+        respond_r1(r[0]);
+        card.ready_ns = now_ns + sdmodel.access_us * NS_US;
+        card.stream_dead = 0;
+        card.burst = 0;
+        card.receiving = 0;
+        if(index == 9) card.phase = READ_CSD;
+        else if(index == 17) card.phase = READ_ONE;
+        else if(index == 18) card.phase = READ_MANY;
+        else if(index == 24) card.phase = WRITE_ONE;
+        else card.phase = WRITE_MANY;
+        return;
+    }
+
+    sdmodel_stats.rejected++;
+    respond_r1(r[0] | R1_ILLEGAL);
+}
+
+
+/* Data block fully received - answer and go busy */
+static void block_done(unsigned long long now_ns)
+{
+    unsigned short crc = (card.wbuf[BLOCK] << 8) | card.wbuf[BLOCK + 1];
+    unsigned char response;
+    unsigned int us;
+
+    card.receiving = 0;
+
+    if(card.crc_on && crc != crc16(card.wbuf, BLOCK))
+    {
+        sdmodel_stats.crc_errors++;
+        response = 0x0B;
+    }
+    else if(card.lba >= card.sectors)
+    {
+        sdmodel_stats.rejected++;
+        response = 0x0D;
+    }
+    else
+    {
+        SDModel_Write(card.lba, (const char*)card.wbuf);
+        sdmodel_stats.blocks_written++;
+        if(trace) fprintf(trace, "W %u\n", card.lba);
+        response = 0x05;
+    }
+
+    card.out_len = card.out_pos = 0;
+    card.out_block = 0;
+    card.out[card.out_len++] = response | 0xE0;
+
+    if(card.phase == WRITE_ONE)
+    {
+        card.phase = IDLE;
+        busy(now_ns, sdmodel.program_us);
+        return;
+    }
+
+    us = sdmodel.block_us;
+    if(card.burst >= card.pre_erase) us += sdmodel.erase_us;
+    busy(now_ns, us);
+    card.burst++;
+    card.lba++;
+}
+
+
+unsigned char SDModel_Exchange(unsigned char mosi, unsigned long long now_ns)
+{
+    unsigned char miso = 0xFF;
+
+    if(!card.present || !card.selected) return 0xFF;
+
+    /* MISO - what the card had lined up for this byte */
+    if(card.out_pos < card.out_len)
+    {
+        miso = card.out[card.out_pos++];
+        if(card.out_pos == card.out_len && card.out_block && card.phase == READ_MANY)
+        {
+            card.ready_ns = now_ns + sdmodel.next_us * NS_US;
+        }
+
+        /* Traced once the host has the whole block */
+        if(card.out_pos == card.out_len && card.out_block && card.out_lba >= 0 && trace)
+        {
+            fprintf(trace, "R %ld\n", card.out_lba);
+        }
+    }
+    else if((card.phase == READ_ONE || card.phase == READ_MANY || card.phase == READ_CSD) &&
+            now_ns >= card.ready_ns)
+    {
+        load_block();
+        miso = card.out[card.out_pos++];
+    }
+    else if(now_ns < card.busy_until)
+    {
+        miso = 0x00;
+    }
+
+    /* MOSI - write data, tokens, commands */
+    if(card.receiving)
+    {
+        card.wbuf[card.wlen++] = mosi;
+        if(card.wlen == BLOCK + 2) block_done(now_ns);
+        return miso;
+    }
+
+    if((card.phase == WRITE_ONE || card.phase == WRITE_MANY) && card.cmd_len == 0 &&
+       now_ns >= card.busy_until)
+    {
+        if((mosi == 0xFE && card.phase == WRITE_ONE) ||
+           (mosi == 0xFC && card.phase == WRITE_MANY))
+        {
+            card.receiving = 1;
+            card.wlen = 0;
+            return miso;
+        }
+        if(mosi == 0xFD && card.phase == WRITE_MANY)
+        {
+            card.phase = IDLE;
+            card.pre_erase = 0;
+            busy(now_ns, sdmodel.close_us);
+            return miso;
+        }
+    }
+
+    if(card.cmd_len == 0)
+    {
+        if((mosi & 0xC0) == 0x40) card.cmd[card.cmd_len++] = mosi;
+    }
+    else
+    {
+        card.cmd[card.cmd_len++] = mosi;
+        if(card.cmd_len == 6)
+        {
+            card.cmd_len = 0;
+            command(now_ns);
+        }
+    }
+
+    return miso;
+}
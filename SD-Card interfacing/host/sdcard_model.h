@@ -0,0 +1,91 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: Behavioral SD card model on the SPI bus
+ *
+ * Byte level model of an SD card in SPI mode: CMD0/8/9/12/16/17/18/
+ * 24/25/55/58/59, ACMD23/41, R1/R3/R7 responses, data tokens, CRC7/
+ * CRC16 checking once CMD59 turns it on and busy signalling. Time is
+ * passed in by the caller (simulated ns), so the access, programming
+ * and busy times below are seen by the driver as they would be on
+ * the wire. Storage is RAM or an image file.
+ *
+ *******************************************************************/
+#ifndef SDCARD_MODEL_H
+#define	SDCARD_MODEL_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+
+/* Card classes - same numbers as SD_TYPE_* */
+#define SDMODEL_SDSC_V1 1
+#define SDMODEL_SDSC_V2 2
+#define SDMODEL_SDHC    3
+
+/* Behaviour - SDModel_Init/Open load the defaults, tests adjust */
+typedef struct
+{
+    unsigned int init_us;      /* ACMD41 reports idle this long */
+    unsigned int access_us;    /* CMD17/CMD18 first block, CMD9 */
+    unsigned int next_us;      /* CMD18 gap between blocks */
+    unsigned int program_us;   /* CMD24 busy */
+    unsigned int block_us;     /* CMD25 busy per block, pre-erased */
+    unsigned int erase_us;     /* CMD25 extra per block not covered by ACMD23 */
+    unsigned int close_us;     /* CMD25 busy after the stop token */
+    unsigned int stop_us;      /* CMD12 busy */
+    unsigned char ncr;         /* 0xFF bytes ahead of a response, 1-8 */
+    unsigned char stuff;       /* byte clocked out right after CMD12 */
+    int mute_cmd;              /* command left unanswered, -1 none */
+    long fail_read;            /* sector answered with an error token, -1 none */
+    long corrupt_read;         /* sector sent with a bad CRC16, -1 none */
+} SDModel_Config;
+
+/* Counters - cleared by SDModel_Init/Open and SDModel_ResetStats */
+typedef struct
+{
+    unsigned int commands[64];
+    unsigned int app_commands[64];
+    unsigned int blocks_read;
+    unsigned int blocks_written;
+    unsigned int crc_errors;
+    unsigned int rejected;     /* illegal, out of range, misaligned */
+    unsigned long long busy_ns;
+} SDModel_Stats;
+
+extern SDModel_Config sdmodel;
+extern SDModel_Stats sdmodel_stats;
+
+/* RAM card of the given class, sectors must fit the CSD encoding
+ * (multiple of 1024 for SDHC, of 512 up to 2M for SDSC) */
+int SDModel_Init(int type, unsigned int sectors);
+
+/* Card backed by an image file, its size rounded down as above */
+int SDModel_Open(const char* path, int type);
+
+/* Remove the card - it no longer answers */
+void SDModel_Close(void);
+
+/* Bus side - chip select level and one full duplex byte */
+void SDModel_Select(int selected);
+unsigned char SDModel_Exchange(unsigned char mosi, unsigned long long now_ns);
+
+/* Back door to the storage for test setup and checks */
+void SDModel_Read(unsigned int sector, char* buffer);
+void SDModel_Write(unsigned int sector, const char* buffer);
+unsigned int SDModel_Sectors(void);
+
+void SDModel_ResetStats(void);
+
+/* Log every block the host reads or writes in full as "R <sector>" /
+ * "W <sector>" lines, 0 stops - the traces bench_sd_cache replays */
+void SDModel_Trace(FILE* out);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SDCARD_MODEL_H */
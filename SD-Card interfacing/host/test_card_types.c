@@ -0,0 +1,72 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: SDCard_Init against v1, v2 and SDHC cards and a card that
+ *     leaves CMD8 or everything unanswered
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "pic32_sdcard.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+static void power_up(int model, unsigned int sectors)
+{
+    CHECK(SDModel_Init(model, sectors));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+}
+
+/* Init must pick the type, addressing and size, then move data */
+static void card(int model, unsigned int sectors, int type, int block_addressing)
+{
+    char out[SECTOR_SIZE], in[SECTOR_SIZE];
+    int i;
+
+    power_up(model, sectors);
+    CHECK_EQ(SDCard_Init(), 0);
+    CHECK_EQ(SDCard.type, type);
+    CHECK_EQ(SDCard.block_addressing, block_addressing);
+    CHECK_EQ(SDCard.sectors, sectors);
+
+    /* OCR only asked of v2 cards, block length only set when byte addressed */
+    CHECK_EQ(sdmodel_stats.commands[CMD58], type != SD_TYPE_SDSC_V1);
+    CHECK_EQ(sdmodel_stats.commands[CMD16], !block_addressing);
+
+    /* Last sector - checks the address scaling end to end */
+    for(i = 0; i < SECTOR_SIZE; i++) out[i] = i ^ type;
+    CHECK_EQ(SDCard_WriteSector(sectors - 1, out), 1);
+    CHECK_EQ(SDCard_ReadSector(sectors - 1, in), 1);
+    CHECK(memcmp(in, out, SECTOR_SIZE) == 0);
+    SDModel_Read(sectors - 1, in);
+    CHECK(memcmp(in, out, SECTOR_SIZE) == 0);
+    CHECK_EQ(sdmodel_stats.rejected, 0);
+}
+
+
+int main(void)
+{
+    card(SDMODEL_SDSC_V1, 4096, SD_TYPE_SDSC_V1, 0);
+    card(SDMODEL_SDSC_V2, 8192, SD_TYPE_SDSC_V2, 0);
+    card(SDMODEL_SDHC, 16384, SD_TYPE_SDHC, 1);
+
+    /* CMD8 never answered - 0xFF has the illegal command bit set but
+       must not pass for a v1 card */
+    power_up(SDMODEL_SDHC, 8192);
+    sdmodel.mute_cmd = CMD8;
+    CHECK_EQ(SDCard_Init(), ERROR_VLTG);
+    CHECK_EQ(sdmodel_stats.app_commands[ACMD41], 0);
+
+    /* Nothing in the socket answers */
+    power_up(SDMODEL_SDHC, 8192);
+    sdmodel.mute_cmd = CMD0;
+    CHECK_EQ(SDCard_Init(), ERROR_RESET);
+    CHECK_EQ(sdmodel_stats.commands[CMD8], 0);
+
+    SDModel_Close();
+    return TEST_DONE();
+}
@@ -0,0 +1,60 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host
+ * SW: CRC7/CRC16 known vectors, table and bit-serial kernels alike
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "sd_crc.h"
+#include "host_test.h"
+
+/* sd_crc.c built with SD_CRC_SMALL */
+unsigned char SD_Crc7_Small(const unsigned char* data, int length);
+unsigned short SD_Crc16_Small(const char* data, int length, unsigned short crc);
+
+static const unsigned char cmd0[5]  = { 0x40, 0x00, 0x00, 0x00, 0x00 };
+static const unsigned char cmd8[5]  = { 0x48, 0x00, 0x00, 0x01, 0xAA };
+static const unsigned char cmd17[5] = { 0x51, 0x00, 0x00, 0x00, 0x00 };
+static const unsigned char cmd55[5] = { 0x77, 0x00, 0x00, 0x00, 0x00 };
+
+
+int main(void)
+{
+    char block[512];
+    unsigned int seed = 1;
+    int i, n;
+
+    /* Command CRC bytes from the SD spec, end bit included */
+    CHECK_EQ(SD_Crc7(cmd0, 5), 0x95);
+    CHECK_EQ(SD_Crc7(cmd8, 5), 0x87);
+    CHECK_EQ(SD_Crc7(cmd17, 5), 0x55);
+    CHECK_EQ(SD_Crc7(cmd55, 5), 0x65);
+    CHECK_EQ(SD_Crc7_Small(cmd0, 5), 0x95);
+    CHECK_EQ(SD_Crc7_Small(cmd8, 5), 0x87);
+
+    /* 512 bytes of 0xFF - the spec's data block example */
+    memset(block, 0xFF, sizeof(block));
+    CHECK_EQ(SD_Crc16(block, 512, 0), 0x7FA1);
+    CHECK_EQ(SD_Crc16_Small(block, 512, 0), 0x7FA1);
+
+    /* CRC16-CCITT/XMODEM check value */
+    CHECK_EQ(SD_Crc16("123456789", 9, 0), 0x31C3);
+    CHECK_EQ(SD_Crc16(block, 0, 0x1234), 0x1234);
+
+    /* Both kernels agree on anything, in one go or in pieces */
+    for(n = 0; n < 64; n++)
+    {
+        for(i = 0; i < 512; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            block[i] = seed >> 16;
+        }
+        CHECK_EQ(SD_Crc16(block, 512, 0), SD_Crc16_Small(block, 512, 0));
+        CHECK_EQ(SD_Crc16(block + n, 512 - n, SD_Crc16(block, n, 0)), SD_Crc16(block, 512, 0));
+        CHECK_EQ(SD_Crc7((unsigned char*)block, 5 + n), SD_Crc7_Small((unsigned char*)block, 5 + n));
+    }
+
+    return TEST_DONE();
+}
@@ -0,0 +1,84 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: Core timer waits - no shorter and not much longer than asked,
+ *     timeouts across the counter wrap, init time
+ *
+ *******************************************************************/
+
+#include "pic32_sdcard.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+/* A wait may overrun by the timer reads around it */
+#define SLACK 4
+
+static unsigned long long since(unsigned long long t0)
+{
+    return Host_Ticks() - t0;
+}
+
+
+int main(void)
+{
+    static const unsigned int waits[] = { 1, 2, 10, 100, 1000, 54321 };
+    unsigned long long t0, t;
+    unsigned int i, start;
+
+    Host_Reset();
+
+    for(i = 0; i < sizeof(waits) / sizeof(waits[0]); i++)
+    {
+        t0 = Host_Ticks();
+        delay_us(waits[i]);
+        t = since(t0);
+        CHECK(t >= waits[i] * CORE_TICKS_US);
+        CHECK(t <= waits[i] * CORE_TICKS_US + SLACK);
+    }
+
+    t0 = Host_Ticks();
+    delay_ms(25);
+    t = since(t0);
+    CHECK(t >= 25 * CORE_TICKS_MS);
+    CHECK(t <= 25 * CORE_TICKS_MS + 25 * SLACK);
+
+    t0 = Host_Ticks();
+    delay_seconds(2);
+    CHECK(since(t0) >= 2000ULL * CORE_TICKS_MS);
+    CHECK(since(t0) <= 2000ULL * CORE_TICKS_MS + 2000 * SLACK);
+
+    /* Timeout fires on the millisecond, not before */
+    start = Timeout_Start();
+    Host_Advance(9990);
+    CHECK(!Timeout_Expired(start, 10));
+    Host_Advance(10);
+    CHECK(Timeout_Expired(start, 10));
+
+    /* Same across the 32-bit wrap of the core timer */
+    Host_Advance((unsigned int)((0x100000000ULL - (Host_Ticks() & 0xFFFFFFFF)) / CORE_TICKS_US) - 500);
+    start = Timeout_Start();
+    Host_Advance(900);
+    CHECK(((Host_Ticks() >> 32) & 1) == 1);
+    CHECK(!Timeout_Expired(start, 1));
+    Host_Advance(100);
+    CHECK(Timeout_Expired(start, 1));
+    CHECK(!Timeout_Expired(start, 2));
+
+    /* Card start up - the 1ms power up wait, ACMD41 until the card
+       leaves idle, nothing else of note */
+    CHECK(SDModel_Init(SDMODEL_SDHC, 8192));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    t0 = Host_Ticks();
+    CHECK_EQ(SDCard_Init(), 0);
+    t = since(t0) / CORE_TICKS_US;
+    printf("SDCard_Init %llu us, card busy %u us\n", t, sdmodel.init_us);
+    CHECK(t >= 1000 + sdmodel.init_us);
+    CHECK(t <= 1000 + sdmodel.init_us + 3000);
+
+    SDModel_Close();
+    return TEST_DONE();
+}
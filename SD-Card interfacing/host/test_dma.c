@@ -0,0 +1,120 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: SPI2 DMA - buffer handling, completion flag/callback, sectors
+ *     over DMA with the CPU handed to SPI_DmaWaitHook
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "pic32_sdcard.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+static int callbacks;
+static unsigned long hooks, hooks_busy;
+
+static void done(void)
+{
+    callbacks++;
+}
+
+static void hook(void)
+{
+    hooks++;
+    if(SPI_DmaBusy()) hooks_busy++;
+}
+
+
+int main(void)
+{
+    char buffer[SECTOR_SIZE], back[SECTOR_SIZE];
+    unsigned long bytes;
+    int i, zeros;
+
+    CHECK(SDModel_Init(SDMODEL_SDHC, 8192));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+
+    /* Out of range asks clamp to the slowest and fastest rates */
+    CHECK_EQ(SPI_SetClock(0), PB_FREQ / (2 * (SPI_BRG_MAX + 1)));
+    CHECK_EQ(SPI_SetClock(0xFFFFFFFF), PB_FREQ / 2);
+    CHECK_EQ(SPI_SetClock(SPI_CLOCK_DATA), 4000000);
+
+    /* Read - buffer is the 0xFF source, bytes land as they arrive and
+       the flag and callback follow the last one. Card deselected, so
+       it all reads back 0xFF */
+    memset(buffer, 0x55, sizeof(buffer));
+    SPI_DmaRead(buffer, 64, done);
+    CHECK(SPI_DmaBusy());
+    CHECK_EQ(SPI_DmaDone, 0);
+    CHECK_EQ((unsigned char)buffer[63], 0xFF);
+    CHECK_EQ(buffer[64], 0x55);
+    Host_Advance(20);
+    CHECK(SPI_DmaBusy());
+    CHECK_EQ(callbacks, 0);
+    Host_Advance(200);
+    CHECK(!SPI_DmaBusy());
+    CHECK_EQ(SPI_DmaDone, 1);
+    CHECK_EQ(callbacks, 1);
+    CHECK_EQ(buffer[64], 0x55);
+
+    /* Write only - completion comes from the TX channel */
+    bytes = Host_SpiBytes();
+    SPI_DmaWrite(buffer, 100, done);
+    CHECK(SPI_DmaBusy());
+    Host_Advance(100);
+    CHECK(SPI_DmaBusy());
+    Host_Advance(150);
+    CHECK(!SPI_DmaBusy());
+    CHECK_EQ(callbacks, 2);
+    CHECK_EQ(Host_SpiBytes() - bytes, 100);
+
+    /* Blocking form runs the hook until the flag is set */
+    SPI_DmaWaitHook = hook;
+    SPI_DmaWrite(buffer, 16, 0);
+    SPI_DmaWait();
+    CHECK(!SPI_DmaBusy());
+    CHECK(hooks > 0);
+    CHECK_EQ(hooks_busy, hooks);
+    CHECK_EQ(callbacks, 2);
+
+    /* Sectors through the card - payloads go by DMA, the write CRC is
+       worked out while the payload is on the wire */
+    CHECK_EQ(SDCard_Init(), 0);
+    for(i = 0; i < SECTOR_SIZE; i++) buffer[i] = i * 29 + 3;
+
+    bytes = Host_DmaBytes();
+    hooks = 0;
+    CHECK_EQ(SDCard_WriteSector(7, buffer), 1);
+    SDModel_Read(7, back);
+    CHECK(memcmp(back, buffer, SECTOR_SIZE) == 0);
+    CHECK_EQ(Host_DmaBytes() - bytes, SECTOR_SIZE);
+
+    /* A sector is 1ms on the wire - the CPU was free for most of it */
+    hooks = 0;
+    memset(back, 0, sizeof(back));
+    CHECK_EQ(SDCard_ReadSector(7, back), 1);
+    CHECK(memcmp(back, buffer, SECTOR_SIZE) == 0);
+    CHECK_EQ(Host_DmaBytes() - bytes, 2 * SECTOR_SIZE);
+    CHECK(hooks > SECTOR_SIZE * 16);
+
+    /* Never written - the card hands back zeros */
+    CHECK_EQ(SDCard_ReadSectors(0, 1, back), 1);
+    for(zeros = 0, i = 0; i < SECTOR_SIZE; i++) zeros += back[i] == 0;
+    CHECK_EQ(zeros, SECTOR_SIZE);
+
+    /* Bad CRC on a DMA read is still caught */
+    sdmodel.corrupt_read = 7;
+    CHECK_EQ(SDCard_ReadSector(7, back), ERROR_READ);
+    sdmodel.corrupt_read = -1;
+
+    CHECK_EQ(sdmodel_stats.crc_errors, 0);
+    CHECK_EQ(Host_SpiOverlaps(), 0);
+
+    SDModel_Close();
+    return TEST_DONE();
+}
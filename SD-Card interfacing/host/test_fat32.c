@@ -0,0 +1,453 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model on an image file
+ * SW: FAT32 layer - appends that land in a short last FAT window
+ *     must not touch the next FAT copy or the data area, fragmented
+ *     chains around other files and bad clusters, files crossing
+ *     multi-sector clusters, a full volume and a FAT read that fails
+ *     partway through an append
+ *
+ *******************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fat32.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#define IMAGE     "test_fat32.img"
+#define SECTORS   8192
+#define RESERVED  32
+#define FAT_SIZE  63        /* not a multiple of FAT_WINDOW_SECTORS */
+#define FAT_LBA   RESERVED
+#define DATA_LBA  (RESERVED + 2 * FAT_SIZE)
+#define CLUSTERS  (SECTORS - DATA_LBA)
+
+/* First cluster whose entry is in the last, 3 sector, window */
+#define LAST_WINDOW ((FAT_SIZE - FAT_SIZE % FAT_WINDOW_SECTORS) * (SECTOR_SIZE / 4))
+
+static unsigned char image[SECTORS][SECTOR_SIZE];
+static unsigned int cluster_sectors;
+
+static char data[64 * SECTOR_SIZE], back[64 * SECTOR_SIZE];
+
+static void put32(unsigned char* p, unsigned int v)
+{
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static unsigned int get32(unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static unsigned int fat_entry(int copy, unsigned int cluster)
+{
+    return get32(image[FAT_LBA + copy * FAT_SIZE + cluster / 128] + (cluster % 128) * 4);
+}
+
+/* Both FAT copies */
+static void set_fat(unsigned int cluster, unsigned int value)
+{
+    int f;
+
+    for(f = 0; f < 2; f++)
+        put32(image[FAT_LBA + f * FAT_SIZE + cluster / 128] + (cluster % 128) * 4, value);
+}
+
+/* Root directory entry in cluster 2 */
+static void set_entry(int slot, const char* name83, unsigned char attr,
+                      unsigned int first, unsigned int size)
+{
+    unsigned char* entry = image[DATA_LBA] + slot * 32;
+
+    memset(entry, 0, 32);
+    memcpy(entry, name83, 11);
+    entry[11] = attr;
+    entry[20] = first >> 16; entry[21] = first >> 24;
+    entry[26] = first; entry[27] = first >> 8;
+    put32(entry + 28, size);
+}
+
+static unsigned char* sector_of(unsigned int cluster, unsigned int offset)
+{
+    return image[DATA_LBA + (cluster - 2) * cluster_sectors + offset / SECTOR_SIZE];
+}
+
+
+/* Empty bare FAT32 volume, root directory in cluster 2 */
+static void format(unsigned int sectors_per_cluster)
+{
+    unsigned char* vbr = image[0];
+
+    memset(image, 0, sizeof(image));
+    cluster_sectors = sectors_per_cluster;
+
+    vbr[11] = SECTOR_SIZE & 0xFF; vbr[12] = SECTOR_SIZE >> 8;
+    vbr[13] = sectors_per_cluster;
+    vbr[14] = RESERVED;
+    vbr[16] = 2;
+    put32(vbr + 32, SECTORS);
+    put32(vbr + 36, FAT_SIZE);
+    put32(vbr + 44, 2);
+    memcpy(vbr + 82, "FAT32   ", 8);
+    vbr[510] = 0x55; vbr[511] = 0xAA;
+
+    set_fat(0, 0x0FFFFFF8);
+    set_fat(1, FAT32_EOC);
+    set_fat(2, FAT32_EOC);
+}
+
+static int save(void)
+{
+    FILE* out = fopen(IMAGE, "wb");
+
+    if(out == 0) return 0;
+    fwrite(image, sizeof(image), 1, out);
+    fclose(out);
+    return 1;
+}
+
+static void load(void)
+{
+    FILE* in = fopen(IMAGE, "rb");
+
+    CHECK(in != 0);
+    if(in == 0) return;
+    CHECK_EQ(fread(image, sizeof(image), 1, in), 1);
+    fclose(in);
+}
+
+/* Card in, driver and volume up */
+static void mount(void)
+{
+    CHECK(SDModel_Open(IMAGE, SDMODEL_SDHC));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+    CHECK_EQ(Fat32_Mount(), 1);
+}
+
+static void fill(unsigned int seed)
+{
+    unsigned int i;
+
+    for(i = 0; i < sizeof(data); i++) data[i] = i * 11 + (i >> 9) + seed;
+}
+
+/* Read name back in pieces of step bytes, compare with data */
+static void read_back(const char* name, unsigned int size, unsigned int step)
+{
+    FAT32_File file;
+    unsigned int done = 0;
+    int n;
+
+    CHECK_EQ(Fat32_Open(&file, name, FAT32_READ), 1);
+    CHECK_EQ(file.size, size);
+
+    while(done < size)
+    {
+        n = Fat32_Read(&file, back + done, step);
+        CHECK(n > 0);
+        if(n <= 0) return;
+        done += n;
+    }
+
+    CHECK_EQ(done, size);
+    CHECK(memcmp(back, data, size) == 0);
+    CHECK_EQ(Fat32_Read(&file, back, step), 0);
+}
+
+
+/* Root directory full, everything below the last FAT window in use */
+static void test_last_window(void)
+{
+    unsigned char root[SECTOR_SIZE];
+    FAT32_File file;
+    unsigned int c;
+    int i;
+
+    format(1);
+    for(c = 3; c < LAST_WINDOW; c++) set_fat(c, FAT32_EOC);
+    for(i = 0; i < 16; i++)
+    {
+        sprintf((char*)image[DATA_LBA] + i * 32, "F%02d     TXT", i);
+        image[DATA_LBA][i * 32 + 11] = 0x20;
+    }
+    CHECK(save());
+    memcpy(root, image[DATA_LBA], SECTOR_SIZE);
+
+    mount();
+
+    /* New file - root directory grows, then the data, all in clusters
+       whose FAT entries are in the short last window */
+    fill(0);
+    CHECK_EQ(Fat32_Open(&file, "log.txt", FAT32_APPEND), 1);
+    CHECK_EQ(Fat32_Write(&file, data, sizeof(data)), sizeof(data));
+    CHECK_EQ(Fat32_Write(&file, data, 100), 100);
+    CHECK_EQ(Fat32_Sync(&file), 1);
+    CHECK_EQ(Fat32_Close(&file), 1);
+    SDModel_Close();
+
+    /* What is on the image now - cluster 2 as formatted, the two FAT
+       copies identical */
+    load();
+    CHECK(memcmp(image[DATA_LBA], root, SECTOR_SIZE) == 0);
+    CHECK(memcmp(image[FAT_LBA], image[FAT_LBA + FAT_SIZE], FAT_SIZE * SECTOR_SIZE) == 0);
+
+    /* Root directory cluster, then the file's chain */
+    CHECK_EQ(fat_entry(0, 2), LAST_WINDOW);
+    CHECK_EQ(fat_entry(0, LAST_WINDOW), FAT32_EOC);
+    for(c = LAST_WINDOW + 1; c < LAST_WINDOW + 65; c++) CHECK_EQ(fat_entry(0, c), c + 1);
+    CHECK_EQ(fat_entry(0, LAST_WINDOW + 65), FAT32_EOC);
+    CHECK_EQ(fat_entry(0, LAST_WINDOW + 66), 0);
+    CHECK(CLUSTERS + 2 > LAST_WINDOW + 66);
+
+    /* Mount again and read it all back, the old entries still there */
+    mount();
+    CHECK_EQ(Fat32_Open(&file, "f07.txt", FAT32_READ), 1);
+    CHECK_EQ(Fat32_Open(&file, "log.txt", FAT32_READ), 1);
+    CHECK_EQ(file.size, sizeof(data) + 100);
+    CHECK_EQ(Fat32_Read(&file, back, sizeof(back)), sizeof(back));
+    CHECK(memcmp(back, data, sizeof(data)) == 0);
+    CHECK_EQ(Fat32_Read(&file, back, sizeof(back)), 100);
+    CHECK(memcmp(back, data, 100) == 0);
+    SDModel_Close();
+}
+
+
+/* Every third cluster from 3 to 60 belongs to another file, 12 is
+ * marked bad - free space comes in runs of two. A directory named
+ * like the file, and a file whose chain ends in a bad cluster */
+static void test_fragmented(void)
+{
+    FAT32_File file;
+    unsigned int c, prev, chain[30];
+    int i, n;
+
+    format(1);
+    for(c = 3; c <= 60; c += 3) set_fat(c, c == 12 ? FAT32_BAD : FAT32_EOC);
+    set_entry(0, "LOG     TXT", 0x10, 3, 0);
+    set_entry(1, "BAD     TXT", 0x20, 63, SECTOR_SIZE);
+    set_fat(63, FAT32_BAD);
+    CHECK(save());
+
+    for(n = 0, c = 4; n < 30; c++)
+    {
+        if(c <= 60 && c % 3 == 0) continue;
+        if(c == 63) continue;
+        chain[n++] = c;
+    }
+
+    mount();
+
+    /* The directory is not the file */
+    CHECK_EQ(Fat32_Open(&file, "log.txt", FAT32_READ), ERROR_FAT_NOFILE);
+    CHECK_EQ(Fat32_Open(&file, "log.txt", FAT32_APPEND), 1);
+    CHECK_EQ(file.first_cluster, 0);
+    CHECK_EQ(file.dir_offset, 64);
+
+    /* One write - each run of two clusters goes out as one burst */
+    fill(1);
+    SDModel_ResetStats();
+    CHECK_EQ(Fat32_Write(&file, data, 30 * SECTOR_SIZE), 30 * SECTOR_SIZE);
+    CHECK_EQ(sdmodel_stats.commands[25], 15);
+    CHECK_EQ(sdmodel_stats.commands[24], 0);
+    CHECK_EQ(Fat32_Close(&file), 1);
+
+    /* Nothing can be linked past a bad cluster */
+    CHECK_EQ(Fat32_Open(&file, "bad.txt", FAT32_APPEND), 1);
+    CHECK_EQ(Fat32_Write(&file, data, 100), -1);
+    CHECK_EQ(Fat32_Close(&file), 1);
+
+    /* Preallocation looks past the bad cluster */
+    CHECK_EQ(Fat32_Preallocate(&file, "stream.dat", 8 * SECTOR_SIZE), 1);
+    CHECK_EQ(file.first_cluster, 64);
+    CHECK_EQ(Fat32_StreamAppend(&file, data), 1);
+    CHECK_EQ(Fat32_Close(&file), 1);
+
+    /* Whole file in one read, a multi-block command per run, then in
+       pieces that straddle sectors and fragments */
+    SDModel_ResetStats();
+    read_back("log.txt", 30 * SECTOR_SIZE, sizeof(back));
+    CHECK_EQ(sdmodel_stats.commands[18], 15);
+    read_back("log.txt", 30 * SECTOR_SIZE, 700);
+    SDModel_Close();
+
+    load();
+    CHECK(memcmp(image[FAT_LBA], image[FAT_LBA + FAT_SIZE], FAT_SIZE * SECTOR_SIZE) == 0);
+    CHECK_EQ(image[DATA_LBA][11], 0x10);
+    CHECK(memcmp(image[DATA_LBA] + 64, "LOG     TXT", 11) == 0);
+    CHECK_EQ(get32(image[DATA_LBA] + 64 + 28), 30 * SECTOR_SIZE);
+
+    for(i = 0, prev = 0; i < 30; prev = chain[i++])
+    {
+        if(prev) CHECK_EQ(fat_entry(0, prev), chain[i]);
+        CHECK(memcmp(sector_of(chain[i], 0), data + i * SECTOR_SIZE, SECTOR_SIZE) == 0);
+    }
+    CHECK_EQ(fat_entry(0, chain[29]), FAT32_EOC);
+    CHECK_EQ(fat_entry(0, 3), FAT32_EOC);
+    CHECK_EQ(fat_entry(0, 12), FAT32_BAD);
+    CHECK_EQ(fat_entry(0, 63), FAT32_BAD);
+    CHECK_EQ(get32(image[DATA_LBA] + 32 + 28), SECTOR_SIZE);
+
+    /* The stream kept one cluster of its extent */
+    CHECK_EQ(fat_entry(0, 64), FAT32_EOC);
+    CHECK_EQ(fat_entry(0, 65), 0);
+}
+
+
+/* Four sector clusters, two of them taken - appends in odd sizes,
+ * across a remount, land where the chain says */
+static void test_cluster_sectors(void)
+{
+    FAT32_File file;
+    unsigned int chain[16], c, offset;
+    unsigned int size = 300 + 700 + 40 * SECTOR_SIZE + 1234 + 5000;
+    int n;
+
+    format(4);
+    set_fat(5, FAT32_EOC);
+    set_fat(8, FAT32_EOC);
+    CHECK(save());
+
+    for(n = 0, c = 3; n < 16; c++)
+    {
+        if(c != 5 && c != 8) chain[n++] = c;
+    }
+
+    mount();
+    fill(2);
+    CHECK_EQ(Fat32_Open(&file, "big.dat", FAT32_APPEND), 1);
+    CHECK_EQ(Fat32_Write(&file, data, 300), 300);
+    CHECK_EQ(Fat32_Write(&file, data + 300, 700), 700);
+    CHECK_EQ(Fat32_Write(&file, data + 1000, 40 * SECTOR_SIZE), 40 * SECTOR_SIZE);
+    CHECK_EQ(Fat32_Write(&file, data + 1000 + 40 * SECTOR_SIZE, 1234), 1234);
+    CHECK_EQ(Fat32_Close(&file), 1);
+    SDModel_Close();
+
+    /* Append again after a remount - starts in the partial tail */
+    mount();
+    CHECK_EQ(Fat32_Open(&file, "big.dat", FAT32_APPEND), 1);
+    CHECK_EQ(file.position, size - 5000);
+    CHECK_EQ(Fat32_Write(&file, data + size - 5000, 5000), 5000);
+    CHECK_EQ(Fat32_Close(&file), 1);
+
+    read_back("big.dat", size, sizeof(back));
+    read_back("big.dat", size, 777);
+    read_back("big.dat", size, SECTOR_SIZE);
+    SDModel_Close();
+
+    /* Every byte in its cluster on the image */
+    load();
+    n = (size + 4 * SECTOR_SIZE - 1) / (4 * SECTOR_SIZE);
+    for(c = 0; c < (unsigned int)n - 1; c++) CHECK_EQ(fat_entry(0, chain[c]), chain[c + 1]);
+    CHECK_EQ(fat_entry(0, chain[n - 1]), FAT32_EOC);
+    CHECK_EQ(fat_entry(0, chain[n]), 0);
+
+    for(offset = 0; offset < size; offset += SECTOR_SIZE)
+    {
+        c = chain[offset / (4 * SECTOR_SIZE)];
+        CHECK(memcmp(sector_of(c, offset % (4 * SECTOR_SIZE)), data + offset,
+                     size - offset < SECTOR_SIZE ? size - offset : SECTOR_SIZE) == 0);
+    }
+}
+
+
+/* Five free clusters left - the write ends short, the next one fails */
+static void test_full(void)
+{
+    FAT32_File file;
+    unsigned int last = (SECTORS - DATA_LBA) / 4 + 1, c;
+
+    format(4);
+    for(c = 3; c <= last; c++)
+    {
+        if(c != 100 && c != 101 && c != 102 && c != 500 && c != last) set_fat(c, FAT32_EOC);
+    }
+    CHECK(save());
+
+    mount();
+    fill(3);
+    CHECK_EQ(Fat32_Open(&file, "full.dat", FAT32_APPEND), 1);
+    CHECK_EQ(Fat32_Write(&file, data, 10 * 4 * SECTOR_SIZE), 5 * 4 * SECTOR_SIZE);
+    CHECK_EQ(Fat32_Write(&file, data, 1), -1);
+    CHECK_EQ(Fat32_Close(&file), 1);
+
+    CHECK_EQ(Fat32_Preallocate(&file, "more.dat", 1), ERROR_FAT_FULL);
+
+    read_back("full.dat", 5 * 4 * SECTOR_SIZE, 1000);
+    SDModel_Close();
+
+    load();
+    CHECK_EQ(fat_entry(0, 100), 101);
+    CHECK_EQ(fat_entry(0, 102), 500);
+    CHECK_EQ(fat_entry(0, 500), last);
+    CHECK_EQ(fat_entry(0, last), FAT32_EOC);
+}
+
+
+/* The file ends in the last cluster of the first FAT window and the
+ * next window cannot be read - the append fails at once instead of
+ * probing the whole FAT, and the chain is left as it was */
+static void test_io_error(void)
+{
+    FAT32_File file;
+    unsigned int c, window = FAT_WINDOW_SECTORS * (SECTOR_SIZE / 4);
+
+    format(1);
+    for(c = 3; c < window - 1; c++) set_fat(c, FAT32_EOC);
+    CHECK(save());
+
+    mount();
+    fill(4);
+    CHECK_EQ(Fat32_Open(&file, "err.txt", FAT32_APPEND), 1);
+    CHECK_EQ(Fat32_Write(&file, data, SECTOR_SIZE), SECTOR_SIZE);
+    CHECK_EQ(file.cluster, window - 1);
+    CHECK_EQ(Fat32_Sync(&file), 1);
+
+    sdmodel.fail_read = FAT_LBA + FAT_WINDOW_SECTORS;
+    SDModel_ResetStats();
+    CHECK_EQ(Fat32_Write(&file, data + SECTOR_SIZE, SECTOR_SIZE), -1);
+    CHECK(sdmodel_stats.commands[18] + sdmodel_stats.commands[17] <= 2);
+    CHECK_EQ(sdmodel_stats.commands[24] + sdmodel_stats.commands[25], 0);
+
+    sdmodel.fail_read = -1;
+    CHECK_EQ(Fat32_Close(&file), 1);
+    read_back("err.txt", SECTOR_SIZE, SECTOR_SIZE);
+    SDModel_Close();
+
+    load();
+    CHECK_EQ(fat_entry(0, window - 1), FAT32_EOC);
+    CHECK_EQ(fat_entry(0, window), 0);
+}
+
+
+/* test_fat32 <file> also records the block trace bench_sd_cache replays */
+int main(int argc, char** argv)
+{
+    FILE* trace = 0;
+
+    if(argc > 1)
+    {
+        trace = fopen(argv[1], "w");
+        CHECK(trace != 0);
+        SDModel_Trace(trace);
+    }
+
+    test_last_window();
+    test_fragmented();
+    test_cluster_sectors();
+    test_full();
+    test_io_error();
+
+    SDModel_Trace(0);
+    if(trace) fclose(trace);
+
+    remove(IMAGE);
+    return TEST_DONE();
+}
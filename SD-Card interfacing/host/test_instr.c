@@ -0,0 +1,156 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: Latency histograms built in (INSTR_ENABLE) - bucketing, dump
+ *     text, and the read/write paths counted on the simulated clock
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include "pic32_sdcard.h"
+#include "instr.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#ifndef INSTR_ENABLE
+#error "build with -DINSTR_ENABLE"
+#endif
+
+#define SECTORS 4096
+
+static char report[2048];
+static unsigned int length;
+
+static void out(char c)
+{
+    if(length < sizeof(report) - 1) report[length++] = c;
+    report[length] = 0;
+}
+
+static void dump(void)
+{
+    length = 0;
+    report[0] = 0;
+    Instr_Dump(out);
+}
+
+/* Line of the dump for one operation */
+static const char* line(const char* name)
+{
+    const char* p = report;
+    size_t n = strlen(name);
+
+    while(p && *p)
+    {
+        if(strncmp(p, name, n) == 0 && p[n] == ' ') return p;
+        p = strchr(p, '\n');
+        if(p) p++;
+    }
+
+    return 0;
+}
+
+/* Count in one bucket, or in all of them with bucket -1 */
+static unsigned long count(const char* name, int bucket)
+{
+    const char* p = line(name);
+    unsigned long total = 0, n;
+    char* end;
+    long b;
+
+    if(!p) return 0;
+    p = strchr(p, ' ') + 1;
+    p = strchr(p, ' ');
+
+    while(p && *p == ' ')
+    {
+        b = strtol(p + 1, &end, 10);
+        if(*end != ':') break;
+        n = strtoul(end + 1, &end, 10);
+        if(bucket < 0 || b == bucket) total += n;
+        p = end;
+    }
+
+    return total;
+}
+
+static unsigned long worst(const char* name)
+{
+    const char* p = line(name);
+
+    return p ? strtoul(strstr(p, "max=") + 4, 0, 10) : 0;
+}
+
+static int bucket_of(unsigned long ticks)
+{
+    int b = 0;
+
+    while((ticks >>= 1) != 0 && b < INSTR_BUCKETS - 1) b++;
+    return b;
+}
+
+
+int main(void)
+{
+    char buffer[SECTOR_SIZE];
+    unsigned long long t0;
+    unsigned long byte;
+    int i;
+
+    /* Bucket edges - 0 and 1 share bucket 0, the last is open ended */
+    Instr_Reset();
+    Instr_Record(INSTR_SPI_WRITE, 0);
+    Instr_Record(INSTR_SPI_WRITE, 1);
+    Instr_Record(INSTR_SPI_WRITE, 2);
+    Instr_Record(INSTR_SPI_WRITE, 3);
+    Instr_Record(INSTR_SPI_WRITE, 4);
+    Instr_Record(INSTR_READ_SECTOR, 1u << 23);
+    Instr_Record(INSTR_READ_SECTOR, 0xFFFFFFFFu);
+    dump();
+    CHECK(strcmp(report,
+                 "spi_write max=4 0:2 1:2 2:1\r\n"
+                 "read_token max=0\r\n"
+                 "write_busy max=0\r\n"
+                 "read_sector max=4294967295 23:2\r\n"
+                 "write_sector max=0\r\n") == 0);
+
+    Instr_Reset();
+    dump();
+    CHECK_EQ(count("spi_write", -1), 0);
+    CHECK_EQ(worst("read_sector"), 0);
+
+    /* Real traffic at the data clock */
+    CHECK(SDModel_Init(SDMODEL_SDHC, SECTORS));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+    Instr_Reset();
+
+    memset(buffer, 0x5A, sizeof(buffer));
+    t0 = Host_Ticks();
+    for(i = 0; i < 10; i++) CHECK_EQ(SDCard_ReadSector(i, buffer), 1);
+    for(i = 0; i < 3; i++) CHECK_EQ(SDCard_WriteSector(100 + i, buffer), 1);
+    dump();
+    printf("%s", report);
+
+    CHECK_EQ(count("read_sector", -1), 10);
+    CHECK_EQ(count("read_token", -1), 10);
+    CHECK_EQ(count("write_sector", -1), 3);
+    CHECK_EQ(count("write_busy", -1), 3);
+    CHECK(worst("read_sector") < Host_Ticks() - t0);
+    CHECK(worst("read_token") < worst("read_sector"));
+
+    /* Blocks go by DMA, commands and tokens a byte at a time - each
+       one SPI byte time plus a few register reads, all in its bucket */
+    byte = 8UL * (SYS_FREQ / 2) / SPI_GetClock();
+    CHECK(count("spi_write", -1) > 13 * 6);
+    CHECK_EQ(count("spi_write", bucket_of(byte)), count("spi_write", -1));
+    CHECK(worst("spi_write") >= byte);
+
+    SDModel_Close();
+    return TEST_DONE();
+}
@@ -0,0 +1,137 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: SDCard_ReadSectors - CMD18 stream, CMD12 stop, errors mid-stream
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "pic32_sdcard.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#define SECTORS 8192
+
+static char buffer[16 * SECTOR_SIZE];
+
+
+/* Sector n holds n in every byte pair */
+static void fill_card(void)
+{
+    char data[SECTOR_SIZE];
+    unsigned int n;
+    int i;
+
+    for(n = 0; n < 64; n++)
+    {
+        for(i = 0; i < SECTOR_SIZE; i += 2)
+        {
+            data[i] = n;
+            data[i + 1] = i >> 1;
+        }
+        SDModel_Write(n, data);
+    }
+}
+
+static int holds(char* data, unsigned int n)
+{
+    char expect[SECTOR_SIZE];
+
+    SDModel_Read(n, expect);
+    return memcmp(data, expect, SECTOR_SIZE) == 0;
+}
+
+static void card(int type)
+{
+    CHECK(SDModel_Init(type, SECTORS));
+    fill_card();
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+    SDModel_ResetStats();
+}
+
+static double elapsed_ms(unsigned long long since)
+{
+    return (double)(Host_Ticks() - since) / CORE_TICKS_MS;
+}
+
+
+int main(void)
+{
+    unsigned long long t0;
+    int i, ncr;
+
+    /* Stream of 8 - one CMD18, one CMD12, every block in place */
+    card(SDMODEL_SDHC);
+    CHECK_EQ(SDCard_ReadSectors(10, 8, buffer), 1);
+    for(i = 0; i < 8; i++) CHECK(holds(buffer + i * SECTOR_SIZE, 10 + i));
+    CHECK_EQ(sdmodel_stats.commands[CMD18], 1);
+    CHECK_EQ(sdmodel_stats.commands[CMD12], 1);
+    CHECK_EQ(sdmodel_stats.commands[CMD17], 0);
+    CHECK_EQ(sdmodel_stats.crc_errors, 0);
+
+    /* One sector is a plain CMD17 */
+    SDModel_ResetStats();
+    CHECK_EQ(SDCard_ReadSectors(20, 1, buffer), 1);
+    CHECK(holds(buffer, 20));
+    CHECK_EQ(sdmodel_stats.commands[CMD17], 1);
+    CHECK_EQ(sdmodel_stats.commands[CMD18], 0);
+    CHECK_EQ(SDCard_ReadSectors(20, 0, buffer), 1);
+
+    /* The byte after CMD12 is not the R1 - whatever it holds and
+       however long the card takes to answer */
+    for(ncr = 1; ncr <= 8; ncr++)
+    {
+        sdmodel.ncr = ncr;
+        sdmodel.stuff = 0x7F;
+        CHECK_EQ(SDCard_ReadSectors(30, 3, buffer), 1);
+        sdmodel.stuff = 0x00;
+        CHECK_EQ(SDCard_ReadSectors(30, 3, buffer), 1);
+        CHECK(holds(buffer + 2 * SECTOR_SIZE, 32));
+    }
+    sdmodel.ncr = 1;
+
+    /* Error token mid-stream - blocks before it are good, the call
+       fails at once instead of sitting out READ_TIMEOUT, and the
+       stream is still closed so the card stays usable */
+    SDModel_ResetStats();
+    memset(buffer, 0, sizeof(buffer));
+    sdmodel.fail_read = 13;
+    t0 = Host_Ticks();
+    CHECK_EQ(SDCard_ReadSectors(10, 8, buffer), ERROR_READ);
+    CHECK(elapsed_ms(t0) < 5);
+    for(i = 0; i < 3; i++) CHECK(holds(buffer + i * SECTOR_SIZE, 10 + i));
+    CHECK_EQ(sdmodel_stats.commands[CMD12], 1);
+    sdmodel.fail_read = -1;
+    CHECK_EQ(SDCard_ReadSector(13, buffer), 1);
+    CHECK(holds(buffer, 13));
+
+    /* Bad CRC16 on block 3 of the stream */
+    SDModel_ResetStats();
+    sdmodel.corrupt_read = 12;
+    CHECK_EQ(SDCard_ReadSectors(10, 8, buffer), ERROR_READ);
+    CHECK_EQ(sdmodel_stats.commands[CMD12], 1);
+    CHECK_EQ(sdmodel_stats.blocks_read, 3);
+    sdmodel.corrupt_read = -1;
+    CHECK_EQ(SDCard_ReadSectors(10, 8, buffer), 1);
+
+    /* Running off the end of the card */
+    t0 = Host_Ticks();
+    CHECK_EQ(SDCard_ReadSectors(SECTORS - 2, 4, buffer), ERROR_READ);
+    CHECK(elapsed_ms(t0) < 5);
+    CHECK_EQ(SDCard_ReadSectors(SECTORS - 2, 2, buffer), 1);
+
+    /* Byte addressed card - same stream */
+    card(SDMODEL_SDSC_V2);
+    CHECK_EQ(SDCard.block_addressing, 0);
+    CHECK_EQ(SDCard_ReadSectors(5, 16, buffer), 1);
+    for(i = 0; i < 16; i++) CHECK(holds(buffer + i * SECTOR_SIZE, 5 + i));
+    CHECK_EQ(sdmodel_stats.rejected, 0);
+
+    SDModel_Close();
+    return TEST_DONE();
+}
@@ -0,0 +1,222 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: Sector cache - a hand worked trace, then a long FAT-like trace
+ *     replayed against a reference LRU with the card checked after
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "sd_cache.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+#define SPAN 24
+#define OPS  4000
+
+static char buffer[SECTOR_SIZE];
+
+/* Contents of sector s after its v-th write */
+static void fill(char* data, unsigned int s, unsigned int v)
+{
+    int i;
+    for(i = 0; i < SECTOR_SIZE; i++) data[i] = s * 31 + v * 7 + i;
+}
+
+static int is(char* data, unsigned int s, unsigned int v)
+{
+    char expect[SECTOR_SIZE];
+
+    fill(expect, s, v);
+    return memcmp(data, expect, SECTOR_SIZE) == 0;
+}
+
+static void read(unsigned int s)
+{
+    CHECK_EQ(SDCache_ReadSector(s, buffer), 1);
+}
+
+static void write(unsigned int s, unsigned int v)
+{
+    fill(buffer, s, v);
+    CHECK_EQ(SDCache_WriteSector(s, buffer), 1);
+}
+
+static void expect(unsigned int hits, unsigned int misses, unsigned int evictions,
+                   unsigned int writebacks, unsigned int coalesced)
+{
+    SDCache_Stats stats;
+
+    SDCache_GetStats(&stats);
+    CHECK_EQ(stats.hits, hits);
+    CHECK_EQ(stats.misses, misses);
+    CHECK_EQ(stats.evictions, evictions);
+    CHECK_EQ(stats.writebacks, writebacks);
+    CHECK_EQ(stats.coalesced, coalesced);
+}
+
+
+/* Same policy, no data - empty way first, else least recently used */
+static struct
+{
+    unsigned int sector[SDCACHE_SETS][SDCACHE_WAYS];
+    unsigned int stamp[SDCACHE_SETS][SDCACHE_WAYS];
+    int valid[SDCACHE_SETS][SDCACHE_WAYS];
+    int dirty[SDCACHE_SETS][SDCACHE_WAYS];
+    unsigned int clock;
+    SDCache_Stats stats;
+} ref;
+
+static void ref_access(unsigned int s, int writing)
+{
+    int set = s % SDCACHE_SETS, way, victim = 0;
+
+    for(way = 0; way < SDCACHE_WAYS; way++)
+        if(ref.valid[set][way] && ref.sector[set][way] == s) break;
+
+    if(way < SDCACHE_WAYS)
+    {
+        ref.stats.hits++;
+        if(writing && ref.dirty[set][way]) ref.stats.coalesced++;
+    }
+    else
+    {
+        ref.stats.misses++;
+        for(way = 0; way < SDCACHE_WAYS; way++)
+        {
+            if(!ref.valid[set][way])
+            {
+                victim = way;
+                break;
+            }
+            if(ref.stamp[set][way] < ref.stamp[set][victim]) victim = way;
+        }
+        way = victim;
+        if(ref.valid[set][way])
+        {
+            ref.stats.evictions++;
+            if(ref.dirty[set][way]) ref.stats.writebacks++;
+        }
+        ref.valid[set][way] = 1;
+        ref.dirty[set][way] = 0;
+        ref.sector[set][way] = s;
+    }
+
+    if(writing) ref.dirty[set][way] = 1;
+    ref.stamp[set][way] = ++ref.clock;
+}
+
+
+int main(void)
+{
+    unsigned int version[SPAN];
+    unsigned int s, seed = 12345, reads = 0;
+    SDCache_Stats stats;
+    int op;
+
+    CHECK(SDModel_Init(SDMODEL_SDHC, 8192));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+    for(s = 0; s < SPAN; s++)
+    {
+        fill(buffer, s, 0);
+        SDModel_Write(s, buffer);
+    }
+
+    /* Hand worked - 2 sets of 4 ways, even sectors in set 0 */
+    SDCache_Init();
+    SDModel_ResetStats();
+    read(0); read(2); read(4); read(6);
+    expect(0, 4, 0, 0, 0);
+    read(0);                            /* hit, 0 is now the newest */
+    read(8);                            /* evicts 2 */
+    read(2);                            /* evicts 4 */
+    read(1);                            /* set 1 is empty */
+    read(0);
+    CHECK(is(buffer, 0, 0));
+    expect(2, 7, 2, 0, 0);
+    CHECK_EQ(sdmodel_stats.commands[CMD17], 7);
+
+    write(3, 1);                        /* miss, no fetch */
+    write(3, 2);                        /* coalesced */
+    write(5, 1); write(7, 1);
+    write(9, 1);                        /* evicts 1 - clean */
+    write(11, 1);                       /* evicts 3 - written back */
+    expect(3, 12, 4, 1, 1);
+    CHECK_EQ(sdmodel_stats.commands[CMD17], 7);
+    CHECK_EQ(sdmodel_stats.commands[CMD24], 1);
+    SDModel_Read(3, buffer);
+    CHECK(is(buffer, 3, 2));
+
+    /* 5, 7, 9 and 11 are not consecutive - four single writes */
+    CHECK_EQ(SDCache_Flush(), 1);
+    CHECK_EQ(sdmodel_stats.commands[CMD24], 5);
+    expect(3, 12, 4, 5, 1);
+
+    /* 20-23 span both sets but flush as one burst */
+    write(20, 1); write(21, 1); write(22, 1); write(23, 1);
+    CHECK_EQ(SDCache_Flush(), 1);
+    CHECK_EQ(sdmodel_stats.commands[CMD25], 1);
+    CHECK_EQ(sdmodel_stats.commands[CMD24], 5);
+    SDModel_Read(22, buffer);
+    CHECK(is(buffer, 22, 1));
+
+    /* Nothing dirty left */
+    CHECK_EQ(SDCache_Flush(), 1);
+    CHECK_EQ(sdmodel_stats.blocks_written, 9);
+
+    /* FAT-like trace - 3 in 4 accesses to sectors 0-3, the rest anywhere */
+    SDCache_Init();
+    SDModel_ResetStats();
+    memset(&ref, 0, sizeof(ref));
+    for(s = 0; s < SPAN; s++)
+    {
+        SDModel_Read(s, buffer);
+        version[s] = 0;
+        if(is(buffer, s, 1)) version[s] = 1;
+        if(is(buffer, s, 2)) version[s] = 2;
+    }
+
+    for(op = 0; op < OPS; op++)
+    {
+        seed = seed * 1103515245 + 12345;
+        s = (seed >> 8) % 4 != 0 ? (seed >> 12) % 4 : (seed >> 12) % SPAN;
+
+        if((seed >> 20) % 10 < 7)
+        {
+            ref_access(s, 0);
+            read(s);
+            CHECK(is(buffer, s, version[s]));
+            reads++;
+        }
+        else
+        {
+            ref_access(s, 1);
+            write(s, ++version[s]);
+        }
+    }
+
+    SDCache_GetStats(&stats);
+    expect(ref.stats.hits, ref.stats.misses, ref.stats.evictions,
+           ref.stats.writebacks, ref.stats.coalesced);
+    CHECK(stats.hits > stats.misses);
+
+    /* Card saw only what the cache let through */
+    CHECK(sdmodel_stats.commands[CMD17] <= reads);
+    CHECK_EQ(sdmodel_stats.commands[CMD24], stats.writebacks);
+
+    CHECK_EQ(SDCache_Flush(), 1);
+    for(s = 0; s < SPAN; s++)
+    {
+        SDModel_Read(s, buffer);
+        CHECK(is(buffer, s, version[s]));
+    }
+
+    CHECK_EQ(sdmodel_stats.crc_errors, 0);
+    SDModel_Close();
+    return TEST_DONE();
+}
@@ -0,0 +1,85 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: Linux host, SD card model
+ * SW: Request queue - queued reads and writes, and a read the card
+ *     answers with a data error token failing at once
+ *
+ *******************************************************************/
+
+#include <string.h>
+#include "sd_queue.h"
+#include "host_pic32.h"
+#include "sdcard_model.h"
+#include "host_test.h"
+
+static char data[3][SECTOR_SIZE], back[3][SECTOR_SIZE];
+
+/* Poll until the queue is empty, simulated us it took */
+static unsigned long drain(void)
+{
+    unsigned long long t0 = Host_Ticks();
+
+    while(SDCard_Poll()) Host_Advance(1);
+    return (unsigned long)((Host_Ticks() - t0) / CORE_TICKS_US);
+}
+
+
+int main(void)
+{
+    SDQueue_Request req[3], full[SDQUEUE_DEPTH], extra;
+    unsigned long us;
+    int i, n;
+
+    CHECK(SDModel_Init(SDMODEL_SDHC, 8192));
+    Host_Reset();
+    HAL_IntEnable();
+    SPI_Init();
+    CHECK_EQ(SDCard_Init(), 0);
+    SDQueue_Init();
+
+    for(i = 0; i < 3; i++)
+        for(n = 0; n < SECTOR_SIZE; n++) data[i][n] = i * 41 + n;
+
+    /* Writes then reads, all queued before the first poll */
+    for(i = 0; i < 3; i++) CHECK(SDQueue_Write(&req[i], 300 + i, data[i], 0));
+    drain();
+    for(i = 0; i < 3; i++) CHECK_EQ(req[i].status, 1);
+
+    for(i = 0; i < 3; i++) CHECK(SDQueue_Read(&req[i], 300 + i, back[i], 0));
+    drain();
+    for(i = 0; i < 3; i++)
+    {
+        CHECK_EQ(req[i].status, 1);
+        CHECK(memcmp(back[i], data[i], SECTOR_SIZE) == 0);
+    }
+
+    /* The middle read gets an error token - it fails without waiting
+       out READ_TIMEOUT, and the reads around it still complete */
+    memset(back, 0, sizeof(back));
+    sdmodel.fail_read = 301;
+    for(i = 0; i < 3; i++) CHECK(SDQueue_Read(&req[i], 300 + i, back[i], 0));
+    us = drain();
+    CHECK_EQ(req[0].status, 1);
+    CHECK_EQ(req[1].status, ERROR_READ);
+    CHECK_EQ(req[2].status, 1);
+    CHECK(memcmp(back[0], data[0], SECTOR_SIZE) == 0);
+    CHECK(memcmp(back[2], data[2], SECTOR_SIZE) == 0);
+    CHECK(us < READ_TIMEOUT * 1000UL / 10);
+
+    /* A request the full queue refuses is not left looking in flight,
+       nor is one never submitted */
+    sdmodel.fail_read = -1;
+    memset(&extra, 0, sizeof(extra));
+    CHECK(extra.status != SDQ_PENDING);
+    for(i = 0; i < SDQUEUE_DEPTH; i++) CHECK(SDQueue_Read(&full[i], 300, back[0], 0));
+    extra.status = SDQ_PENDING;    /* whatever it held before */
+    CHECK(!SDQueue_Read(&extra, 301, back[1], 0));
+    CHECK_EQ(extra.status, SDQ_FREE);
+    drain();
+    for(i = 0; i < SDQUEUE_DEPTH; i++) CHECK_EQ(full[i].status, 1);
+
+    CHECK_EQ(sdmodel_stats.crc_errors, 0);
+    SDModel_Close();
+    return TEST_DONE();
+}
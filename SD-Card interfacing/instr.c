@@ -0,0 +1,94 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: Latency histograms for the SD driver hot paths
+ *
+ *******************************************************************/
+
+#include "instr.h"
+
+#ifdef INSTR_ENABLE
+
+static unsigned int histogram[INSTR_COUNT][INSTR_BUCKETS];
+static instr_t worst[INSTR_COUNT];
+
+static const char* names[INSTR_COUNT] =
+{
+    "spi_write", "read_token", "write_busy", "read_sector", "write_sector"
+};
+
+
+/* Count one sample - highest set bit picks the bucket */
+void Instr_Record(unsigned char id, instr_t ticks)
+{
+    unsigned int bucket = 0;
+
+    if(ticks > worst[id]) worst[id] = ticks;
+
+    while((ticks >>= 1) != 0 && bucket < INSTR_BUCKETS - 1) bucket++;
+
+    histogram[id][bucket]++;
+}
+
+
+/* Clear all histograms */
+void Instr_Reset(void)
+{
+    int i, j;
+
+    for(i = 0; i < INSTR_COUNT; i++)
+    {
+        worst[i] = 0;
+        for(j = 0; j < INSTR_BUCKETS; j++) histogram[i][j] = 0;
+    }
+}
+
+
+static void put_string(void (*out)(char), const char* s)
+{
+    while(*s) out(*s++);
+}
+
+
+static void put_number(void (*out)(char), unsigned int n)
+{
+    char digits[10];
+    int i = 0;
+
+    do
+    {
+        digits[i++] = '0' + (n % 10);
+        n /= 10;
+    } while(n != 0);
+
+    while(i > 0) out(digits[--i]);
+}
+
+
+/* Emit "name max=<ticks> <bucket>:<count> ..." per operation, empty buckets skipped */
+void Instr_Dump(void (*out)(char c))
+{
+    int i, j;
+
+    for(i = 0; i < INSTR_COUNT; i++)
+    {
+        put_string(out, names[i]);
+        put_string(out, " max=");
+        put_number(out, worst[i]);
+
+        for(j = 0; j < INSTR_BUCKETS; j++)
+        {
+            if(histogram[i][j] == 0) continue;
+
+            out(' ');
+            put_number(out, j);
+            out(':');
+            put_number(out, histogram[i][j]);
+        }
+
+        put_string(out, "\r\n");
+    }
+}
+
+#endif
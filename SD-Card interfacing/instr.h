@@ -0,0 +1,61 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: Latency histograms for the SD driver hot paths
+ *
+ *******************************************************************/
+#ifndef INSTR_H
+#define	INSTR_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include "hal_pic32.h"
+
+/* Uncomment, or build with -DINSTR_ENABLE, to build the instrumentation in -
+ * compiles out completely otherwise */
+/* #define INSTR_ENABLE */
+
+/* Measured operations */
+#define INSTR_SPI_WRITE    0   /* one byte exchange incl. SPIRBF spin */
+#define INSTR_READ_TOKEN   1   /* START_TOKEN polling */
+#define INSTR_WRITE_BUSY   2   /* busy polling after a data block */
+#define INSTR_READ_SECTOR  3
+#define INSTR_WRITE_SECTOR 4
+#define INSTR_COUNT        5
+
+/* Power of two buckets of core timer ticks (SYS_FREQ/2):
+ * bucket n holds 2^n <= ticks < 2^(n+1), last bucket is open ended */
+#define INSTR_BUCKETS 24
+
+#ifdef INSTR_ENABLE
+
+typedef unsigned int instr_t;
+
+/* Declare a start stamp among the other declarations - no ';' after
+ * it, the macro brings its own so it can vanish when disabled */
+#define INSTR_DECLARE(t)  instr_t t;
+#define INSTR_START(t)    t = HAL_TimerRead()
+#define INSTR_STOP(id, t) Instr_Record((id), HAL_TimerRead() - (t))
+
+void Instr_Record(unsigned char id, instr_t ticks);
+void Instr_Reset(void);
+void Instr_Dump(void (*out)(char c));
+
+#else
+
+#define INSTR_DECLARE(t)
+#define INSTR_START(t)
+#define INSTR_STOP(id, t)
+#define Instr_Reset()
+#define Instr_Dump(out)
+
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* INSTR_H */
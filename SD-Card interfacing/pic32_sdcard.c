@@ -9,16 +9,51 @@
  *******************************************************************/
 
 #include "pic32_sdcard.h"
+#include "sd_crc.h"
+#include "instr.h"
+
+#ifndef HAL_HOST
+/* Expand OSC_* values into config pragmas, e.g. FPBDIV = DIV_4 */
+#define CONFIG_PRAGMA(x)        _Pragma(#x)
+#define CONFIG_DIV(key, n)      CONFIG_PRAGMA(config key = DIV_##n)
+#define CONFIG_MUL(key, n)      CONFIG_PRAGMA(config key = MUL_##n)
+#define CONFIG_EXPAND_DIV(k, n) CONFIG_DIV(k, n)
+#define CONFIG_EXPAND_MUL(k, n) CONFIG_MUL(k, n)
 
 /* OSC - SYSCLK Configuration - 32 MHz */
-#pragma config FPLLIDIV = DIV_2
+CONFIG_EXPAND_DIV(FPLLIDIV, OSC_FPLLIDIV)
 #pragma config POSCMOD = XT, FNOSC = PRIPLL, FWDTEN = OFF
-#pragma config FPLLMUL = MUL_16
-#pragma config FPLLODIV = DIV_2
+CONFIG_EXPAND_MUL(FPLLMUL, OSC_FPLLMUL)
+CONFIG_EXPAND_DIV(FPLLODIV, OSC_FPLLODIV)
 
 /* OSC - PBCLK Configuration - 8 MHz */
 /* Default PBCLK = SYSCLK/8 */
-#pragma config FPBDIV = DIV_4
+CONFIG_EXPAND_DIV(FPBDIV, OSC_FPBDIV)
+#endif
+
+/* Current SPI2 bit rate */
+static unsigned int spi_clock;
+
+/* Detected card, filled in by SDCard_Init */
+SDCard_Info SDCard;
+
+/* Trailing bytes of the last R3/R7 response */
+unsigned char SDCard_Response[4];
+
+static int SDCard_ReadCSD(void);
+static int SDCard_WaitBusy(void);
+
+#ifdef INSTR_ENABLE
+/* Latency histograms as text, left in RAM for the debugger - the kit
+ * has no UART wired */
+char instr_report[1024];
+static unsigned int instr_length;
+
+static void instr_out(char c)
+{
+    if(instr_length < sizeof(instr_report) - 1) instr_report[instr_length++] = c;
+}
+#endif
 
 
 
@@ -28,11 +63,11 @@ void main()
     char buffer[512], readbuf[512];
 
     /* Set LED pins to output */
-    _TRISD0 = 0; _TRISD1 = 0; _TRISD2 = 0;
-    _RD0 = 0; _RD1 = 0; _RD2 = 0;
+    HAL_LedPins();
+    HAL_Led(0, 0); HAL_Led(1, 0); HAL_Led(2, 0);
 
     /* Indicate activity */
-    _RD2 = 1;
+    HAL_Led(2, 1);
 
     /* Initialize buffers */
     while(i >= 0)
@@ -42,8 +77,13 @@ void main()
         i--;
     }
 
-    /* Start up delay */
-    delay(5000);
+    /* Start up delay - supply ramp */
+    delay_ms(1);
+
+#ifdef SD_USE_DMA
+    /* DMA completion is signalled by interrupt */
+    HAL_IntEnable();
+#endif
 
     /* Initialize SPI */
     SPI_Init();
@@ -54,14 +94,17 @@ void main()
     if(result == ERROR_INIT  || result == ERROR_RESET || result == ERROR_VLTG)
     {
         /* Flag error */
-        _RD0 = 1; goto wait;
+        HAL_Led(0, 1); goto wait;
     }
     
     /* Write to SD Card */
-    if(SDCard_WriteSector(0, buffer) == ERROR_WRITE) { _RD0 = 1; goto wait; }
+    if(SDCard_WriteSector(0, buffer) == ERROR_WRITE) { HAL_Led(0, 1); goto wait; }
 
     /* Read from SD Card */
-    if(SDCard_ReadSector(0, readbuf) == ERROR_READ)  { _RD0 = 1; goto wait; }
+    if(SDCard_ReadSector(0, readbuf) == ERROR_READ)  { HAL_Led(0, 1); goto wait; }
+
+    /* Latency of the above, if built in */
+    Instr_Dump(instr_out);
 
     /* Write/Read done*/
     delay_seconds(5);
@@ -69,7 +112,7 @@ void main()
     /* Display first 8 using LEDs */
     for(i = 0; i < 8; i++)
     {
-        PORTD = readbuf[i];
+        HAL_LedWrite(readbuf[i]);
         delay_seconds(3);
     }
 
@@ -83,29 +126,52 @@ void main()
 void SPI_Init()
 {
    /* SPI2 pin config */
-   _TRISG6 = 0; _TRISG8 = 0; _TRISG7 = 1;
+   HAL_SpiPins();
 
-   /* Clock = PBCLK/32 = 250kHz [ PBCLK/(2*(SP1BRG+1)) ] */
-   SPI2BRG = 15;
+   /* Card identification runs on the slow profile */
+   SPI_SetClock(SPI_CLOCK_INIT);
+}
+
+/* Set SPI2 to the fastest bit rate not above hz, returns the actual rate */
+unsigned int SPI_SetClock(unsigned int hz)
+{
+   unsigned int brg;
+
+   /* Clock = PBCLK/(2*(SPI2BRG+1)), round the divider up. 0 gets the
+      slowest rate, anything from PBCLK/2 up the fastest. */
+   if(hz == 0) brg = SPI_BRG_MAX;
+   else if(hz >= PB_FREQ / 2) brg = 0;
+   else brg = (PB_FREQ + (2 * hz) - 1) / (2 * hz) - 1;
+   if(brg > SPI_BRG_MAX) brg = SPI_BRG_MAX;
+
+   /* BRG must only change while the module is off -
+    * Master Mode, CKE = 1, SMP = 0, 8-BIT, SPI ON */
+   HAL_SpiConfig(brg, 0x8120);
+
+   spi_clock = PB_FREQ / (2 * (brg + 1));
+   return spi_clock;
+}
 
-   /* Master Mode, CKE = 1, SMP = 0, 8-BIT, SPI ON */
-   SPI2CON = 0x8120;
+/* Current SPI2 bit rate - bytes/second is this over 8 */
+unsigned int SPI_GetClock(void)
+{
+   return spi_clock;
 }
 
 /* Initialize the SD Card */
 int SDCard_Init()
 {
    int i, result, done = 0;
+   unsigned int start;
 
-   /* SD_CARD_SELECT pin set to output */
-   _TRISB9 = 0; _TRISB1 = 0;
-   _TRISG0 = 1; _TRISG1 = 0;
+   /* Card select/write protect out, card detect in */
+   HAL_CardPins();
    
    /* Disable SD Card */
    SDCard_Disable();
 
    /* Unlock */
-   SD_WRITE_PROTECT = 0;
+   HAL_CardWriteProtect(0);
 
    /* Minimum 74 clock cycle for boot up */
    for(i = 0; i < 10; i++)
@@ -113,19 +179,41 @@ int SDCard_Init()
        SPI_Clock();
    }
 
-   /* Start up delay */
-   delay(5000);
+   /* Start up delay - 1ms after power up before CMD0 */
+   delay_ms(1);
 
    /* Send RESET */
    result = SDCard_SendCommand(CMD0, 0x00000000, RESP_RA1, 0x95);
-   if(result != 1) result = ERROR_RESET;
+   if(result != 1) return ERROR_RESET;
 
-   /* Read output operation conditions registers (OCR) */
+   /* Interface condition - 2.7-3.6V, check pattern 0xAA (R7) */
    result = SDCard_SendCommand(CMD8, 0x000001AA, RESP_RA7, 0x87);
-   if(result != 1) result = ERROR_VLTG;
+   /* 0xFF is no answer at all - not a v1 card rejecting CMD8 */
+   if(result != 0xFF && (result & 0x04))
+   {
+       /* Illegal command - version 1.x card */
+       SDCard.type = SD_TYPE_SDSC_V1;
+   }
+   else
+   {
+       if(result != 1) return ERROR_VLTG;
+       /* Voltage accepted and pattern echoed ? */
+       if((SDCard_Response[2] & 0x0F) != 0x01 || SDCard_Response[3] != 0xAA)
+       {
+           return ERROR_VLTG;
+       }
+       SDCard.type = SD_TYPE_SDSC_V2;
+   }
 
-   /* Send INIT */
-   for(i = 0; i < INIT_TIMER; i++)
+#ifdef SD_USE_CRC
+   /* CRC_ON_OFF - from here on the card rejects bad command/data CRCs */
+   result = SDCard_SendCommand(CMD59, 0x00000001, RESP_RA1, 0xFF);
+   if(result != 1) return ERROR_INIT;
+#endif
+
+   /* Send INIT - HCS only for version 2.00 cards */
+   start = Timeout_Start();
+   while(!Timeout_Expired(start, INIT_TIMEOUT))
    {
        /* CMD55 - prerequisite for ACMD41 */
        result = SDCard_SendCommand(CMD55, 0x00000000, RESP_RA1, 0xFF);
@@ -133,7 +221,9 @@ int SDCard_Init()
        if(result != 1) break;
 
        /* Initiate initialization with ACMD41 */
-       result = SDCard_SendCommand(ACMD41, 0x40000000, RESP_RA1, 0xFF);
+       result = SDCard_SendCommand(ACMD41,
+                   (SDCard.type == SD_TYPE_SDSC_V1) ? 0x00000000 : 0x40000000,
+                   RESP_RA1, 0xFF);
        /* Exited IDLE ? */
        if(result == 0)
        {
@@ -142,83 +232,327 @@ int SDCard_Init()
        }
    }
 
-   if(done != 1) result = ERROR_INIT;
+   if(done != 1) return ERROR_INIT;
 
-   return result;
+   /* Read OCR - CCS set means SDHC/SDXC with block addressing */
+   SDCard.block_addressing = 0;
+   if(SDCard.type == SD_TYPE_SDSC_V2)
+   {
+       result = SDCard_SendCommand(CMD58, 0x00000000, RESP_RA3, 0xFF);
+       if(result != 0) return ERROR_INIT;
+
+       if(SDCard_Response[0] & 0x40)
+       {
+           SDCard.type = SD_TYPE_SDHC;
+           SDCard.block_addressing = 1;
+       }
+   }
+
+   /* Byte addressed cards - force 512 byte blocks */
+   if(!SDCard.block_addressing)
+   {
+       result = SDCard_SendCommand(CMD16, SECTOR_SIZE, RESP_RA1, 0xFF);
+       if(result != 0) return ERROR_INIT;
+   }
+
+   /* Capacity from CSD */
+   result = SDCard_ReadCSD();
+   if(result != 1) return result;
+
+   /* Out of idle - switch to the data transfer profile */
+   SPI_SetClock(SPI_CLOCK_DATA);
+
+   return 0;
+}
+
+
+/* Read the CSD register (CMD9) and work out the capacity in sectors */
+static int SDCard_ReadCSD(void)
+{
+    unsigned char csd[16];
+    unsigned int c_size, mult, read_bl_len, start;
+    int i, result;
+
+    /* Enable SD Card */
+    SDCard_Enable();
+
+    result = SDCard_SendCommand(CMD9, 0x00000000, RESP_RA1, 0xFF);
+
+    if(result == 0)
+    {
+        /* CSD comes back as a 16 byte data block */
+        result = 0;
+        start = Timeout_Start();
+        while(!Timeout_Expired(start, READ_TIMEOUT))
+        {
+            if(SPI_Read() == START_TOKEN)
+            {
+                result = 1;
+                break;
+            }
+        }
+
+        if(result == 1)
+        {
+            for(i = 0; i < 16; i++) csd[i] = SPI_Read();
+
+            /* Check the block CRC */
+            result = SDCard_ReadCrc((char*)csd, 16);
+        }
+    }
+
+    /* Disable SD Card */
+    SDCard_Disable();
+
+    if(result != 1) return ERROR_INIT;
+
+    if((csd[0] >> 6) == 1)
+    {
+        /* CSD 2.0 - C_SIZE[69:48] in 512KB units */
+        c_size = ((unsigned int)(csd[7] & 0x3F) << 16) | (csd[8] << 8) | csd[9];
+        SDCard.sectors = (c_size + 1) << 10;
+    }
+    else
+    {
+        /* CSD 1.0 - (C_SIZE+1) * 2^(C_SIZE_MULT+2) blocks of 2^READ_BL_LEN */
+        read_bl_len = csd[5] & 0x0F;
+        c_size = ((unsigned int)(csd[6] & 0x03) << 10) | (csd[7] << 2) | (csd[8] >> 6);
+        mult = ((csd[9] & 0x03) << 1) | (csd[10] >> 7);
+        SDCard.sectors = (c_size + 1) << (mult + 2 + read_bl_len - 9);
+    }
+
+    return 1;
 }
 
 
 /* Write and read from SPI */
 unsigned char SPI_Write(unsigned char c)
 {
+   INSTR_DECLARE(t)
+
+   INSTR_START(t);
    /* Load the TX register - MOSI */
-   SPI2BUF = c;
-   while(!SPI2STATbits.SPIRBF);
+   HAL_SpiPut(c);
+   while(!HAL_SpiRxFull());
+   INSTR_STOP(INSTR_SPI_WRITE, t);
    /* RX register - MISO shifted in simultaneously */
-   return SPI2BUF;
+   return HAL_SpiGet();
+}
+
+
+/* Read a block of bytes by shifting out dummy 0xFF */
+void SPI_ReadBuffer(char* buffer, int length)
+{
+#ifdef SD_USE_DMA
+    SPI_DmaRead(buffer, length, 0);
+    SPI_DmaWait();
+#else
+    while(length > 0)
+    {
+        *buffer = SPI_Read();
+        buffer++;
+        length--;
+    }
+#endif
+}
+
+
+/* Write a block of bytes, discarding whatever is shifted in */
+void SPI_WriteBuffer(char* buffer, int length)
+{
+#ifdef SD_USE_DMA
+    SPI_DmaWrite(buffer, length, 0);
+    SPI_DmaWait();
+#else
+    while(length > 0)
+    {
+        SPI_Write(*buffer);
+        buffer++;
+        length--;
+    }
+#endif
+}
+
+
+#ifdef SD_USE_DMA
+
+volatile int SPI_DmaDone = 1;
+void (*SPI_DmaWaitHook)(void);
+static void (*SPI_DmaCallback)(void);
+
+/* Start the transfer: the TX channel paces the clock, the RX channel
+ * (if any) drains SPI2BUF into memory and signals completion */
+static void SPI_DmaStart(char* rx, char* tx, int length, void (*callback)(void))
+{
+    SPI_DmaCallback = callback;
+    SPI_DmaDone = 0;
+
+    HAL_SpiFlush();
+    HAL_DmaOn();
+
+    if(rx != 0) HAL_DmaRxStart(rx, length);
+    HAL_DmaTxStart(tx, length, rx == 0);
+}
+
+
+/* Read length bytes into buffer using DMA */
+void SPI_DmaRead(char* buffer, int length, void (*callback)(void))
+{
+    int i;
+
+    /* Buffer doubles as the 0xFF source: TX always runs ahead of RX */
+    for(i = 0; i < length; i++) buffer[i] = 0xFF;
+
+    SPI_DmaStart(buffer, buffer, length, callback);
+}
+
+
+/* Write length bytes from buffer using DMA */
+void SPI_DmaWrite(char* buffer, int length, void (*callback)(void))
+{
+    SPI_DmaStart(0, buffer, length, callback);
+}
+
+
+/* Transfer still in flight ? */
+int SPI_DmaBusy(void)
+{
+    return !SPI_DmaDone;
+}
+
+
+/* Block until the transfer completes, running the hook meanwhile */
+void SPI_DmaWait(void)
+{
+    while(SPI_DmaBusy())
+    {
+        if(SPI_DmaWaitHook) SPI_DmaWaitHook();
+        HAL_DmaIdle();
+    }
+}
+
+
+/* Block transfer complete on RX channel */
+void __ISR(_DMA_0_VECTOR, ipl5) SPI_DmaRxHandler(void)
+{
+    HAL_DmaRxAck();
+
+    SPI_DmaDone = 1;
+    if(SPI_DmaCallback) SPI_DmaCallback();
 }
 
 
-/* Generic delay */
-void delay(int count)
+/* Block transfer complete on TX channel (write only) */
+void __ISR(_DMA_1_VECTOR, ipl5) SPI_DmaTxHandler(void)
 {
-    while(count > 0) count--;
+    HAL_DmaTxAck();
+
+    /* Last byte still shifting out - drain it and drop the overflow */
+    HAL_SpiDrain();
+
+    SPI_DmaDone = 1;
+    if(SPI_DmaCallback) SPI_DmaCallback();
+}
+
+#endif
+
+
+/* Busy wait on the core timer - independent of code generation */
+void delay_us(unsigned int us)
+{
+    unsigned int start = HAL_TimerRead();
+    while(HAL_TimerRead() - start < us * CORE_TICKS_US);
+}
+
+/* Delay in milliseconds */
+void delay_ms(unsigned int ms)
+{
+    while(ms > 0)
+    {
+        delay_us(1000);
+        ms--;
+    }
 }
 
 /* Delay in seconds */
 void delay_seconds(int count)
 {
-    long int load;
     while(count > 0)
     {
-        load = ONE_SECOND;
-        while(load > 0) load--;
+        delay_ms(1000);
         count--;
     }
 }
 
+/* Timeouts - take a core timer stamp, then test it against a limit in ms.
+   Unsigned difference survives the counter wrapping - every ~268s with
+   the core timer at SYS_FREQ/2 = 16MHz. */
+unsigned int Timeout_Start(void)
+{
+    return HAL_TimerRead();
+}
+
+int Timeout_Expired(unsigned int start, unsigned int ms)
+{
+    return (HAL_TimerRead() - start) >= ms * CORE_TICKS_MS;
+}
+
 
 int SDCard_SendCommand(unsigned char command, unsigned int addr, int num_response, unsigned char crc)
 {
-   int i, result, interm;
+   int i, result, n;
    int j = 24;
-   unsigned char addr8;
+   unsigned char addr8, packet[5];
    /* Enable SD Card */
    SDCard_Enable();
 
    /* Command packet - 6 Bytes */
    /* 1 - Command */
-   SPI_Write(command | 0x40);
+   packet[0] = command | 0x40;
+   SPI_Write(packet[0]);
 
    /* 2-5 - Address (32-Bit) */
-   while(j >= 0)
+   for(n = 1; j >= 0; n++)
    {
       /* Most significant byte first */
       addr8 = ((addr >> j) & 0xFF);
+      packet[n] = addr8;
       SPI_Write(addr8);
       j = j - 8;
    }
 
+#ifdef SD_USE_CRC
+   /* Card checks every command once CMD59 is on */
+   crc = SD_Crc7(packet, 5);
+#endif
+
    /* 6 - CRC Byte */
    SPI_Write(crc);
 
-   /* 1-8 byte cycle wait to process the command */
-   for(i = 0; i < 8; i++)
+   /* STOP_TRANSMISSION - skip the stuff byte clocked out after CMD12 */
+   if(command == CMD12)
+   {
+       SPI_Read();
+   }
+
+   /* Ncr - up to 8 bytes of 0xFF ahead of the response */
+   for(i = 0; i < 9; i++)
    {
        result = SPI_Read();
        if(result != 0xFF) 
        {
-           while(num_response > 1)
+           /* Keep the R3/R7 payload (OCR / echo) */
+           for(n = 0; n < num_response - 1; n++)
            {
-               interm = SPI_Read();
-               num_response--;
+               SDCard_Response[n] = SPI_Read();
            }
            break;
        }
    }
 
    /* Disable SD Card */
-   if((command != CMD17) && (command != CMD24))
+   if((command != CMD9)  && (command != CMD17) && (command != CMD18) &&
+      (command != CMD24) && (command != CMD25))
    {
        SDCard_Disable();
    }
@@ -227,42 +561,155 @@ int SDCard_SendCommand(unsigned char command, unsigned int addr, int num_respons
 }
 
 
+/* Read the two CRC bytes after a data block, 1 if they match (or unchecked) */
+int SDCard_ReadCrc(char* buffer, int length)
+{
+    unsigned short crc;
+
+    crc = SPI_Read() << 8;
+    crc |= SPI_Read();
+
+#ifdef SD_USE_CRC
+    if(crc != SD_Crc16(buffer, length, 0)) return 0;
+#endif
+
+    return 1;
+}
+
+
+/* Send the two CRC bytes after a data block (dummy 0xFFFF if unchecked) */
+void SDCard_WriteCrc(char* buffer, int length)
+{
+    SDCard_SendCrc(SDCard_DataCrc(buffer, length));
+}
+
+
+/* CRC16 of a data block, dummy 0xFFFF if unchecked */
+unsigned short SDCard_DataCrc(char* buffer, int length)
+{
+#ifdef SD_USE_CRC
+    return SD_Crc16(buffer, length, 0);
+#else
+    return 0xFFFF;
+#endif
+}
+
+
+/* Clock out a data block CRC, high byte first */
+void SDCard_SendCrc(unsigned short crc)
+{
+    SPI_Write(crc >> 8);
+    SPI_Write(crc & 0xFF);
+}
+
+
+/* Wait for the start token and read one data block */
+static int SDCard_ReadBlock(char* buffer)
+{
+    int result = 0;
+    unsigned int start;
+    unsigned char token;
+    INSTR_DECLARE(t)
+
+    INSTR_START(t);
+    start = Timeout_Start();
+    while(!Timeout_Expired(start, READ_TIMEOUT))
+    {
+        /* Wait for SD Card ready-to-send */
+        token = SPI_Read();
+        if(token == START_TOKEN)
+        {
+            result = 1;
+            break;
+        }
+
+        /* Data error token (0000xxxx) - no block is coming */
+        if(token != 0 && (token & 0xF0) == 0) break;
+    }
+    INSTR_STOP(INSTR_READ_TOKEN, t);
+
+    if(result == 1)
+    {
+        /* Read one sector = 512 bytes */
+        SPI_ReadBuffer(buffer, SECTOR_SIZE);
+
+        /* Check the block CRC */
+        result = SDCard_ReadCrc(buffer, SECTOR_SIZE);
+    }
+
+    return result;
+}
+
+
 /* Read one sector */
 int SDCard_ReadSector(unsigned int addr, char* buffer)
 {
-    int i, result;
+    int result;
+    INSTR_DECLARE(t)
+
+    INSTR_START(t);
     /* Enable SD Card */
     SDCard_Enable();
 
     /* Send read command */
-    result = SDCard_SendCommand(CMD17, (addr << 9), RESP_RA1, 0xFF);
+    result = SDCard_SendCommand(CMD17, SDCard_Address(addr), RESP_RA1, 0xFF);
 
     /* Command accepted ? */
     if(result == 0)
     {
-        for(i = 0; i < READ_TIMER; i++)
+        result = SDCard_ReadBlock(buffer);
+    }
+
+    /* Flag error */
+    if(result != 1) result = ERROR_READ;
+
+    /* Disable SD Card */
+    SDCard_Disable();
+    INSTR_STOP(INSTR_READ_SECTOR, t);
+
+    return result;
+}
+
+
+/* Read consecutive sectors with a single READ_MULTIPLE_BLOCK */
+int SDCard_ReadSectors(unsigned int addr, unsigned int count, char* buffer)
+{
+    int result;
+
+    if(count == 0) return 1;
+
+    /* Not worth the CMD12 overhead for one sector */
+    if(count == 1) return SDCard_ReadSector(addr, buffer);
+
+    /* Enable SD Card */
+    SDCard_Enable();
+
+    /* Send multiple block read command */
+    result = SDCard_SendCommand(CMD18, SDCard_Address(addr), RESP_RA1, 0xFF);
+
+    /* Command accepted ? */
+    if(result == 0)
+    {
+        /* Card streams blocks back to back, each behind its own token */
+        while(count > 0)
         {
-            result = SPI_Read();
-            /* Wait for SD Card ready-to-send */
-            if(result == START_TOKEN)
-            {
-                result = 1;
-                break;
-            }
+            result = SDCard_ReadBlock(buffer);
+            if(result != 1) break;
+
+            buffer += SECTOR_SIZE;
+            count--;
         }
 
-        if(result == 1)
+        /* Stop the stream - card is selected and keeps sending otherwise */
+        if(SDCard_SendCommand(CMD12, 0x00000000, RESP_RA1, 0xFF) != 0)
         {
-            /* Read one sector = 512 bytes */
-            for(i = 0; i < SECTOR_SIZE; i++)
-            {
-                *buffer = SPI_Read();
-                buffer++;
-            }
-
-            /* Two dummy reads for CRC */
-            SPI_Read();
-            SPI_Read();
+            result = ERROR_READ;
+        }
+        else
+        {
+            /* Wait for the card to release busy after CMD12 */
+            SDCard_Enable();
+            if(!SDCard_WaitBusy()) result = ERROR_READ;
         }
     }
 
@@ -276,57 +723,185 @@ int SDCard_ReadSector(unsigned int addr, char* buffer)
 }
 
 
+/* Wait while the card holds MISO low (busy programming) */
+static int SDCard_WaitBusy(void)
+{
+    int done = 0;
+    unsigned int start;
+    INSTR_DECLARE(t)
+
+    INSTR_START(t);
+    start = Timeout_Start();
+    while(!Timeout_Expired(start, WRITE_TIMEOUT))
+    {
+        /* Write done! */
+        if(SPI_Read() != 0)
+        {
+            done = 1;
+            break;
+        }
+    }
+    INSTR_STOP(INSTR_WRITE_BUSY, t);
+
+    return done;
+}
+
+
+/* Send one data block behind the given token and check the data response */
+static int SDCard_WriteBlock(unsigned char token, char* buffer)
+{
+    int result;
+#ifdef SD_USE_DMA
+    unsigned short crc;
+#endif
+
+    /* Indicate writing start */
+    SPI_Write(token);
+
+#ifdef SD_USE_DMA
+    /* Work out the block CRC while the channel shifts the sector out */
+    SPI_DmaWrite(buffer, SECTOR_SIZE, 0);
+    crc = SDCard_DataCrc(buffer, SECTOR_SIZE);
+    SPI_DmaWait();
+    SDCard_SendCrc(crc);
+#else
+    /* Write one sector = 512 bytes */
+    SPI_WriteBuffer(buffer, SECTOR_SIZE);
+
+    /* Block CRC */
+    SDCard_WriteCrc(buffer, SECTOR_SIZE);
+#endif
+
+    /* Check if write accepted */
+    result = SPI_Read();
+
+    /* Accepted ? */
+    return ((result & 0x0F) == ACCEPT_TOKEN);
+}
+
+
 /* Write one sector */
 int SDCard_WriteSector(unsigned int addr, char* buffer)
 {
-    int i, result;
+    int result;
+    INSTR_DECLARE(t)
+
+    INSTR_START(t);
     /* Enable SD Card */
     SDCard_Enable();
 
     /* Send write command */
-    result = SDCard_SendCommand(CMD24, (addr << 9), RESP_RA1, 0xFF);
+    result = SDCard_SendCommand(CMD24, SDCard_Address(addr), RESP_RA1, 0xFF);
 
     /* Command accepted ? */
     if(result == 0)
     {
-        /* Indicate writing start */
-        SPI_Write(START_TOKEN);
+        result = SDCard_WriteBlock(START_TOKEN, buffer);
 
-        /* Write one sector = 512 bytes */
-        for(i = 0; i < SECTOR_SIZE; i++)
+        /* Accepted ? */
+        if(result == 1)
         {
-            SPI_Write(*buffer);
-            buffer++;
+            result = SDCard_WaitBusy();
         }
+    }
 
-        /* Two dummy writes for CRC */
-        SPI_Write(0xFF);
-        SPI_Write(0xFF);
+    /* Flag error */
+    if(result != 1) result = ERROR_WRITE;
 
-        /* Check if write accepted */
-        result = SPI_Read();
+    /* Disable SD Card */
+    SDCard_Disable();
+    INSTR_STOP(INSTR_WRITE_SECTOR, t);
 
-        /* Accepted ? */
-        if((result & 0x0F) == ACCEPT_TOKEN)
+    return result;
+}
+
+
+/* Open a WRITE_MULTIPLE_BLOCK burst - card stays selected until stop */
+int SDCard_WriteStart(unsigned int addr, unsigned int count, int pre_erase)
+{
+    int result;
+
+    /* Let the card pre-erase the whole burst */
+    if(pre_erase && count > 0)
+    {
+        result = SDCard_SendCommand(CMD55, 0x00000000, RESP_RA1, 0xFF);
+        if(result <= 1)
         {
-            for(i = 0; i < WRITE_TIMER; i++)
-            {
-                result = SPI_Read();
-                /* Write done! */
-                if(result != 0)
-                {
-                    result = 1;
-                    break;
-                }
-            }
+            SDCard_SendCommand(ACMD23, count, RESP_RA1, 0xFF);
         }
     }
 
-    /* Flag error */
-    if(result != 1) result = ERROR_WRITE;
+    /* Enable SD Card */
+    SDCard_Enable();
+
+    /* Send multiple block write command */
+    result = SDCard_SendCommand(CMD25, SDCard_Address(addr), RESP_RA1, 0xFF);
+
+    /* Command accepted ? */
+    if(result == 0) return 1;
 
     /* Disable SD Card */
     SDCard_Disable();
 
+    return ERROR_WRITE;
+}
+
+
+/* Send the next sector of an open burst */
+int SDCard_WriteNext(char* buffer)
+{
+    if(SDCard_WriteBlock(MULTI_TOKEN, buffer) != 1) return ERROR_WRITE;
+
+    /* Card buffer hand-off - only long while its write buffer is full */
+    if(SDCard_WaitBusy() != 1) return ERROR_WRITE;
+
+    return 1;
+}
+
+
+/* Close an open burst */
+int SDCard_WriteStop(void)
+{
+    int result = 1;
+
+    /* End of burst - the card programs what is left in one go */
+    SPI_Write(STOP_TOKEN);
+    SPI_Read();
+
+    /* Single busy wait for the whole burst */
+    if(SDCard_WaitBusy() != 1) result = ERROR_WRITE;
+
+    /* Disable SD Card */
+    SDCard_Disable();
+
+    return result;
+}
+
+
+/* Write consecutive sectors with a single WRITE_MULTIPLE_BLOCK */
+int SDCard_WriteSectors(unsigned int addr, unsigned int count, char* buffer, int pre_erase)
+{
+    int result;
+
+    if(count == 0) return 1;
+
+    /* Single block write is cheaper than CMD25 + stop token */
+    if(count == 1) return SDCard_WriteSector(addr, buffer);
+
+    result = SDCard_WriteStart(addr, count, pre_erase);
+    if(result != 1) return result;
+
+    while(count > 0)
+    {
+        result = SDCard_WriteNext(buffer);
+        if(result != 1) break;
+
+        buffer += SECTOR_SIZE;
+        count--;
+    }
+
+    /* Always stop the burst, keep the first error */
+    if(SDCard_WriteStop() != 1) result = ERROR_WRITE;
+
     return result;
 }
@@ -14,35 +14,99 @@
 extern "C" {
 #endif
 
-#include <p32xxxx.h>
+/* Move sector payloads between SPI2BUF and memory with DMA channels 0 (RX)
+ * and 1 (TX). Comment out to fall back to the byte-by-byte SPI loop */
+#define SD_USE_DMA
 
-/*
- * WD - RF1/RG1
- * CD - RF0/RG0
- * CS - RB1/RB9
- * SCK - RF6/RG6
- * SDI - RF7/RG7
- * SDO - RF8/RG8
- */
+/* Turn on card CRC checking (CMD59): commands carry CRC7 and data blocks
+ * are verified against CRC16 - kernels in sd_crc.c */
+#define SD_USE_CRC
+
+#include "hal_pic32.h"
+
+/* Card classes */
+#define SD_TYPE_SDSC_V1 1
+#define SD_TYPE_SDSC_V2 2
+#define SD_TYPE_SDHC    3
+
+/* Card capabilities detected by SDCard_Init */
+typedef struct
+{
+    unsigned char type;
+    unsigned char block_addressing;
+    unsigned int sectors;
+} SDCard_Info;
+
+extern SDCard_Info SDCard;
+extern unsigned char SDCard_Response[4];
+
+/* Sector number to command argument - SDHC takes block numbers, SDSC bytes */
+#define SDCard_Address(sector) \
+    (SDCard.block_addressing ? (sector) : ((sector) << 9))
 
 /* Prototypes */
 int SDCard_Init(void);
 void SPI_Init(void);
-void delay(int count);
+unsigned int SPI_SetClock(unsigned int hz);
+unsigned int SPI_GetClock(void);
+void delay_us(unsigned int us);
+void delay_ms(unsigned int ms);
 void delay_seconds(int count);
+unsigned int Timeout_Start(void);
+int Timeout_Expired(unsigned int start, unsigned int ms);
 unsigned char SPI_Write(unsigned char c);
 int SDCard_SendCommand(unsigned char command, unsigned int addr, int num_response, unsigned char crc);
 int SDCard_WriteSector(unsigned int addr, char* buffer);
+int SDCard_WriteSectors(unsigned int addr, unsigned int count, char* buffer, int pre_erase);
+int SDCard_WriteStart(unsigned int addr, unsigned int count, int pre_erase);
+int SDCard_WriteNext(char* buffer);
+int SDCard_WriteStop(void);
+int SDCard_ReadCrc(char* buffer, int length);
+void SDCard_WriteCrc(char* buffer, int length);
+unsigned short SDCard_DataCrc(char* buffer, int length);
+void SDCard_SendCrc(unsigned short crc);
+void SPI_ReadBuffer(char* buffer, int length);
+void SPI_WriteBuffer(char* buffer, int length);
+#ifdef SD_USE_DMA
+void SPI_DmaRead(char* buffer, int length, void (*callback)(void));
+void SPI_DmaWrite(char* buffer, int length, void (*callback)(void));
+int SPI_DmaBusy(void);
+void SPI_DmaWait(void);
+void SPI_DmaRxHandler(void);
+void SPI_DmaTxHandler(void);
+
+/* Set by the DMA interrupt once a transfer has fully completed */
+extern volatile int SPI_DmaDone;
+
+/* Run in the SPI_DmaWait loop, e.g. to service other work while a
+ * blocking sector transfer is on the wire. 0 - just wait */
+extern void (*SPI_DmaWaitHook)(void);
+#endif
 int SDCard_ReadSector(unsigned int addr, char* buffer);
+int SDCard_ReadSectors(unsigned int addr, unsigned int count, char* buffer);
+
+/* Oscillator configuration - the #pragma config words are generated from
+ * these, so PBCLK derived below always matches the fuses */
+#define OSC_XTAL_FREQ  8000000
+#define OSC_FPLLIDIV   2
+#define OSC_FPLLMUL    16
+#define OSC_FPLLODIV   2
+#define OSC_FPBDIV     4
+
+#define SYS_FREQ  (OSC_XTAL_FREQ / OSC_FPLLIDIV * OSC_FPLLMUL / OSC_FPLLODIV)
+#define PB_FREQ   (SYS_FREQ / OSC_FPBDIV)
+
+/* SPI clock profiles - card identification must run at <= 400kHz,
+ * data transfer may go up to 25MHz once the card has left idle */
+#define SPI_CLOCK_INIT 400000
+#define SPI_CLOCK_DATA 25000000
 
-/* Pin connections */
-#define SD_WRITE_PROTECT _RG1
-#define SD_CARD_DETECT   _RG0
-#define SD_CARD_SELECT   _RB9
+/* SPI2BRG is 9 bits wide */
+#define SPI_BRG_MAX    511
 
 /* Easy macros */
-#define SDCard_Disable() SD_CARD_SELECT = 1; SPI_Clock()
-#define SDCard_Enable()  SD_CARD_SELECT = 0
+#define SDCard_Disable() HAL_CardSelect(1); SPI_Clock()
+#define SDCard_Enable()  HAL_CardSelect(0)
 
 /* Read from SPI device by shifting out dummy 0xFF */
 #define SPI_Read()  SPI_Write(0xFF)
@@ -55,15 +119,24 @@ int SDCard_ReadSector(unsigned int addr, char* buffer);
 #define CMD0   0
 #define CMD1   1
 #define CMD8   8
+#define CMD9   9
+#define CMD12  12
+#define CMD16  16
 #define CMD17  17
+#define CMD18  18
 #define CMD24  24
+#define CMD25  25
 #define CMD55  55
+#define CMD58  58
+#define CMD59  59
+#define ACMD23 23
 #define ACMD41 41
 
-/* Initialize response time - SDCard size dependent */
-#define INIT_TIMER  10000
-#define READ_TIMER  10000
-#define WRITE_TIMER 10000
+/* Response timeouts in ms - worst cases from the SD physical layer spec
+   (1s for ACMD41 init, 100ms read access, 500ms SDHC write busy) */
+#define INIT_TIMEOUT  1000
+#define READ_TIMEOUT  100
+#define WRITE_TIMEOUT 500
 
 /* Error codes */
 #define ERROR_RESET 101
@@ -74,15 +147,19 @@ int SDCard_ReadSector(unsigned int addr, char* buffer);
 
 /* More defines */
 #define START_TOKEN  0xFE
+#define MULTI_TOKEN  0xFC
+#define STOP_TOKEN   0xFD
 #define ACCEPT_TOKEN 0x05
 #define SECTOR_SIZE  512
 
 /* Response types */
 #define RESP_RA1 1
+#define RESP_RA3 5
 #define RESP_RA7 5
 
-/* Delay */
-#define ONE_SECOND 320000
+/* Core timer ticks - counts at SYS_FREQ/2 */
+#define CORE_TICKS_US (SYS_FREQ / 2000000)
+#define CORE_TICKS_MS (SYS_FREQ / 2000)
 
 #ifdef	__cplusplus
 }
@@ -0,0 +1,271 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: N-way write-back sector cache over pic32_sdcard
+ *
+ *******************************************************************/
+
+#include "sd_cache.h"
+
+/* Tag and state of one cached sector */
+typedef struct
+{
+    unsigned int sector;
+    unsigned int stamp;
+    unsigned char valid;
+    unsigned char dirty;
+} SDCache_Line;
+
+static SDCache_Line cache_lines[SDCACHE_SETS][SDCACHE_WAYS];
+static char cache_data[SDCACHE_SETS][SDCACHE_WAYS][SECTOR_SIZE];
+
+/* LRU clock - bumped on every access */
+static unsigned int lru_clock;
+static SDCache_Stats stats;
+
+
+/* Copy one sector */
+static void copy_sector(char* dst, char* src)
+{
+    int i;
+    for(i = 0; i < SECTOR_SIZE; i++) dst[i] = src[i];
+}
+
+
+/* Look up a sector in its set, NULL on miss */
+static SDCache_Line* find_line(unsigned int addr, int* way)
+{
+    int set = addr % SDCACHE_SETS;
+    int i;
+
+    for(i = 0; i < SDCACHE_WAYS; i++)
+    {
+        if(cache_lines[set][i].valid && cache_lines[set][i].sector == addr)
+        {
+            *way = i;
+            return &cache_lines[set][i];
+        }
+    }
+
+    return 0;
+}
+
+
+/* Free a way in the sector's set: empty one first, else least recently used */
+static SDCache_Line* evict_line(unsigned int addr, int* way)
+{
+    int set = addr % SDCACHE_SETS;
+    int i, victim = 0;
+    SDCache_Line* line;
+
+    for(i = 0; i < SDCACHE_WAYS; i++)
+    {
+        if(!cache_lines[set][i].valid)
+        {
+            victim = i;
+            break;
+        }
+        if(cache_lines[set][i].stamp < cache_lines[set][victim].stamp) victim = i;
+    }
+
+    line = &cache_lines[set][victim];
+
+    if(line->valid)
+    {
+        stats.evictions++;
+
+        /* Write back before reuse */
+        if(line->dirty)
+        {
+            if(SDCard_WriteSector(line->sector, cache_data[set][victim]) != 1)
+            {
+                return 0;
+            }
+            stats.writebacks++;
+        }
+    }
+
+    line->valid = 0;
+    line->dirty = 0;
+    *way = victim;
+
+    return line;
+}
+
+
+/* Drop all cached sectors without writing them */
+void SDCache_Init(void)
+{
+    int set, way;
+
+    for(set = 0; set < SDCACHE_SETS; set++)
+    {
+        for(way = 0; way < SDCACHE_WAYS; way++)
+        {
+            cache_lines[set][way].valid = 0;
+            cache_lines[set][way].dirty = 0;
+        }
+    }
+
+    lru_clock = 0;
+    stats.hits = stats.misses = stats.evictions = 0;
+    stats.writebacks = stats.coalesced = 0;
+}
+
+
+/* Read one sector through the cache */
+int SDCache_ReadSector(unsigned int addr, char* buffer)
+{
+    int set = addr % SDCACHE_SETS;
+    int way;
+    SDCache_Line* line = find_line(addr, &way);
+
+    if(line)
+    {
+        stats.hits++;
+    }
+    else
+    {
+        stats.misses++;
+
+        line = evict_line(addr, &way);
+        if(!line) return ERROR_WRITE;
+
+        if(SDCard_ReadSector(addr, cache_data[set][way]) != 1) return ERROR_READ;
+
+        line->sector = addr;
+        line->valid = 1;
+    }
+
+    line->stamp = ++lru_clock;
+    copy_sector(buffer, cache_data[set][way]);
+
+    return 1;
+}
+
+
+/* Write one sector into the cache - reaches the card on eviction or flush */
+int SDCache_WriteSector(unsigned int addr, char* buffer)
+{
+    int set = addr % SDCACHE_SETS;
+    int way;
+    SDCache_Line* line = find_line(addr, &way);
+
+    if(line)
+    {
+        stats.hits++;
+
+        /* Rewrite of a pending sector - one card write saved */
+        if(line->dirty) stats.coalesced++;
+    }
+    else
+    {
+        stats.misses++;
+
+        /* Full sector write - no need to fetch the old contents */
+        line = evict_line(addr, &way);
+        if(!line) return ERROR_WRITE;
+
+        line->sector = addr;
+        line->valid = 1;
+    }
+
+    copy_sector(cache_data[set][way], buffer);
+    line->dirty = 1;
+    line->stamp = ++lru_clock;
+
+    return 1;
+}
+
+
+/* Write all dirty sectors, merging consecutive ones into one burst */
+int SDCache_Flush(void)
+{
+    SDCache_Line* dirty[SDCACHE_LINES];
+    char* buffers[SDCACHE_LINES];
+    SDCache_Line* tmp_line;
+    char* tmp_buffer;
+    int set, way, i, j, run, count = 0, result = 1;
+
+    /* Gather dirty lines */
+    for(set = 0; set < SDCACHE_SETS; set++)
+    {
+        for(way = 0; way < SDCACHE_WAYS; way++)
+        {
+            if(cache_lines[set][way].valid && cache_lines[set][way].dirty)
+            {
+                dirty[count] = &cache_lines[set][way];
+                buffers[count] = cache_data[set][way];
+                count++;
+            }
+        }
+    }
+
+    /* Sort by sector - insertion sort, count is tiny */
+    for(i = 1; i < count; i++)
+    {
+        tmp_line = dirty[i];
+        tmp_buffer = buffers[i];
+        for(j = i; j > 0 && dirty[j - 1]->sector > tmp_line->sector; j--)
+        {
+            dirty[j] = dirty[j - 1];
+            buffers[j] = buffers[j - 1];
+        }
+        dirty[j] = tmp_line;
+        buffers[j] = tmp_buffer;
+    }
+
+    /* Write runs of consecutive sectors */
+    for(i = 0; i < count; i += run)
+    {
+        run = 1;
+        while(i + run < count && dirty[i + run]->sector == dirty[i]->sector + run)
+        {
+            run++;
+        }
+
+        if(run == 1)
+        {
+            if(SDCard_WriteSector(dirty[i]->sector, buffers[i]) != 1)
+            {
+                result = ERROR_WRITE;
+                continue;
+            }
+        }
+        else
+        {
+            if(SDCard_WriteStart(dirty[i]->sector, run, 1) != 1)
+            {
+                result = ERROR_WRITE;
+                continue;
+            }
+
+            for(j = 0; j < run; j++)
+            {
+                if(SDCard_WriteNext(buffers[i + j]) != 1) break;
+            }
+
+            if(SDCard_WriteStop() != 1 || j != run)
+            {
+                result = ERROR_WRITE;
+                continue;
+            }
+        }
+
+        for(j = 0; j < run; j++)
+        {
+            dirty[i + j]->dirty = 0;
+        }
+        stats.writebacks += run;
+    }
+
+    return result;
+}
+
+
+/* Snapshot of the hit/miss/eviction counters */
+void SDCache_GetStats(SDCache_Stats* out)
+{
+    *out = stats;
+}
@@ -0,0 +1,43 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: N-way write-back sector cache over pic32_sdcard
+ *
+ *******************************************************************/
+#ifndef SD_CACHE_H
+#define	SD_CACHE_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include "pic32_sdcard.h"
+
+/* Geometry - RAM budget is SDCACHE_SETS * SDCACHE_WAYS * SECTOR_SIZE */
+#define SDCACHE_WAYS 4
+#define SDCACHE_SETS 2
+#define SDCACHE_LINES (SDCACHE_WAYS * SDCACHE_SETS)
+
+/* Counters */
+typedef struct
+{
+    unsigned int hits;
+    unsigned int misses;
+    unsigned int evictions;
+    unsigned int writebacks;
+    unsigned int coalesced;
+} SDCache_Stats;
+
+/* Prototypes */
+void SDCache_Init(void);
+int SDCache_ReadSector(unsigned int addr, char* buffer);
+int SDCache_WriteSector(unsigned int addr, char* buffer);
+int SDCache_Flush(void);
+void SDCache_GetStats(SDCache_Stats* stats);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SD_CACHE_H */
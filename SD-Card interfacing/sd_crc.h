@@ -0,0 +1,27 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: CRC7 (commands) and CRC16-CCITT (data blocks) for SD Card
+ *
+ *******************************************************************/
+#ifndef SD_CRC_H
+#define	SD_CRC_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+/* Define for the bit-serial kernels - saves the 768 byte tables in
+ * flash at roughly 8x the cycles per byte */
+/* #define SD_CRC_SMALL */
+
+/* Prototypes */
+unsigned char SD_Crc7(const unsigned char* data, int length);
+unsigned short SD_Crc16(const char* data, int length, unsigned short crc);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SD_CRC_H */
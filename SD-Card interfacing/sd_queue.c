@@ -0,0 +1,236 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: Non-blocking SD Card request queue
+ *
+ * Requests are advanced by SDCard_Poll(), called from the main loop
+ * or a timer interrupt. Each tick does a bounded amount of SPI work,
+ * so the caller keeps sampling while a sector is in flight. The
+ * blocking SDCard_* calls must not be used while requests are queued.
+ *
+ *******************************************************************/
+
+#include "sd_queue.h"
+
+/* Request state machine */
+#define SDQ_IDLE  0
+#define SDQ_TOKEN 1
+#define SDQ_DATA  2
+#define SDQ_CRC   3
+#define SDQ_BUSY  4
+
+static SDQueue_Request* queue[SDQUEUE_DEPTH];
+static volatile unsigned int head, tail;
+
+static SDQueue_Request* active;
+static int state = SDQ_IDLE;
+static unsigned int started;
+static int offset;
+
+
+/* Complete the active request and release the card */
+static void finish(int result)
+{
+    SDQueue_Request* req = active;
+
+    /* Disable SD Card */
+    SDCard_Disable();
+
+    active = 0;
+    state = SDQ_IDLE;
+
+    req->status = result;
+    if(req->callback) req->callback(req);
+}
+
+
+/* Start the next queued request - command phase is short, run it inline */
+static void start_next(void)
+{
+    SDQueue_Request* req;
+    int result;
+
+    if(head == tail) return;
+
+    req = queue[tail & (SDQUEUE_DEPTH - 1)];
+    tail++;
+
+    active = req;
+    started = Timeout_Start();
+    offset = 0;
+
+    /* Enable SD Card */
+    SDCard_Enable();
+
+    if(req->op == SDQ_READ)
+    {
+        result = SDCard_SendCommand(CMD17, SDCard_Address(req->addr), RESP_RA1, 0xFF);
+        if(result != 0) { finish(ERROR_READ); return; }
+
+        state = SDQ_TOKEN;
+    }
+    else
+    {
+        result = SDCard_SendCommand(CMD24, SDCard_Address(req->addr), RESP_RA1, 0xFF);
+        if(result != 0) { finish(ERROR_WRITE); return; }
+
+        /* Indicate writing start */
+        SPI_Write(START_TOKEN);
+        state = SDQ_DATA;
+    }
+}
+
+
+/* Drop all queued requests */
+void SDQueue_Init(void)
+{
+    head = tail = 0;
+    active = 0;
+    state = SDQ_IDLE;
+}
+
+
+/* Queue a filled-in request, 0 if the queue is full */
+int SDQueue_Submit(SDQueue_Request* req)
+{
+    if(head - tail >= SDQUEUE_DEPTH)
+    {
+        req->status = SDQ_FREE;
+        return 0;
+    }
+
+    req->status = SDQ_PENDING;
+    queue[head & (SDQUEUE_DEPTH - 1)] = req;
+    head++;
+
+    return 1;
+}
+
+
+/* Queue a one sector read */
+int SDQueue_Read(SDQueue_Request* req, unsigned int addr, char* buffer,
+                 void (*callback)(SDQueue_Request*))
+{
+    req->op = SDQ_READ;
+    req->addr = addr;
+    req->buffer = buffer;
+    req->callback = callback;
+
+    return SDQueue_Submit(req);
+}
+
+
+/* Queue a one sector write */
+int SDQueue_Write(SDQueue_Request* req, unsigned int addr, char* buffer,
+                  void (*callback)(SDQueue_Request*))
+{
+    req->op = SDQ_WRITE;
+    req->addr = addr;
+    req->buffer = buffer;
+    req->callback = callback;
+
+    return SDQueue_Submit(req);
+}
+
+
+/* Advance the active request by one step, returns 0 once all work is done */
+int SDCard_Poll(void)
+{
+    int i, result;
+
+    switch(state)
+    {
+    case SDQ_IDLE:
+        start_next();
+        break;
+
+    case SDQ_TOKEN:
+        /* Wait for SD Card ready-to-send, a few bytes per tick */
+        for(i = 0; i < SDQ_POLL_BYTES; i++)
+        {
+            result = SPI_Read();
+            if(result == START_TOKEN)
+            {
+                state = SDQ_DATA;
+                break;
+            }
+
+            /* Data error token - no block is coming */
+            if(result != 0xFF)
+            {
+                finish(ERROR_READ);
+                break;
+            }
+        }
+        if(state == SDQ_TOKEN && Timeout_Expired(started, READ_TIMEOUT)) finish(ERROR_READ);
+        break;
+
+    case SDQ_DATA:
+#ifdef SD_USE_DMA
+        /* Whole sector in one DMA transfer, poll for completion */
+        if(offset == 0)
+        {
+            if(active->op == SDQ_READ)
+                SPI_DmaRead(active->buffer, SECTOR_SIZE, 0);
+            else
+                SPI_DmaWrite(active->buffer, SECTOR_SIZE, 0);
+            offset = SECTOR_SIZE;
+        }
+        else if(!SPI_DmaBusy())
+        {
+            state = SDQ_CRC;
+        }
+#else
+        /* Move one chunk of the sector per tick */
+        if(active->op == SDQ_READ)
+            SPI_ReadBuffer(active->buffer + offset, SDQ_CHUNK);
+        else
+            SPI_WriteBuffer(active->buffer + offset, SDQ_CHUNK);
+
+        offset += SDQ_CHUNK;
+        if(offset >= SECTOR_SIZE) state = SDQ_CRC;
+#endif
+        break;
+
+    case SDQ_CRC:
+        if(active->op == SDQ_READ)
+        {
+            /* Check the block CRC */
+            finish(SDCard_ReadCrc(active->buffer, SECTOR_SIZE) ? 1 : ERROR_READ);
+        }
+        else
+        {
+            /* Block CRC */
+            SDCard_WriteCrc(active->buffer, SECTOR_SIZE);
+
+            /* Check if write accepted */
+            result = SPI_Read();
+            if((result & 0x0F) != ACCEPT_TOKEN)
+            {
+                finish(ERROR_WRITE);
+            }
+            else
+            {
+                started = Timeout_Start();
+                state = SDQ_BUSY;
+            }
+        }
+        break;
+
+    case SDQ_BUSY:
+        /* Card programming - poll a few bytes per tick */
+        for(i = 0; i < SDQ_POLL_BYTES; i++)
+        {
+            if(SPI_Read() != 0)
+            {
+                finish(1);
+                break;
+            }
+        }
+        if(state == SDQ_BUSY && Timeout_Expired(started, WRITE_TIMEOUT)) finish(ERROR_WRITE);
+        break;
+    }
+
+    return (state != SDQ_IDLE) || (head != tail);
+}
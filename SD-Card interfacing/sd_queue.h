@@ -0,0 +1,57 @@
+/*******************************************************************
+ * Created: 17-Oct-2026
+ *
+ * HW: PIC32MX795F512L USB Starter Kit II, PICtail SD Card
+ * SW: Non-blocking SD Card request queue
+ *
+ *******************************************************************/
+#ifndef SD_QUEUE_H
+#define	SD_QUEUE_H
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include "pic32_sdcard.h"
+
+/* Request operations */
+#define SDQ_READ  0
+#define SDQ_WRITE 1
+
+/* Request status - SDQ_PENDING while queued or in flight, then 1 or
+ * ERROR_READ/WRITE. SDQ_FREE is 0, so a zeroed request, or one the
+ * full queue refused, never reads as in flight. */
+#define SDQ_FREE    0
+#define SDQ_PENDING 2
+
+/* Queue depth - must be a power of two */
+#define SDQUEUE_DEPTH 8
+
+/* Work done per SDCard_Poll() tick */
+#define SDQ_POLL_BYTES 16   /* token/busy bytes polled */
+#define SDQ_CHUNK      64   /* payload bytes moved without DMA */
+
+typedef struct SDQueue_Request
+{
+    unsigned char op;
+    unsigned int addr;
+    char* buffer;
+    volatile int status;
+    /* Called from SDCard_Poll() context on completion, may be NULL */
+    void (*callback)(struct SDQueue_Request* req);
+} SDQueue_Request;
+
+/* Prototypes */
+void SDQueue_Init(void);
+int SDQueue_Submit(SDQueue_Request* req);
+int SDQueue_Read(SDQueue_Request* req, unsigned int addr, char* buffer,
+                 void (*callback)(SDQueue_Request*));
+int SDQueue_Write(SDQueue_Request* req, unsigned int addr, char* buffer,
+                  void (*callback)(SDQueue_Request*));
+int SDCard_Poll(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SD_QUEUE_H */